@@ -37,6 +37,10 @@ typedef struct img2num_ImageToSvgConfig {
         /// Maximum number of iterations for the K-Means algorithm.
         /// The algorithm may terminate earlier if it converges.
         int32_t max_iter;
+        /// Number of 2x downsampling steps to iterate on first; 0 = off (CPU only).
+        int32_t pyramid_levels;
+        /// Full-resolution iterations refining the coarse centroids.
+        int32_t refine_iter;
     } kmeans;
 
     /// Minimum area (in pixels) for a region to be included in the SVG.
@@ -48,10 +52,171 @@ typedef struct img2num_ImageToSvgConfig {
     /// - 0 = CIE LAB (more perceptually accurate)
     /// - 1 = sRGB (faster).
     uint8_t color_space;
+
+    /// Configuration settings for the SVG serializer in image_to_svg.
+    struct SvgConfig {
+        /// Path encoding flag.
+        /// - 0 = standard (absolute commands, two decimals, one `fill` per path)
+        /// - 1 = compact (relative commands, quantized coordinates, paths grouped by color).
+        uint8_t encoding;
+        /// Coordinate grid step (in pixels) used by the compact encoding.
+        double grid;
+    } svg;
+
+    /// Configuration settings for tiled processing of very large images.
+    struct TilingConfig {
+        /// Edge length (in pixels) of the square tiles; 0 disables tiling.
+        int tile_size;
+        /// Maximum number of pixels used to learn the palette shared by all tiles.
+        int palette_samples;
+    } tiling;
+
+    /// Configuration settings for processing large images at a reduced resolution.
+    struct ResampleConfig {
+        /// Pixel budget (in megapixels) the pipeline runs at; 0 disables resampling.
+        double max_megapixels;
+    } resample;
+
+    /// Device the GPU-capable stages run on; GPU falls back to the CPU without one.
+    struct ExecutionConfig {
+        /// Device flag for the bilateral filter: 0 = auto, 1 = CPU, 2 = GPU.
+        uint8_t bilateral_filter;
+        /// Device flag for K-Means: 0 = auto, 1 = CPU, 2 = GPU. k above 64 always runs on the CPU.
+        uint8_t kmeans;
+        /// Smallest image (in pixels) auto runs the bilateral filter on the GPU for.
+        int64_t gpu_min_pixels;
+        /// Smallest `width * height * k` auto runs K-Means on the GPU for.
+        int64_t gpu_min_kmeans_work;
+    } execution;
 } img2num_ImageToSvgConfig;
 
 img2num_ImageToSvgConfig img2num_ImageToSvgConfig_default(void);
 
+/// @brief Vectorized regions of an image stored as flat, contiguous arrays.
+/// @ingroup CIMG2NUM_H
+/// @details Mirrors img2num::VectorizationResult. All array pointers are borrowed from the
+///          result and stay valid until img2num_VectorizationResult_free is called.
+typedef struct img2num_VectorizationResult {
+    /// Width of the source image in pixels.
+    int width;
+    /// Height of the source image in pixels.
+    int height;
+    /// Number of regions.
+    size_t num_regions;
+    /// Total number of loops across all regions.
+    size_t num_loops;
+    /// Total number of curves across all loops.
+    size_t num_curves;
+    /// Total number of entries in `adjacency`.
+    size_t num_adjacency;
+
+    /// Fill color of each region as packed RGB triplets (`3 * num_regions` bytes).
+    const uint8_t* colors;
+    /// Area (in pixels) of each region (`num_regions` entries).
+    const int32_t* areas;
+    /// Region `r` owns loops `[region_loop_offsets[r], region_loop_offsets[r + 1])`.
+    const int32_t* region_loop_offsets;
+    /// Loop `l` owns curves `[loop_curve_offsets[l], loop_curve_offsets[l + 1])`.
+    const int32_t* loop_curve_offsets;
+    /// Quadratic Bézier curves, 6 floats per curve:
+    /// start x, start y, control x, control y, end x, end y.
+    const float* curves;
+    /// Region `r` neighbours `adjacency[adjacency_offsets[r] .. adjacency_offsets[r + 1])`.
+    const int32_t* adjacency_offsets;
+    /// Indices of neighbouring regions.
+    const int32_t* adjacency;
+    /// Region index of each pixel in row-major order (`width * height` entries).
+    const int32_t* labels;
+
+    /// Owning storage; not part of the public interface.
+    void* internal;
+} img2num_VectorizationResult;
+
+/// @brief Release a result returned by img2num_labels_to_vectorization or
+///        img2num_image_to_vectorization. Passing NULL is a no-op.
+/// @ingroup CIMG2NUM_H
+void img2num_VectorizationResult_free(img2num_VectorizationResult* result);
+
+/// @brief Opaque handle to a reusable processing context.
+/// @ingroup CIMG2NUM_H
+/// @details Wraps img2num::Context; see ::IMG2NUM_H_CONTEXT_DOC.
+typedef struct img2num_context img2num_context_t;
+
+/// @copydoc ::IMG2NUM_H_CONTEXT_DOC
+/// @return A new context (release with img2num_context_free), or NULL on failure.
+img2num_context_t* img2num_context_create(void);
+
+/// @brief Destroy a context created by img2num_context_create. NULL is ignored.
+void img2num_context_free(img2num_context_t* context);
+
+/// @copydoc ::IMG2NUM_H_CONTEXT_RELEASE_DOC
+void img2num_context_release(img2num_context_t* context);
+
+/// @brief Options for img2num_vectorization_to_binary.
+/// @ingroup CIMG2NUM_H
+typedef struct img2num_VectorizationBinaryConfig {
+    /// Curve point storage flag.
+    /// - 0 = float32 (exact)
+    /// - 1 = int16 (quantized to `grid`, half the size).
+    uint8_t point_format;
+    /// Quantization step (in pixels) for int16 points.
+    /// 0 selects the finest power-of-two step that still fits every curve point in int16.
+    double grid;
+    /// Whether to store the per-pixel region raster.
+    bool include_labels;
+} img2num_VectorizationBinaryConfig;
+
+img2num_VectorizationBinaryConfig img2num_VectorizationBinaryConfig_default(void);
+
+/// @brief Fixed-size header of a binary vectorization container.
+/// @ingroup CIMG2NUM_H
+/// @details Mirrors img2num::VectorizationBinaryHeader.
+typedef struct img2num_VectorizationBinaryHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t flags;
+    uint32_t width;
+    uint32_t height;
+    uint32_t num_colors;
+    uint32_t num_regions;
+    uint32_t num_loops;
+    uint32_t num_curves;
+    uint32_t num_adjacency;
+    float point_scale;
+    uint64_t section_offsets[8];
+} img2num_VectorizationBinaryHeader;
+
+/// @brief Per-region record of a binary vectorization container.
+/// @ingroup CIMG2NUM_H
+typedef struct img2num_VectorizationBinaryRegion {
+    uint32_t color_index;
+    uint32_t area;
+    uint32_t first_loop;
+    uint32_t num_loops;
+} img2num_VectorizationBinaryRegion;
+
+/// @brief Per-loop record of a binary vectorization container.
+/// @ingroup CIMG2NUM_H
+typedef struct img2num_VectorizationBinaryLoop {
+    uint32_t first_curve;
+    uint32_t num_curves;
+} img2num_VectorizationBinaryLoop;
+
+/// @brief Zero-copy view into a binary vectorization container.
+/// @ingroup CIMG2NUM_H
+/// @details Mirrors img2num::VectorizationBinaryView; every pointer aliases the input buffer.
+typedef struct img2num_VectorizationBinaryView {
+    const img2num_VectorizationBinaryHeader* header;
+    const uint8_t* palette;
+    const img2num_VectorizationBinaryRegion* regions;
+    const img2num_VectorizationBinaryLoop* loops;
+    const float* curves_f32;
+    const int16_t* curves_i16;
+    const uint32_t* adjacency_offsets;
+    const uint32_t* adjacency;
+    const int32_t* labels;
+} img2num_VectorizationBinaryView;
+
 /// @copydoc ::IMG2NUM_H_GAUSSIAN_BLUR_DOC
 void img2num_gaussian_blur_fft(uint8_t* image, size_t width, size_t height, double sigma);
 
@@ -74,6 +239,12 @@ void img2num_kmeans(
     const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space
 );
 
+/// @copydoc ::IMG2NUM_H_KMEANS_LABELS_DOC
+void img2num_kmeans_labels(
+    const uint8_t* data, int32_t* out_labels, const int32_t width, const int32_t height,
+    const int32_t k, const int32_t max_iter, const uint8_t color_space
+);
+
 /// @copydoc ::IMG2NUM_H_BILATERAL_FILTER_DOC
 void img2num_bilateral_filter(
     uint8_t* image, size_t width, size_t height, double sigma_spatial, double sigma_range,
@@ -86,10 +257,195 @@ char* img2num_labels_to_svg(
     const int min_area, const int min_thickness
 );
 
+/// @copydoc ::IMG2NUM_H_LABELS_TO_VECTORIZATION_DOC
+img2num_VectorizationResult* img2num_labels_to_vectorization(
+    const uint8_t* data, const int32_t* labels, const int width, const int height,
+    const int min_area, const int min_thickness
+);
+
+/// @copydoc ::IMG2NUM_H_VECTORIZATION_TO_SVG_DOC
+/// @note Only the `svg` settings of @p config are used; NULL selects the defaults.
+char* img2num_vectorization_to_svg(
+    const img2num_VectorizationResult* result, const img2num_ImageToSvgConfig* config
+);
+
+/// @copydoc ::IMG2NUM_H_VECTORIZATION_TO_SVGZ_DOC
+/// @param out_size Receives the size of the returned buffer in bytes.
+/// @note Only the `svg` settings of @p config are used; NULL selects the defaults.
+/// @note The returned buffer is allocated with malloc and must be released with free.
+uint8_t* img2num_vectorization_to_svgz(
+    const img2num_VectorizationResult* result, const img2num_ImageToSvgConfig* config,
+    size_t* out_size
+);
+
+/// @copydoc ::IMG2NUM_H_VECTORIZATION_TO_BINARY_DOC
+/// @param out_size Receives the size of the returned buffer in bytes.
+/// @note The returned buffer is allocated with malloc and must be released with free.
+uint8_t* img2num_vectorization_to_binary(
+    const img2num_VectorizationResult* result, const img2num_VectorizationBinaryConfig* config,
+    size_t* out_size
+);
+
+/// @copydoc ::IMG2NUM_H_READ_VECTORIZATION_BINARY_DOC
+/// @param out_view Receives the section pointers.
+/// @return true on success; on failure the reason is available from img2num_get_last_error.
+bool img2num_read_vectorization_binary(
+    const uint8_t* data, size_t size, img2num_VectorizationBinaryView* out_view
+);
+
+/// @copydoc ::IMG2NUM_H_LABELS_TO_ARCS_DOC
+char* img2num_labels_to_arcs(
+    const uint8_t* data, const int32_t* labels, const int width, const int height,
+    const int min_area, const int min_thickness, const double grid
+);
+
 /// @copydoc ::IMG2NUM_H_IMAGE_TO_SVG_DOC
 char* img2num_image_to_svg(
     const uint8_t* data, const int width, const int height, const img2num_ImageToSvgConfig* config
 );
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_SVGZ_DOC
+/// @param out_size Receives the size of the returned buffer in bytes.
+/// @note The returned buffer is allocated with malloc and must be released with free.
+uint8_t* img2num_image_to_svgz(
+    const uint8_t* data, const int width, const int height, const img2num_ImageToSvgConfig* config,
+    size_t* out_size
+);
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_VECTORIZATION_DOC
+img2num_VectorizationResult* img2num_image_to_vectorization(
+    const uint8_t* data, const int width, const int height, const img2num_ImageToSvgConfig* config
+);
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_ARCS_DOC
+char* img2num_image_to_arcs(
+    const uint8_t* data, const int width, const int height, const img2num_ImageToSvgConfig* config
+);
+
+/// @brief Row callback of img2num_image_to_svg_rows.
+/// @ingroup CIMG2NUM_H
+/// Fills @p row (`width * 4` bytes) with the RGBA pixels of row @p y.
+typedef void (*img2num_read_row_fn)(void* user_data, int y, uint8_t* row);
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_SVG_ROWS_DOC
+/// @param read_row Called for every row requested; see ::IMG2NUM_H_CALLBACK_ROW_SOURCE_DOC.
+/// @param user_data Passed through to @p read_row.
+char* img2num_image_to_svg_rows(
+    const int width, const int height, img2num_read_row_fn read_row, void* user_data,
+    const img2num_ImageToSvgConfig* config
+);
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_SVG_ROWS_DOC
+/// @param path Raw RGBA file streamed as by ::IMG2NUM_H_MAP_RGBA_FILE_DOC.
+/// @param offset Byte offset of the first pixel.
+char* img2num_image_to_svg_file(
+    const char* path, const int width, const int height, size_t offset,
+    const img2num_ImageToSvgConfig* config
+);
+
+/// @brief Memory layout of one input pixel. Mirrors img2num::PixelFormat.
+/// @ingroup CIMG2NUM_H
+typedef enum {
+    IMG2NUM_PIXEL_FORMAT_RGBA8 = 0,
+    IMG2NUM_PIXEL_FORMAT_BGRA8 = 1,
+    IMG2NUM_PIXEL_FORMAT_RGB8 = 2,
+    IMG2NUM_PIXEL_FORMAT_BGR8 = 3,
+    IMG2NUM_PIXEL_FORMAT_GRAY8 = 4
+} img2num_pixel_format_t;
+
+/// @brief Input image in any pixel format, with optionally padded rows.
+/// @ingroup CIMG2NUM_H
+typedef struct img2num_ImageView {
+    const uint8_t* data;
+    int width;
+    int height;
+    img2num_pixel_format_t format;
+    /// Bytes from the start of one row to the next; 0 means tightly packed rows.
+    size_t stride;
+} img2num_ImageView;
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_SVG_VIEW_DOC
+char* img2num_image_to_svg_view(
+    const img2num_ImageView* image, const img2num_ImageToSvgConfig* config
+);
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_SVG_VIEW_DOC
+img2num_VectorizationResult* img2num_image_to_vectorization_view(
+    const img2num_ImageView* image, const img2num_ImageToSvgConfig* config
+);
+
+/// @copydoc ::IMG2NUM_H_WARMUP_DOC
+void img2num_warmup(void);
+
+/// @brief Completion callback of img2num_image_to_svg_async.
+/// @ingroup CIMG2NUM_H
+/// Called once, on a library worker thread, with a NUL-terminated SVG allocated with malloc
+/// (release it with free), or NULL on failure, in which case img2num_get_last_error and
+/// img2num_get_last_error_message on that thread report why.
+typedef void (*img2num_svg_callback_fn)(void* user_data, char* svg);
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_SVG_ASYNC_CALLBACK_DOC
+/// @param on_done Receives the result; see img2num_svg_callback_fn.
+/// @param user_data Passed through to @p on_done.
+/// @return true if the image was queued. On failure @p on_done is never called and the reason
+///         is available from img2num_get_last_error.
+bool img2num_image_to_svg_async(
+    const img2num_ImageView* image, const img2num_ImageToSvgConfig* config,
+    img2num_svg_callback_fn on_done, void* user_data
+);
+
+/// @brief One input of img2num_image_to_svg_batch, in any pixel format and row stride.
+/// @ingroup CIMG2NUM_H
+typedef img2num_ImageView img2num_BatchImage;
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_SVG_BATCH_DOC
+/// @param count Number of entries in @p images and @p out_svgs.
+/// @param num_configs 1 (shared by every image) or @p count. @p configs may be NULL to use
+///        img2num_ImageToSvgConfig_default for every image, in which case this is ignored.
+/// @param out_svgs Caller-provided array of @p count pointers; on success each receives a
+///        NUL-terminated SVG allocated with malloc that must be released with free.
+/// @return true on success. On failure every entry of @p out_svgs is NULL.
+bool img2num_image_to_svg_batch(
+    const img2num_BatchImage* images, size_t count, const img2num_ImageToSvgConfig* configs,
+    size_t num_configs, int num_threads, char** out_svgs
+);
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_SVG_DOC
+/// @note Runs in @p context, reusing its buffers.
+char* img2num_context_image_to_svg(
+    img2num_context_t* context, const uint8_t* data, const int width, const int height,
+    const img2num_ImageToSvgConfig* config
+);
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_SVGZ_DOC
+/// @param out_size Receives the size of the returned buffer in bytes.
+/// @note Runs in @p context, reusing its buffers.
+/// @note The returned buffer is allocated with malloc and must be released with free.
+uint8_t* img2num_context_image_to_svgz(
+    img2num_context_t* context, const uint8_t* data, const int width, const int height,
+    const img2num_ImageToSvgConfig* config, size_t* out_size
+);
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_VECTORIZATION_DOC
+/// @note Runs in @p context, reusing its buffers.
+img2num_VectorizationResult* img2num_context_image_to_vectorization(
+    img2num_context_t* context, const uint8_t* data, const int width, const int height,
+    const img2num_ImageToSvgConfig* config
+);
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_ARCS_DOC
+/// @note Runs in @p context, reusing its buffers.
+char* img2num_context_image_to_arcs(
+    img2num_context_t* context, const uint8_t* data, const int width, const int height,
+    const img2num_ImageToSvgConfig* config
+);
+
+/// @copydoc ::IMG2NUM_H_IMAGE_TO_SVG_VIEW_DOC
+/// @note Runs in @p context, reusing its buffers.
+char* img2num_context_image_to_svg_view(
+    img2num_context_t* context, const img2num_ImageView* image,
+    const img2num_ImageToSvgConfig* config
+);
 #ifdef __cplusplus
 }
 #endif
@@ -3,7 +3,14 @@
 #include "img2num.h"
 #include "img2num/Error.h"
 
+#include <algorithm>
 #include <cstring>
+#include <exception>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 extern "C" {
 
@@ -15,11 +22,26 @@ static img2num::ImageToSvgConfig to_cpp(const img2num_ImageToSvgConfig& c) {
 
     cfg.kmeans.k = c.kmeans.k;
     cfg.kmeans.max_iter = c.kmeans.max_iter;
+    cfg.kmeans.pyramid_levels = c.kmeans.pyramid_levels;
+    cfg.kmeans.refine_iter = c.kmeans.refine_iter;
 
     cfg.min_cluster_area = c.min_cluster_area;
     cfg.min_thickness = c.min_thickness;
     cfg.color_space = c.color_space;
 
+    cfg.svg.encoding = c.svg.encoding;
+    cfg.svg.grid = c.svg.grid;
+
+    cfg.tiling.tile_size = c.tiling.tile_size;
+    cfg.tiling.palette_samples = c.tiling.palette_samples;
+
+    cfg.resample.max_megapixels = c.resample.max_megapixels;
+
+    cfg.execution.bilateral_filter = c.execution.bilateral_filter;
+    cfg.execution.kmeans = c.execution.kmeans;
+    cfg.execution.gpu_min_pixels = c.execution.gpu_min_pixels;
+    cfg.execution.gpu_min_kmeans_work = c.execution.gpu_min_kmeans_work;
+
     return cfg;
 }
 
@@ -31,11 +53,26 @@ static img2num_ImageToSvgConfig to_c(const img2num::ImageToSvgConfig& cpp) {
 
     cfg.kmeans.k = cpp.kmeans.k;
     cfg.kmeans.max_iter = cpp.kmeans.max_iter;
+    cfg.kmeans.pyramid_levels = cpp.kmeans.pyramid_levels;
+    cfg.kmeans.refine_iter = cpp.kmeans.refine_iter;
 
     cfg.min_cluster_area = cpp.min_cluster_area;
     cfg.min_thickness = cpp.min_thickness;
     cfg.color_space = cpp.color_space;
 
+    cfg.svg.encoding = cpp.svg.encoding;
+    cfg.svg.grid = cpp.svg.grid;
+
+    cfg.tiling.tile_size = cpp.tiling.tile_size;
+    cfg.tiling.palette_samples = cpp.tiling.palette_samples;
+
+    cfg.resample.max_megapixels = cpp.resample.max_megapixels;
+
+    cfg.execution.bilateral_filter = cpp.execution.bilateral_filter;
+    cfg.execution.kmeans = cpp.execution.kmeans;
+    cfg.execution.gpu_min_pixels = cpp.execution.gpu_min_pixels;
+    cfg.execution.gpu_min_kmeans_work = cpp.execution.gpu_min_kmeans_work;
+
     return cfg;
 }
 
@@ -72,9 +109,18 @@ void img2num_kmeans(
     const uint8_t* data, uint8_t* out_data, int32_t* out_labels, const int32_t width,
     const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space
 ) {
-    img2num::clear_last_error_and_catch(
-        img2num::kmeans, data, out_data, out_labels, width, height, k, max_iter, color_space
-    );
+    img2num::clear_last_error_and_catch([&]() {
+        img2num::kmeans(data, out_data, out_labels, width, height, k, max_iter, color_space);
+    });
+}
+
+void img2num_kmeans_labels(
+    const uint8_t* data, int32_t* out_labels, const int32_t width, const int32_t height,
+    const int32_t k, const int32_t max_iter, const uint8_t color_space
+) {
+    img2num::clear_last_error_and_catch([&]() {
+        img2num::kmeans_labels(data, out_labels, width, height, k, max_iter, color_space);
+    });
 }
 
 void img2num_bilateral_filter(
@@ -82,7 +128,10 @@ void img2num_bilateral_filter(
     uint8_t color_space
 ) {
     img2num::clear_last_error_and_catch(
-        img2num::bilateral_filter, image, width, height, sigma_spatial, sigma_range, color_space
+        [](uint8_t* img, size_t w, size_t h, double s_spatial, double s_range, uint8_t cs) {
+            img2num::bilateral_filter(img, w, h, s_spatial, s_range, cs);
+        },
+        image, width, height, sigma_spatial, sigma_range, color_space
     );
 }
 
@@ -106,6 +155,225 @@ char* img2num_labels_to_svg(
     return result;
 }
 
+// heap-allocates a C view whose `internal` field owns the C++ result
+static img2num_VectorizationResult* to_c_view(img2num::VectorizationResult&& cpp) {
+    // owned stays with the unique_ptr until the view holding it is complete
+    std::unique_ptr<img2num::VectorizationResult> owned {
+        new img2num::VectorizationResult(std::move(cpp))};
+    img2num_VectorizationResult* view {new img2num_VectorizationResult {}};
+
+    view->width = owned->width;
+    view->height = owned->height;
+    view->num_regions = owned->num_regions();
+    view->num_loops = owned->num_loops();
+    view->num_curves = owned->num_curves();
+    view->num_adjacency = owned->adjacency.size();
+
+    view->colors = owned->colors.data();
+    view->areas = owned->areas.data();
+    view->region_loop_offsets = owned->region_loop_offsets.data();
+    view->loop_curve_offsets = owned->loop_curve_offsets.data();
+    view->curves = owned->curves.data();
+    view->adjacency_offsets = owned->adjacency_offsets.data();
+    view->adjacency = owned->adjacency.data();
+    view->labels = owned->labels.data();
+
+    view->internal = owned.release();
+    return view;
+}
+
+void img2num_VectorizationResult_free(img2num_VectorizationResult* result) {
+    if (!result)
+        return;
+    delete static_cast<img2num::VectorizationResult*>(result->internal);
+    delete result;
+}
+
+img2num_VectorizationResult* img2num_labels_to_vectorization(
+    const uint8_t* data, const int32_t* labels, const int width, const int height,
+    const int min_area, const int min_thickness
+) {
+    img2num_VectorizationResult* result {nullptr};
+    img2num::clear_last_error_and_catch(
+        [&](const uint8_t* d, const int32_t* l, const int w, const int h, const int min_a,
+            const int min_t) {
+            result = to_c_view(img2num::labels_to_vectorization(d, l, w, h, min_a, min_t));
+        },
+        data, labels, width, height, min_area, min_thickness
+    );
+    return result;
+}
+
+char* img2num_vectorization_to_svg(
+    const img2num_VectorizationResult* result, const img2num_ImageToSvgConfig* config
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    char* svg_out {nullptr};
+
+    img2num::clear_last_error_and_catch(
+        [&](const img2num_VectorizationResult* r) {
+            if (!r || !r->internal)
+                throw std::invalid_argument("vectorization_to_svg: result is null");
+
+            std::string svg {img2num::vectorization_to_svg(
+                *static_cast<const img2num::VectorizationResult*>(r->internal), to_cpp(cfg).svg
+            )};
+
+            svg_out = static_cast<char*>(std::malloc(svg.size() + 1));
+            if (!svg_out) {
+                return; // Allocation failed
+            }
+            std::memcpy(svg_out, svg.c_str(), svg.size() + 1);
+        },
+        result
+    );
+
+    return svg_out;
+}
+
+uint8_t* img2num_vectorization_to_svgz(
+    const img2num_VectorizationResult* result, const img2num_ImageToSvgConfig* config,
+    size_t* out_size
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    uint8_t* svgz_out {nullptr};
+    if (out_size)
+        *out_size = 0;
+
+    img2num::clear_last_error_and_catch(
+        [&](const img2num_VectorizationResult* r) {
+            if (!r || !r->internal)
+                throw std::invalid_argument("vectorization_to_svgz: result is null");
+
+            std::vector<uint8_t> svgz {img2num::vectorization_to_svgz(
+                *static_cast<const img2num::VectorizationResult*>(r->internal), to_cpp(cfg).svg
+            )};
+
+            svgz_out = static_cast<uint8_t*>(std::malloc(svgz.size()));
+            if (!svgz_out) {
+                return; // Allocation failed
+            }
+            std::memcpy(svgz_out, svgz.data(), svgz.size());
+            if (out_size)
+                *out_size = svgz.size();
+        },
+        result
+    );
+
+    return svgz_out;
+}
+
+img2num_VectorizationBinaryConfig img2num_VectorizationBinaryConfig_default(void) {
+    const img2num::VectorizationBinaryConfig cpp {};
+    img2num_VectorizationBinaryConfig cfg {};
+
+    cfg.point_format = cpp.point_format;
+    cfg.grid = cpp.grid;
+    cfg.include_labels = cpp.include_labels;
+
+    return cfg;
+}
+
+uint8_t* img2num_vectorization_to_binary(
+    const img2num_VectorizationResult* result, const img2num_VectorizationBinaryConfig* config,
+    size_t* out_size
+) {
+    img2num_VectorizationBinaryConfig default_cfg {img2num_VectorizationBinaryConfig_default()};
+
+    const img2num_VectorizationBinaryConfig& cfg {config ? *config : default_cfg};
+
+    uint8_t* bin_out {nullptr};
+    if (out_size)
+        *out_size = 0;
+
+    img2num::clear_last_error_and_catch(
+        [&](const img2num_VectorizationResult* r) {
+            if (!r || !r->internal)
+                throw std::invalid_argument("vectorization_to_binary: result is null");
+
+            img2num::VectorizationBinaryConfig cpp_cfg {};
+            cpp_cfg.point_format = cfg.point_format;
+            cpp_cfg.grid = cfg.grid;
+            cpp_cfg.include_labels = cfg.include_labels;
+
+            std::vector<uint8_t> bin {img2num::vectorization_to_binary(
+                *static_cast<const img2num::VectorizationResult*>(r->internal), cpp_cfg
+            )};
+
+            bin_out = static_cast<uint8_t*>(std::malloc(bin.size()));
+            if (!bin_out) {
+                return; // Allocation failed
+            }
+            std::memcpy(bin_out, bin.data(), bin.size());
+            if (out_size)
+                *out_size = bin.size();
+        },
+        result
+    );
+
+    return bin_out;
+}
+
+bool img2num_read_vectorization_binary(
+    const uint8_t* data, size_t size, img2num_VectorizationBinaryView* out_view
+) {
+    static_assert(
+        sizeof(img2num_VectorizationBinaryHeader) == sizeof(img2num::VectorizationBinaryHeader),
+        "C and C++ container headers must match"
+    );
+
+    bool ok {false};
+    img2num::clear_last_error_and_catch(
+        [&](const uint8_t* d, size_t n) {
+            if (!out_view)
+                throw std::invalid_argument("read_vectorization_binary: out_view is null");
+
+            const img2num::VectorizationBinaryView view {img2num::read_vectorization_binary(d, n)};
+
+            out_view->header =
+                reinterpret_cast<const img2num_VectorizationBinaryHeader*>(view.header);
+            out_view->palette = view.palette;
+            out_view->regions =
+                reinterpret_cast<const img2num_VectorizationBinaryRegion*>(view.regions);
+            out_view->loops = reinterpret_cast<const img2num_VectorizationBinaryLoop*>(view.loops);
+            out_view->curves_f32 = view.curves_f32;
+            out_view->curves_i16 = view.curves_i16;
+            out_view->adjacency_offsets = view.adjacency_offsets;
+            out_view->adjacency = view.adjacency;
+            out_view->labels = view.labels;
+            ok = true;
+        },
+        data, size
+    );
+    return ok;
+}
+
+char* img2num_labels_to_arcs(
+    const uint8_t* data, const int32_t* labels, const int width, const int height,
+    const int min_area, const int min_thickness, const double grid
+) {
+    char* result {nullptr};
+    img2num::clear_last_error_and_catch(
+        [&](const uint8_t* d, const int32_t* l, const int w, const int h, const int min_a,
+            const int min_t, const double g) {
+            std::string json {img2num::labels_to_arcs(d, l, w, h, min_a, min_t, g)};
+            result = static_cast<char*>(std::malloc(json.size() + 1));
+            if (!result) {
+                return; // Allocation failed
+            }
+            std::memcpy(result, json.c_str(), json.size() + 1);
+        },
+        data, labels, width, height, min_area, min_thickness, grid
+    );
+    return result;
+}
+
 char* img2num_image_to_svg(
     const uint8_t* data, const int width, const int height, const img2num_ImageToSvgConfig* config
 ) {
@@ -130,4 +398,395 @@ char* img2num_image_to_svg(
 
     return result;
 }
+
+uint8_t* img2num_image_to_svgz(
+    const uint8_t* data, const int width, const int height, const img2num_ImageToSvgConfig* config,
+    size_t* out_size
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    uint8_t* result {nullptr};
+    if (out_size)
+        *out_size = 0;
+
+    img2num::clear_last_error_and_catch(
+        [&](const uint8_t* d, const int w, const int h) {
+            std::vector<uint8_t> svgz {img2num::image_to_svgz(d, w, h, to_cpp(cfg))};
+
+            result = static_cast<uint8_t*>(std::malloc(svgz.size()));
+            if (!result) {
+                return; // Allocation failed
+            }
+            std::memcpy(result, svgz.data(), svgz.size());
+            if (out_size)
+                *out_size = svgz.size();
+        },
+        data, width, height
+    );
+
+    return result;
+}
+
+img2num_VectorizationResult* img2num_image_to_vectorization(
+    const uint8_t* data, const int width, const int height, const img2num_ImageToSvgConfig* config
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    img2num_VectorizationResult* result {nullptr};
+
+    img2num::clear_last_error_and_catch(
+        [&](const uint8_t* d, const int w, const int h) {
+            result = to_c_view(img2num::image_to_vectorization(d, w, h, to_cpp(cfg)));
+        },
+        data, width, height
+    );
+
+    return result;
+}
+
+char* img2num_image_to_arcs(
+    const uint8_t* data, const int width, const int height, const img2num_ImageToSvgConfig* config
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    char* result {nullptr};
+
+    img2num::clear_last_error_and_catch(
+        [&](const uint8_t* d, const int w, const int h) {
+            std::string json {img2num::image_to_arcs(d, w, h, to_cpp(cfg))};
+
+            result = static_cast<char*>(std::malloc(json.size() + 1));
+            if (!result) {
+                return; // Allocation failed
+            }
+            std::memcpy(result, json.c_str(), json.size() + 1);
+        },
+        data, width, height
+    );
+
+    return result;
+}
+
+static img2num::ImageView view_to_cpp(const img2num_ImageView* image) {
+    if (!image)
+        throw std::invalid_argument("image view is null");
+    return img2num::ImageView {
+        image->data, image->width, image->height,
+        static_cast<img2num::PixelFormat>(image->format), image->stride};
+}
+
+// Copies `svg` into a malloc'd C string; NULL if the allocation fails
+static char* malloc_svg(const std::string& svg) {
+    char* out {static_cast<char*>(std::malloc(svg.size() + 1))};
+    if (out)
+        std::memcpy(out, svg.c_str(), svg.size() + 1);
+    return out;
+}
+
+char* img2num_image_to_svg_rows(
+    const int width, const int height, img2num_read_row_fn read_row, void* user_data,
+    const img2num_ImageToSvgConfig* config
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    char* result {nullptr};
+
+    img2num::clear_last_error_and_catch([&]() {
+        if (!read_row)
+            throw std::invalid_argument("image_to_svg_rows: read_row is null");
+        std::unique_ptr<img2num::RowSource> source {img2num::callback_row_source(
+            width, height, [=](int y, uint8_t* row) { read_row(user_data, y, row); }
+        )};
+        result = malloc_svg(img2num::image_to_svg(*source, to_cpp(cfg)));
+    });
+
+    return result;
+}
+
+char* img2num_image_to_svg_file(
+    const char* path, const int width, const int height, size_t offset,
+    const img2num_ImageToSvgConfig* config
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    char* result {nullptr};
+
+    img2num::clear_last_error_and_catch([&]() {
+        if (!path)
+            throw std::invalid_argument("image_to_svg_file: path is null");
+        std::unique_ptr<img2num::RowSource> source {
+            img2num::map_rgba_file(path, width, height, offset)};
+        result = malloc_svg(img2num::image_to_svg(*source, to_cpp(cfg)));
+    });
+
+    return result;
+}
+
+char* img2num_image_to_svg_view(
+    const img2num_ImageView* image, const img2num_ImageToSvgConfig* config
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    char* result {nullptr};
+
+    img2num::clear_last_error_and_catch([&]() {
+        result = malloc_svg(img2num::image_to_svg(view_to_cpp(image), to_cpp(cfg)));
+    });
+
+    return result;
+}
+
+img2num_VectorizationResult* img2num_image_to_vectorization_view(
+    const img2num_ImageView* image, const img2num_ImageToSvgConfig* config
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    img2num_VectorizationResult* result {nullptr};
+
+    img2num::clear_last_error_and_catch([&]() {
+        result = to_c_view(img2num::image_to_vectorization(view_to_cpp(image), to_cpp(cfg)));
+    });
+
+    return result;
+}
+
+void img2num_warmup(void) {
+    img2num::clear_last_error_and_catch([&]() { img2num::warmup(); });
+}
+
+bool img2num_image_to_svg_async(
+    const img2num_ImageView* image, const img2num_ImageToSvgConfig* config,
+    img2num_svg_callback_fn on_done, void* user_data
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    bool ok {false};
+
+    img2num::clear_last_error_and_catch([&]() {
+        if (!on_done)
+            throw std::invalid_argument("image_to_svg_async: on_done is null");
+        img2num::image_to_svg_async(
+            view_to_cpp(image), to_cpp(cfg),
+            [on_done, user_data](std::string svg, std::exception_ptr error) {
+                // sets the worker thread's last error for the callback to read
+                char* result {nullptr};
+                img2num::clear_last_error_and_catch([&]() {
+                    if (error)
+                        std::rethrow_exception(error);
+                    result = malloc_svg(svg);
+                    if (!result)
+                        throw std::bad_alloc();
+                });
+                on_done(user_data, result);
+            }
+        );
+        ok = true;
+    });
+
+    return ok;
+}
+
+bool img2num_image_to_svg_batch(
+    const img2num_BatchImage* images, size_t count, const img2num_ImageToSvgConfig* configs,
+    size_t num_configs, int num_threads, char** out_svgs
+) {
+    bool ok {false};
+
+    img2num::clear_last_error_and_catch(
+        [&](const img2num_BatchImage* in, size_t n) {
+            if (!out_svgs)
+                throw std::invalid_argument("image_to_svg_batch: out_svgs is null");
+            std::fill(out_svgs, out_svgs + n, nullptr);
+            if (n > 0 && !in)
+                throw std::invalid_argument("image_to_svg_batch: images is null");
+
+            std::vector<img2num::BatchImage> cpp_images(n);
+            for (size_t i = 0; i < n; ++i)
+                cpp_images[i] = view_to_cpp(&in[i]);
+
+            std::vector<img2num::ImageToSvgConfig> cpp_configs;
+            if (configs) {
+                cpp_configs.reserve(num_configs);
+                for (size_t i = 0; i < num_configs; ++i)
+                    cpp_configs.push_back(to_cpp(configs[i]));
+            } else {
+                cpp_configs.push_back(to_cpp(img2num_ImageToSvgConfig_default()));
+            }
+
+            std::vector<std::string> svgs {
+                img2num::image_to_svg_batch(cpp_images, cpp_configs, num_threads)};
+
+            for (size_t i = 0; i < n; ++i) {
+                out_svgs[i] = static_cast<char*>(std::malloc(svgs[i].size() + 1));
+                if (!out_svgs[i]) {
+                    for (size_t j = 0; j < i; ++j) {
+                        std::free(out_svgs[j]);
+                        out_svgs[j] = nullptr;
+                    }
+                    throw std::bad_alloc();
+                }
+                std::memcpy(out_svgs[i], svgs[i].c_str(), svgs[i].size() + 1);
+            }
+            ok = true;
+        },
+        images, count
+    );
+
+    return ok;
+}
+
+struct img2num_context {
+    img2num::Context context;
+};
+
+img2num_context_t* img2num_context_create(void) {
+    img2num_context_t* context {nullptr};
+    img2num::clear_last_error_and_catch([&]() { context = new img2num_context {}; });
+    return context;
+}
+
+void img2num_context_free(img2num_context_t* context) {
+    delete context;
+}
+
+void img2num_context_release(img2num_context_t* context) {
+    if (context)
+        context->context.release();
+}
+
+static img2num::Context& context_of(img2num_context_t* context) {
+    if (!context)
+        throw std::invalid_argument("context is null");
+    return context->context;
+}
+
+char* img2num_context_image_to_svg(
+    img2num_context_t* context, const uint8_t* data, const int width, const int height,
+    const img2num_ImageToSvgConfig* config
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    char* result {nullptr};
+
+    img2num::clear_last_error_and_catch(
+        [&](const uint8_t* d, const int w, const int h) {
+            std::string svg {context_of(context).image_to_svg(d, w, h, to_cpp(cfg))};
+
+            result = static_cast<char*>(std::malloc(svg.size() + 1));
+            if (!result) {
+                return; // Allocation failed
+            }
+            std::memcpy(result, svg.c_str(), svg.size() + 1);
+        },
+        data, width, height
+    );
+
+    return result;
+}
+
+uint8_t* img2num_context_image_to_svgz(
+    img2num_context_t* context, const uint8_t* data, const int width, const int height,
+    const img2num_ImageToSvgConfig* config, size_t* out_size
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    uint8_t* result {nullptr};
+    if (out_size)
+        *out_size = 0;
+
+    img2num::clear_last_error_and_catch(
+        [&](const uint8_t* d, const int w, const int h) {
+            std::vector<uint8_t> svgz {context_of(context).image_to_svgz(d, w, h, to_cpp(cfg))};
+
+            result = static_cast<uint8_t*>(std::malloc(svgz.size()));
+            if (!result) {
+                return; // Allocation failed
+            }
+            std::memcpy(result, svgz.data(), svgz.size());
+            if (out_size)
+                *out_size = svgz.size();
+        },
+        data, width, height
+    );
+
+    return result;
+}
+
+img2num_VectorizationResult* img2num_context_image_to_vectorization(
+    img2num_context_t* context, const uint8_t* data, const int width, const int height,
+    const img2num_ImageToSvgConfig* config
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    img2num_VectorizationResult* result {nullptr};
+
+    img2num::clear_last_error_and_catch(
+        [&](const uint8_t* d, const int w, const int h) {
+            result =
+                to_c_view(context_of(context).image_to_vectorization(d, w, h, to_cpp(cfg)));
+        },
+        data, width, height
+    );
+
+    return result;
+}
+
+char* img2num_context_image_to_arcs(
+    img2num_context_t* context, const uint8_t* data, const int width, const int height,
+    const img2num_ImageToSvgConfig* config
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    char* result {nullptr};
+
+    img2num::clear_last_error_and_catch(
+        [&](const uint8_t* d, const int w, const int h) {
+            std::string json {context_of(context).image_to_arcs(d, w, h, to_cpp(cfg))};
+
+            result = static_cast<char*>(std::malloc(json.size() + 1));
+            if (!result) {
+                return; // Allocation failed
+            }
+            std::memcpy(result, json.c_str(), json.size() + 1);
+        },
+        data, width, height
+    );
+
+    return result;
+}
+
+char* img2num_context_image_to_svg_view(
+    img2num_context_t* context, const img2num_ImageView* image,
+    const img2num_ImageToSvgConfig* config
+) {
+    img2num_ImageToSvgConfig default_cfg {img2num_ImageToSvgConfig_default()};
+    const img2num_ImageToSvgConfig& cfg {config ? *config : default_cfg};
+
+    char* result {nullptr};
+
+    img2num::clear_last_error_and_catch([&]() {
+        result = malloc_svg(context_of(context).image_to_svg(view_to_cpp(image), to_cpp(cfg)));
+    });
+
+    return result;
+}
 }
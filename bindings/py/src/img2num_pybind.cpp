@@ -1,11 +1,15 @@
 #include <cstdlib>
 #include <img2num.h>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 PYBIND11_MODULE(_img2num, m) {
     m.doc() = R"docstring(
@@ -191,7 +195,8 @@ PYBIND11_MODULE(_img2num, m) {
     m.def(
         "kmeans",
         [](pybind11::array_t<uint8_t, pybind11::array::c_style> data, int32_t width, int32_t height,
-           int32_t k, int32_t max_iter, uint8_t color_space) {
+           int32_t k, int32_t max_iter, uint8_t color_space, int32_t pyramid_levels,
+           int32_t refine_iter) {
             pybind11::buffer_info data_buf = data.request();
 
             // Allocate NumPy arrays for the outputs
@@ -204,12 +209,13 @@ PYBIND11_MODULE(_img2num, m) {
                 static_cast<const uint8_t*>(data_buf.ptr),
                 static_cast<uint8_t*>(out_data.mutable_data()),
                 static_cast<int32_t*>(out_labels.mutable_data()), width, height, k, max_iter,
-                color_space
+                color_space, pyramid_levels, refine_iter
             );
             return pybind11::make_tuple(out_data, out_labels);
         },
         pybind11::arg("data"), pybind11::arg("width"), pybind11::arg("height"), pybind11::arg("k"),
-        pybind11::arg("max_iter"), pybind11::arg("color_space"), R"docstring(
+        pybind11::arg("max_iter"), pybind11::arg("color_space"),
+        pybind11::arg("pyramid_levels") = 0, pybind11::arg("refine_iter") = 2, R"docstring(
         Perform K-means clustering on the image data.
 
         Parameters
@@ -226,6 +232,11 @@ PYBIND11_MODULE(_img2num, m) {
             Maximum number of iterations for the K-means algorithm.
         color_space : int
             Color space identifier (e.g., 0 for LAB, 1 for sRGB).
+        pyramid_levels : int, optional
+            Number of 2x downsampling steps to run the iterations on first (CPU only).
+            0 disables. Default: 0
+        refine_iter : int, optional
+            Full-resolution iterations refining the coarse centroids. Default: 2
 
         Returns
         -------
@@ -234,6 +245,54 @@ PYBIND11_MODULE(_img2num, m) {
         )docstring"
     );
 
+    m.def(
+        "kmeans_labels",
+        [](pybind11::array_t<uint8_t, pybind11::array::c_style> data, int32_t width, int32_t height,
+           int32_t k, int32_t max_iter, uint8_t color_space, int32_t pyramid_levels,
+           int32_t refine_iter) {
+            pybind11::array_t<int32_t, pybind11::array::c_style> out_labels(
+                {static_cast<size_t>(height), static_cast<size_t>(width)}
+            );
+
+            img2num::kmeans_labels(
+                static_cast<const uint8_t*>(data.request().ptr),
+                static_cast<int32_t*>(out_labels.mutable_data()), width, height, k, max_iter,
+                color_space, pyramid_levels, refine_iter
+            );
+            return out_labels;
+        },
+        pybind11::arg("data"), pybind11::arg("width"), pybind11::arg("height"), pybind11::arg("k"),
+        pybind11::arg("max_iter"), pybind11::arg("color_space"),
+        pybind11::arg("pyramid_levels") = 0, pybind11::arg("refine_iter") = 2, R"docstring(
+        Perform K-means clustering on the image data, returning only the labels.
+
+        Parameters
+        ----------
+        data : numpy.ndarray
+            Input image data as a uint8 numpy array.
+        width : int
+            Width of the image.
+        height : int
+            Height of the image.
+        k : int
+            Number of clusters to compute.
+        max_iter : int
+            Maximum number of iterations for the K-means algorithm.
+        color_space : int
+            Color space identifier (e.g., 0 for LAB, 1 for sRGB).
+        pyramid_levels : int, optional
+            Number of 2x downsampling steps to run the iterations on first (CPU only).
+            0 disables. Default: 0
+        refine_iter : int, optional
+            Full-resolution iterations refining the coarse centroids. Default: 2
+
+        Returns
+        -------
+        numpy.ndarray
+            Cluster label per pixel, shape (height, width).
+        )docstring"
+    );
+
     m.def(
         "labels_to_svg",
         [](pybind11::array_t<uint8_t, pybind11::array::c_style> data,
@@ -276,6 +335,51 @@ PYBIND11_MODULE(_img2num, m) {
         )docstring"
     );
 
+    m.def(
+        "labels_to_arcs",
+        [](pybind11::array_t<uint8_t, pybind11::array::c_style> data,
+           pybind11::array_t<int32_t, pybind11::array::c_style> labels, int width, int height,
+           int min_area, int min_thickness, double grid) {
+            const uint8_t* data_ptr {static_cast<const uint8_t*>(data.request().ptr)};
+            const int32_t* labels_ptr {static_cast<const int32_t*>(labels.request().ptr)};
+
+            std::string json {img2num::labels_to_arcs(
+                data_ptr, labels_ptr, width, height, min_area, min_thickness, grid
+            )};
+
+            return pybind11::str(std::move(json));
+        },
+        pybind11::arg("data"), pybind11::arg("labels"), pybind11::arg("width"),
+        pybind11::arg("height"), pybind11::arg("min_area"), pybind11::arg("min_thickness"),
+        pybind11::arg("grid") = 0.5,
+        R"docstring(
+        Convert labels to a shared-arc topology (TopoJSON-style JSON string).
+
+        Parameters
+        ----------
+        data : numpy.ndarray
+            Input image data as a uint8 numpy array.
+        labels : numpy.ndarray
+            Label map as an int32 numpy array.
+        width : int
+            Width of the image.
+        height : int
+            Height of the image.
+        min_area : int
+            Minimum cluster area to include.
+        min_thickness: int
+            Minimum thickness a region must have to include.
+        grid : float
+            Coordinate grid step (in pixels) that arc points are quantized to.
+
+        Returns
+        -------
+        str
+            A JSON document where every boundary between two regions is stored once in
+            ``arcs`` and each region lists its loops as signed arc indices (``~i`` = reversed).
+        )docstring"
+    );
+
     // ------------------------------------------ Config Structs ----------------------
     pybind11::class_<img2num::ImageToSvgConfig> config(m, "ImageToSvgConfig", R"docstring(
     Configuration options for image_to_svg.
@@ -315,14 +419,125 @@ PYBIND11_MODULE(_img2num, m) {
         .def_readwrite("max_iter", &img2num::ImageToSvgConfig::KMeansConfig::max_iter, R"docstring(
     Maximum number of iterations for the K-means algorithm. Default: 100
     )docstring")
+        .def_readwrite(
+            "pyramid_levels", &img2num::ImageToSvgConfig::KMeansConfig::pyramid_levels,
+            R"docstring(
+    Number of 2x downsampling steps to run the iterations on before refining at full
+    resolution (CPU only). 0 disables. Default: 0
+    )docstring"
+        )
+        .def_readwrite(
+            "refine_iter", &img2num::ImageToSvgConfig::KMeansConfig::refine_iter,
+            R"docstring(
+    Full-resolution iterations refining the coarse centroids. Default: 2
+    )docstring"
+        )
         .def("__repr__", [](const img2num::ImageToSvgConfig::KMeansConfig& c) {
             return "{'k': " + std::to_string(c.k) + ", 'max_iter': " + std::to_string(c.max_iter) +
-                   "}";
+                   ", 'pyramid_levels': " + std::to_string(c.pyramid_levels) +
+                   ", 'refine_iter': " + std::to_string(c.refine_iter) + "}";
+        });
+
+    pybind11::class_<img2num::ImageToSvgConfig::SvgConfig>(config, "SvgConfig", R"docstring(
+    Configuration for the SVG serializer used in image_to_svg.
+    )docstring")
+        .def(pybind11::init<>())
+        .def_readwrite("encoding", &img2num::ImageToSvgConfig::SvgConfig::encoding, R"docstring(
+    Path encoding flag: 0 = standard, 1 = compact (relative commands, quantized coordinates,
+    paths grouped by color). Default: 0
+    )docstring")
+        .def_readwrite("grid", &img2num::ImageToSvgConfig::SvgConfig::grid, R"docstring(
+    Coordinate grid step (in pixels) used by the compact encoding. Default: 0.5
+    )docstring")
+        .def("__repr__", [](const img2num::ImageToSvgConfig::SvgConfig& c) {
+            return "{'encoding': " + std::to_string(c.encoding) +
+                   ", 'grid': " + std::to_string(c.grid) + "}";
+        });
+
+    pybind11::class_<img2num::ImageToSvgConfig::TilingConfig>(config, "TilingConfig", R"docstring(
+    Configuration for tiled processing of very large images in image_to_svg.
+    )docstring")
+        .def(pybind11::init<>())
+        .def_readwrite(
+            "tile_size", &img2num::ImageToSvgConfig::TilingConfig::tile_size,
+            R"docstring(
+    Edge length (in pixels) of the square tiles the image is processed in. 0 disables
+    tiling; images that fit in one tile are never tiled. Default: 0
+    )docstring"
+        )
+        .def_readwrite(
+            "palette_samples", &img2num::ImageToSvgConfig::TilingConfig::palette_samples,
+            R"docstring(
+    Maximum number of pixels used to learn the palette shared by all tiles. Default: 262144
+    )docstring"
+        )
+        .def("__repr__", [](const img2num::ImageToSvgConfig::TilingConfig& c) {
+            return "{'tile_size': " + std::to_string(c.tile_size) +
+                   ", 'palette_samples': " + std::to_string(c.palette_samples) + "}";
+        });
+
+    pybind11::class_<img2num::ImageToSvgConfig::ResampleConfig>(
+        config, "ResampleConfig", R"docstring(
+    Configuration for processing large images at a reduced resolution in image_to_svg.
+    )docstring"
+    )
+        .def(pybind11::init<>())
+        .def_readwrite(
+            "max_megapixels", &img2num::ImageToSvgConfig::ResampleConfig::max_megapixels,
+            R"docstring(
+    Pixel budget (in megapixels) the pipeline runs at. Larger images are area-averaged down
+    to fit it and the curves are scaled back to the original size. 0 disables. Default: 0
+    )docstring"
+        )
+        .def("__repr__", [](const img2num::ImageToSvgConfig::ResampleConfig& c) {
+            return "{'max_megapixels': " + std::to_string(c.max_megapixels) + "}";
+        });
+
+    pybind11::class_<img2num::ImageToSvgConfig::ExecutionConfig>(
+        config, "ExecutionConfig", R"docstring(
+    Device the GPU-capable stages of image_to_svg run on.
+    )docstring"
+    )
+        .def(pybind11::init<>())
+        .def_readwrite(
+            "bilateral_filter", &img2num::ImageToSvgConfig::ExecutionConfig::bilateral_filter,
+            R"docstring(
+    Device flag for the bilateral filter: 0 = auto (GPU from gpu_min_pixels pixels),
+    1 = CPU, 2 = GPU (CPU when no GPU is available). Default: 0
+    )docstring"
+        )
+        .def_readwrite(
+            "kmeans", &img2num::ImageToSvgConfig::ExecutionConfig::kmeans,
+            R"docstring(
+    Device flag for K-Means: 0 = auto (GPU once width * height * k reaches
+    gpu_min_kmeans_work), 1 = CPU, 2 = GPU. k above 64 always runs on the CPU. Default: 0
+    )docstring"
+        )
+        .def_readwrite(
+            "gpu_min_pixels", &img2num::ImageToSvgConfig::ExecutionConfig::gpu_min_pixels,
+            R"docstring(
+    Smallest image (in pixels) auto runs the bilateral filter on the GPU for. Default: 262144
+    )docstring"
+        )
+        .def_readwrite(
+            "gpu_min_kmeans_work",
+            &img2num::ImageToSvgConfig::ExecutionConfig::gpu_min_kmeans_work,
+            R"docstring(
+    Smallest width * height * k auto runs K-Means on the GPU for. Default: 4194304
+    )docstring"
+        )
+        .def("__repr__", [](const img2num::ImageToSvgConfig::ExecutionConfig& c) {
+            return "{'bilateral_filter': " + std::to_string(c.bilateral_filter) +
+                   ", 'kmeans': " + std::to_string(c.kmeans) +
+                   ", 'gpu_min_pixels': " + std::to_string(c.gpu_min_pixels) +
+                   ", 'gpu_min_kmeans_work': " + std::to_string(c.gpu_min_kmeans_work) + "}";
         });
 
     config
         .def(
             pybind11::init([](pybind11::dict bf_dict, pybind11::dict km_dict,
+                              pybind11::dict svg_dict, pybind11::dict tiling_dict,
+                              pybind11::dict resample_dict, pybind11::dict execution_dict,
                               pybind11::kwargs kwargs) {
                 // hand over ownership to python
                 std::unique_ptr<img2num::ImageToSvgConfig> c =
@@ -337,6 +552,34 @@ PYBIND11_MODULE(_img2num, m) {
                     c->kmeans.k = km_dict["k"].cast<int>();
                 if (km_dict.contains("max_iter"))
                     c->kmeans.max_iter = km_dict["max_iter"].cast<int>();
+                if (km_dict.contains("pyramid_levels"))
+                    c->kmeans.pyramid_levels = km_dict["pyramid_levels"].cast<int>();
+                if (km_dict.contains("refine_iter"))
+                    c->kmeans.refine_iter = km_dict["refine_iter"].cast<int>();
+
+                if (svg_dict.contains("encoding"))
+                    c->svg.encoding = svg_dict["encoding"].cast<uint8_t>();
+                if (svg_dict.contains("grid"))
+                    c->svg.grid = svg_dict["grid"].cast<double>();
+
+                if (tiling_dict.contains("tile_size"))
+                    c->tiling.tile_size = tiling_dict["tile_size"].cast<int>();
+                if (tiling_dict.contains("palette_samples"))
+                    c->tiling.palette_samples = tiling_dict["palette_samples"].cast<int>();
+
+                if (resample_dict.contains("max_megapixels"))
+                    c->resample.max_megapixels = resample_dict["max_megapixels"].cast<double>();
+
+                if (execution_dict.contains("bilateral_filter"))
+                    c->execution.bilateral_filter =
+                        execution_dict["bilateral_filter"].cast<uint8_t>();
+                if (execution_dict.contains("kmeans"))
+                    c->execution.kmeans = execution_dict["kmeans"].cast<uint8_t>();
+                if (execution_dict.contains("gpu_min_pixels"))
+                    c->execution.gpu_min_pixels = execution_dict["gpu_min_pixels"].cast<int64_t>();
+                if (execution_dict.contains("gpu_min_kmeans_work"))
+                    c->execution.gpu_min_kmeans_work =
+                        execution_dict["gpu_min_kmeans_work"].cast<int64_t>();
 
                 // 4. Process remaining top-level kwargs (like color_space or min_cluster_area)
                 if (kwargs.contains("min_cluster_area"))
@@ -349,13 +592,21 @@ PYBIND11_MODULE(_img2num, m) {
                 return c;
             }),
             pybind11::arg("bilateral_filter") = pybind11::dict(), // Defaults to empty dict
-            pybind11::arg("kmeans") = pybind11::dict()            // Defaults to empty dict
+            pybind11::arg("kmeans") = pybind11::dict(),           // Defaults to empty dict
+            pybind11::arg("svg") = pybind11::dict(),              // Defaults to empty dict
+            pybind11::arg("tiling") = pybind11::dict(),           // Defaults to empty dict
+            pybind11::arg("resample") = pybind11::dict(),         // Defaults to empty dict
+            pybind11::arg("execution") = pybind11::dict()         // Defaults to empty dict
         )
         .def_readwrite("bilateral_filter", &img2num::ImageToSvgConfig::bilateral_filter)
         .def_readwrite("min_cluster_area", &img2num::ImageToSvgConfig::min_cluster_area)
         .def_readwrite("min_thickness", &img2num::ImageToSvgConfig::min_thickness)
         .def_readwrite("color_space", &img2num::ImageToSvgConfig::color_space)
         .def_readwrite("kmeans", &img2num::ImageToSvgConfig::kmeans)
+        .def_readwrite("svg", &img2num::ImageToSvgConfig::svg)
+        .def_readwrite("tiling", &img2num::ImageToSvgConfig::tiling)
+        .def_readwrite("resample", &img2num::ImageToSvgConfig::resample)
+        .def_readwrite("execution", &img2num::ImageToSvgConfig::execution)
         .def("__repr__", [](const img2num::ImageToSvgConfig& c) {
             // We use pybind11::repr() to trigger the __repr__ of the nested objects
             std::stringstream ss;
@@ -366,22 +617,48 @@ PYBIND11_MODULE(_img2num, m) {
                << "min_thickness: " << c.min_thickness << ", "
                << "color_space: " << (int)c.color_space << ", "
                << "kmeans: " << pybind11::repr(pybind11::cast(c.kmeans)).cast<std::string>()
-               << "}>";
+               << ", "
+               << "svg: " << pybind11::repr(pybind11::cast(c.svg)).cast<std::string>() << ", "
+               << "tiling: " << pybind11::repr(pybind11::cast(c.tiling)).cast<std::string>()
+               << ", "
+               << "resample: "
+               << pybind11::repr(pybind11::cast(c.resample)).cast<std::string>() << ", "
+               << "execution: "
+               << pybind11::repr(pybind11::cast(c.execution)).cast<std::string>() << "}>";
             return ss.str();
         });
 
+    // ImageView over a numpy buffer, checked to hold width * height pixels of `pixel_format`
+    auto image_view = [](const pybind11::array_t<uint8_t, pybind11::array::c_style>& data,
+                         int width, int height, uint8_t pixel_format) {
+        static constexpr size_t BYTES_PER_PIXEL[] {4, 4, 3, 3, 1}; // indexed by PixelFormat
+        if (pixel_format >= std::size(BYTES_PER_PIXEL))
+            throw std::invalid_argument("pixel_format must be 0 (RGBA) to 4 (grayscale)");
+        if (width < 0 || height < 0)
+            throw std::invalid_argument("width and height must not be negative");
+        const size_t needed {
+            static_cast<size_t>(width) * static_cast<size_t>(height) *
+            BYTES_PER_PIXEL[pixel_format]};
+        if (static_cast<size_t>(data.size()) < needed)
+            throw std::invalid_argument("data is smaller than width * height pixels");
+        return img2num::ImageView {
+            data.data(), width, height, static_cast<img2num::PixelFormat>(pixel_format)};
+    };
+
     m.def(
         "image_to_svg",
-        [](pybind11::array_t<uint8_t, pybind11::array::c_style> data, int width, int height,
-           const img2num::ImageToSvgConfig& cfg) {
-            const uint8_t* data_ptr {static_cast<const uint8_t*>(data.request().ptr)};
+        [image_view](
+            pybind11::array_t<uint8_t, pybind11::array::c_style> data, int width, int height,
+            const img2num::ImageToSvgConfig& cfg, uint8_t pixel_format
+        ) {
+            const img2num::ImageView image {image_view(data, width, height, pixel_format)};
 
-            std::string svg {img2num::image_to_svg(data_ptr, width, height, cfg)};
+            std::string svg {img2num::image_to_svg(image, cfg)};
 
             return pybind11::str(std::move(svg));
         },
         pybind11::arg("data"), pybind11::arg("width"), pybind11::arg("height"),
-        pybind11::arg("cfg"),
+        pybind11::arg("cfg"), pybind11::arg("pixel_format") = 0,
         R"docstring(
         Convert Image to SVG string.
 
@@ -395,6 +672,8 @@ PYBIND11_MODULE(_img2num, m) {
             Height of the image.
         cfg : ImageToSvgConfig
             Configuration object containing filter and clustering parameters.
+        pixel_format : int
+            Layout of each pixel: 0 = RGBA, 1 = BGRA, 2 = RGB, 3 = BGR, 4 = grayscale.
 
         Returns
         -------
@@ -402,4 +681,612 @@ PYBIND11_MODULE(_img2num, m) {
             SVG string representation of the image.
         )docstring"
     );
+
+    m.def(
+        "image_to_svgz",
+        [image_view](
+            pybind11::array_t<uint8_t, pybind11::array::c_style> data, int width, int height,
+            const img2num::ImageToSvgConfig& cfg, uint8_t pixel_format
+        ) {
+            const img2num::ImageView image {image_view(data, width, height, pixel_format)};
+
+            std::vector<uint8_t> svgz {img2num::image_to_svgz(image, cfg)};
+
+            return pybind11::bytes(reinterpret_cast<const char*>(svgz.data()), svgz.size());
+        },
+        pybind11::arg("data"), pybind11::arg("width"), pybind11::arg("height"),
+        pybind11::arg("cfg"), pybind11::arg("pixel_format") = 0,
+        R"docstring(
+        Convert Image to gzip-compressed SVG (SVGZ).
+
+        Parameters
+        ----------
+        data : numpy.ndarray
+            Input image buffer.
+        width : int
+            Width of the image.
+        height : int
+            Height of the image.
+        cfg : ImageToSvgConfig
+            Configuration object containing filter and clustering parameters.
+        pixel_format : int
+            Layout of each pixel: 0 = RGBA, 1 = BGRA, 2 = RGB, 3 = BGR, 4 = grayscale.
+
+        Returns
+        -------
+        bytes
+            A gzip stream that decompresses to the same SVG as image_to_svg.
+        )docstring"
+    );
+
+    m.def(
+        "image_to_svg_batch",
+        [image_view](
+            const std::vector<pybind11::array_t<uint8_t, pybind11::array::c_style>>& data,
+            const std::vector<int>& widths, const std::vector<int>& heights,
+            const std::vector<img2num::ImageToSvgConfig>& cfgs, int num_threads,
+            const std::vector<uint8_t>& pixel_formats
+        ) {
+            if (widths.size() != data.size() || heights.size() != data.size())
+                throw std::invalid_argument("data, widths and heights must have the same length");
+            if (!pixel_formats.empty() && pixel_formats.size() != data.size())
+                throw std::invalid_argument("pixel_formats must be empty or one per image");
+
+            std::vector<img2num::BatchImage> images(data.size());
+            for (size_t i = 0; i < data.size(); ++i)
+                images[i] = image_view(
+                    data[i], widths[i], heights[i], pixel_formats.empty() ? 0 : pixel_formats[i]
+                );
+
+            std::vector<std::string> svgs;
+            {
+                // `data` keeps the buffers alive; no Python objects are touched below
+                pybind11::gil_scoped_release release;
+                svgs = img2num::image_to_svg_batch(images, cfgs, num_threads);
+            }
+
+            pybind11::list out;
+            for (std::string& svg : svgs)
+                out.append(pybind11::str(std::move(svg)));
+            return out;
+        },
+        pybind11::arg("data"), pybind11::arg("widths"), pybind11::arg("heights"),
+        pybind11::arg("cfgs"), pybind11::arg("num_threads") = 0,
+        pybind11::arg("pixel_formats") = std::vector<uint8_t> {},
+        R"docstring(
+        Convert many images to SVG strings, scheduling the work across threads internally.
+
+        Parameters
+        ----------
+        data : list of numpy.ndarray
+            Input image buffers.
+        widths : list of int
+            Width of each image.
+        heights : list of int
+            Height of each image.
+        cfgs : list of ImageToSvgConfig
+            One configuration shared by every image, or one per image.
+        num_threads : int
+            Worker threads to use; 0 uses every hardware thread.
+        pixel_formats : list of int
+            Layout of each image's pixels (see image_to_svg); empty means all RGBA.
+
+        Returns
+        -------
+        list of str
+            One SVG per input, in input order. The GIL is released while they are produced.
+        )docstring"
+    );
+
+    m.def(
+        "warmup", &img2num::warmup,
+        R"docstring(
+        Initialize the GPU and compile its pipelines on a background thread.
+
+        Returns at once. Calls made before the warm-up finishes run on the CPU instead of
+        waiting for it; later calls use the GPU if one was found.
+        )docstring"
+    );
+
+    m.def(
+        "image_to_svg_file",
+        [](const std::string& path, int width, int height, const img2num::ImageToSvgConfig& cfg,
+           size_t offset) {
+            std::string svg;
+            {
+                pybind11::gil_scoped_release release;
+                std::unique_ptr<img2num::RowSource> source {
+                    img2num::map_rgba_file(path, width, height, offset)};
+                svg = img2num::image_to_svg(*source, cfg);
+            }
+            return pybind11::str(std::move(svg));
+        },
+        pybind11::arg("path"), pybind11::arg("width"), pybind11::arg("height"),
+        pybind11::arg("cfg"), pybind11::arg("offset") = 0,
+        R"docstring(
+        Convert a raw RGBA file to SVG string, streaming its rows from disk.
+
+        Parameters
+        ----------
+        path : str
+            File holding width * height packed RGBA pixels in row-major order.
+        width : int
+            Width of the image.
+        height : int
+            Height of the image.
+        cfg : ImageToSvgConfig
+            Configuration object. Set tiling.tile_size to keep memory bounded.
+        offset : int
+            Byte offset of the first pixel.
+
+        Returns
+        -------
+        str
+            SVG string. The GIL is released while it is produced.
+        )docstring"
+    );
+
+    m.def(
+        "image_to_arcs",
+        [image_view](
+            pybind11::array_t<uint8_t, pybind11::array::c_style> data, int width, int height,
+            const img2num::ImageToSvgConfig& cfg, uint8_t pixel_format
+        ) {
+            const img2num::ImageView image {image_view(data, width, height, pixel_format)};
+
+            std::string json {img2num::image_to_arcs(image, cfg)};
+
+            return pybind11::str(std::move(json));
+        },
+        pybind11::arg("data"), pybind11::arg("width"), pybind11::arg("height"),
+        pybind11::arg("cfg"), pybind11::arg("pixel_format") = 0,
+        R"docstring(
+        Convert Image to a shared-arc topology (TopoJSON-style JSON string).
+
+        Parameters
+        ----------
+        data : numpy.ndarray
+            Input image buffer.
+        width : int
+            Width of the image.
+        height : int
+            Height of the image.
+        cfg : ImageToSvgConfig
+            Configuration object containing filter and clustering parameters.
+            Only ``svg.grid`` of the SVG settings is used.
+        pixel_format : int
+            Layout of each pixel: 0 = RGBA, 1 = BGRA, 2 = RGB, 3 = BGR, 4 = grayscale.
+
+        Returns
+        -------
+        str
+            JSON document in the format returned by ``labels_to_arcs``.
+        )docstring"
+    );
+
+    // ------------------------------------------ Vectorization Result -----------------
+    // Arrays returned by the properties are read-only views into the result (no copies);
+    // each view keeps the result alive through its `base`.
+    auto borrowed_view = [](pybind11::handle owner, const auto* ptr,
+                            std::vector<pybind11::ssize_t> shape) {
+        using T = std::remove_cv_t<std::remove_pointer_t<decltype(ptr)>>;
+        pybind11::array_t<T> view(std::move(shape), ptr, owner);
+        view.attr("flags").attr("writeable") = false;
+        return view;
+    };
+
+    pybind11::class_<img2num::VectorizationResult>(m, "VectorizationResult", R"docstring(
+    Vectorized regions of an image stored as flat, contiguous numpy arrays.
+
+    Region ``r`` owns loops ``region_loop_offsets[r]:region_loop_offsets[r + 1]`` and loop ``l``
+    owns curves ``loop_curve_offsets[l]:loop_curve_offsets[l + 1]``.
+    )docstring")
+        .def_readonly("width", &img2num::VectorizationResult::width)
+        .def_readonly("height", &img2num::VectorizationResult::height)
+        .def_property_readonly(
+            "colors",
+            [borrowed_view](pybind11::object self) {
+                const auto& r {self.cast<const img2num::VectorizationResult&>()};
+                return borrowed_view(
+                    self, r.colors.data(), {static_cast<pybind11::ssize_t>(r.num_regions()), 3}
+                );
+            },
+            "Fill color of each region, uint8 array of shape (num_regions, 3)."
+        )
+        .def_property_readonly(
+            "areas",
+            [borrowed_view](pybind11::object self) {
+                const auto& r {self.cast<const img2num::VectorizationResult&>()};
+                return borrowed_view(
+                    self, r.areas.data(), {static_cast<pybind11::ssize_t>(r.areas.size())}
+                );
+            },
+            "Area (in pixels) of each region, int32 array of shape (num_regions,)."
+        )
+        .def_property_readonly(
+            "region_loop_offsets",
+            [borrowed_view](pybind11::object self) {
+                const auto& r {self.cast<const img2num::VectorizationResult&>()};
+                return borrowed_view(
+                    self, r.region_loop_offsets.data(),
+                    {static_cast<pybind11::ssize_t>(r.region_loop_offsets.size())}
+                );
+            },
+            "Loop range of each region, int32 array of shape (num_regions + 1,)."
+        )
+        .def_property_readonly(
+            "loop_curve_offsets",
+            [borrowed_view](pybind11::object self) {
+                const auto& r {self.cast<const img2num::VectorizationResult&>()};
+                return borrowed_view(
+                    self, r.loop_curve_offsets.data(),
+                    {static_cast<pybind11::ssize_t>(r.loop_curve_offsets.size())}
+                );
+            },
+            "Curve range of each loop, int32 array of shape (num_loops + 1,)."
+        )
+        .def_property_readonly(
+            "curves",
+            [borrowed_view](pybind11::object self) {
+                const auto& r {self.cast<const img2num::VectorizationResult&>()};
+                return borrowed_view(
+                    self, r.curves.data(), {static_cast<pybind11::ssize_t>(r.num_curves()), 3, 2}
+                );
+            },
+            "Quadratic Bézier curves, float32 array of shape (num_curves, 3, 2): "
+            "start, control and end point of each curve."
+        )
+        .def_property_readonly(
+            "adjacency_offsets",
+            [borrowed_view](pybind11::object self) {
+                const auto& r {self.cast<const img2num::VectorizationResult&>()};
+                return borrowed_view(
+                    self, r.adjacency_offsets.data(),
+                    {static_cast<pybind11::ssize_t>(r.adjacency_offsets.size())}
+                );
+            },
+            "Neighbour range of each region in adjacency, int32 array of shape (num_regions + 1,)."
+        )
+        .def_property_readonly(
+            "adjacency",
+            [borrowed_view](pybind11::object self) {
+                const auto& r {self.cast<const img2num::VectorizationResult&>()};
+                return borrowed_view(
+                    self, r.adjacency.data(), {static_cast<pybind11::ssize_t>(r.adjacency.size())}
+                );
+            },
+            "Indices of neighbouring regions, int32 array."
+        )
+        .def_property_readonly(
+            "labels",
+            [borrowed_view](pybind11::object self) {
+                const auto& r {self.cast<const img2num::VectorizationResult&>()};
+                return borrowed_view(
+                    self, r.labels.data(),
+                    {static_cast<pybind11::ssize_t>(r.height),
+                     static_cast<pybind11::ssize_t>(r.width)}
+                );
+            },
+            "Region index of each pixel, int32 array of shape (height, width)."
+        )
+        .def_property_readonly("num_regions", &img2num::VectorizationResult::num_regions)
+        .def_property_readonly("num_loops", &img2num::VectorizationResult::num_loops)
+        .def_property_readonly("num_curves", &img2num::VectorizationResult::num_curves)
+        .def("__repr__", [](const img2num::VectorizationResult& r) {
+            std::stringstream ss;
+            ss << "<VectorizationResult {width: " << r.width << ", height: " << r.height
+               << ", regions: " << r.num_regions() << ", loops: " << r.num_loops()
+               << ", curves: " << r.num_curves() << "}>";
+            return ss.str();
+        });
+
+    m.def(
+        "labels_to_vectorization",
+        [](pybind11::array_t<uint8_t, pybind11::array::c_style> data,
+           pybind11::array_t<int32_t, pybind11::array::c_style> labels, int width, int height,
+           int min_area, int min_thickness) {
+            const uint8_t* data_ptr {static_cast<const uint8_t*>(data.request().ptr)};
+            const int32_t* labels_ptr {static_cast<const int32_t*>(labels.request().ptr)};
+
+            return img2num::labels_to_vectorization(
+                data_ptr, labels_ptr, width, height, min_area, min_thickness
+            );
+        },
+        pybind11::arg("data"), pybind11::arg("labels"), pybind11::arg("width"),
+        pybind11::arg("height"), pybind11::arg("min_area"), pybind11::arg("min_thickness"),
+        R"docstring(
+        Convert labels to a structured vectorization result.
+
+        Parameters
+        ----------
+        data : numpy.ndarray
+            Input image data as a uint8 numpy array.
+        labels : numpy.ndarray
+            Label map as an int32 numpy array.
+        width : int
+            Width of the image.
+        height : int
+            Height of the image.
+        min_area : int
+            Minimum cluster area to include.
+        min_thickness: int
+            Minimum thickness a region must have to include.
+
+        Returns
+        -------
+        VectorizationResult
+            Region colors, areas, boundary curves and adjacency.
+        )docstring"
+    );
+
+    m.def(
+        "image_to_vectorization",
+        [image_view](
+            pybind11::array_t<uint8_t, pybind11::array::c_style> data, int width, int height,
+            const img2num::ImageToSvgConfig& cfg, uint8_t pixel_format
+        ) {
+            const img2num::ImageView image {image_view(data, width, height, pixel_format)};
+
+            return img2num::image_to_vectorization(image, cfg);
+        },
+        pybind11::arg("data"), pybind11::arg("width"), pybind11::arg("height"),
+        pybind11::arg("cfg"), pybind11::arg("pixel_format") = 0,
+        R"docstring(
+        Convert Image to a structured vectorization result.
+
+        Parameters
+        ----------
+        data : numpy.ndarray
+            Input image buffer.
+        width : int
+            Width of the image.
+        height : int
+            Height of the image.
+        cfg : ImageToSvgConfig
+            Configuration object containing filter and clustering parameters.
+        pixel_format : int
+            Layout of each pixel: 0 = RGBA, 1 = BGRA, 2 = RGB, 3 = BGR, 4 = grayscale.
+
+        Returns
+        -------
+        VectorizationResult
+            Region colors, areas, boundary curves and adjacency.
+        )docstring"
+    );
+
+    m.def(
+        "vectorization_to_svg",
+        [](const img2num::VectorizationResult& result,
+           const img2num::ImageToSvgConfig::SvgConfig& svg_config) {
+            std::string svg {img2num::vectorization_to_svg(result, svg_config)};
+
+            return pybind11::str(std::move(svg));
+        },
+        pybind11::arg("result"),
+        pybind11::arg("svg_config") = img2num::ImageToSvgConfig::SvgConfig {},
+        R"docstring(
+        Serialize a vectorization result as an SVG string.
+
+        Parameters
+        ----------
+        result : VectorizationResult
+            Regions produced by labels_to_vectorization or image_to_vectorization.
+        svg_config : ImageToSvgConfig.SvgConfig
+            Serializer settings (path encoding and coordinate grid).
+
+        Returns
+        -------
+        str
+            An SVG string containing the data.
+        )docstring"
+    );
+
+    m.def(
+        "vectorization_to_svgz",
+        [](const img2num::VectorizationResult& result,
+           const img2num::ImageToSvgConfig::SvgConfig& svg_config) {
+            std::vector<uint8_t> svgz {img2num::vectorization_to_svgz(result, svg_config)};
+
+            return pybind11::bytes(reinterpret_cast<const char*>(svgz.data()), svgz.size());
+        },
+        pybind11::arg("result"),
+        pybind11::arg("svg_config") = img2num::ImageToSvgConfig::SvgConfig {},
+        R"docstring(
+        Serialize a vectorization result as gzip-compressed SVG (SVGZ).
+
+        Parameters
+        ----------
+        result : VectorizationResult
+            Regions produced by labels_to_vectorization or image_to_vectorization.
+        svg_config : ImageToSvgConfig.SvgConfig
+            Serializer settings (path encoding and coordinate grid).
+
+        Returns
+        -------
+        bytes
+            A gzip stream that decompresses to the same SVG as vectorization_to_svg.
+        )docstring"
+    );
+
+    // ------------------------------------------ Context ------------------------------
+    pybind11::class_<img2num::Context>(m, "Context", R"docstring(
+    Reusable processing context: keeps working buffers and filter kernels between calls so
+    repeated image_to_* calls on same-size images make no large allocations.
+    Not thread-safe; use one per thread.
+    )docstring")
+        .def(pybind11::init<>())
+        .def(
+            "image_to_svg",
+            [image_view](
+                img2num::Context& ctx, pybind11::array_t<uint8_t, pybind11::array::c_style> data,
+                int width, int height, const img2num::ImageToSvgConfig& cfg, uint8_t pixel_format
+            ) {
+                return pybind11::str(
+                    ctx.image_to_svg(image_view(data, width, height, pixel_format), cfg)
+                );
+            },
+            pybind11::arg("data"), pybind11::arg("width"), pybind11::arg("height"),
+            pybind11::arg("cfg"), pybind11::arg("pixel_format") = 0,
+            "Same as image_to_svg, reusing this context's buffers."
+        )
+        .def(
+            "image_to_svgz",
+            [image_view](
+                img2num::Context& ctx, pybind11::array_t<uint8_t, pybind11::array::c_style> data,
+                int width, int height, const img2num::ImageToSvgConfig& cfg, uint8_t pixel_format
+            ) {
+                std::vector<uint8_t> svgz {
+                    ctx.image_to_svgz(image_view(data, width, height, pixel_format), cfg)};
+                return pybind11::bytes(reinterpret_cast<const char*>(svgz.data()), svgz.size());
+            },
+            pybind11::arg("data"), pybind11::arg("width"), pybind11::arg("height"),
+            pybind11::arg("cfg"), pybind11::arg("pixel_format") = 0,
+            "Same as image_to_svgz, reusing this context's buffers."
+        )
+        .def(
+            "image_to_vectorization",
+            [image_view](
+                img2num::Context& ctx, pybind11::array_t<uint8_t, pybind11::array::c_style> data,
+                int width, int height, const img2num::ImageToSvgConfig& cfg, uint8_t pixel_format
+            ) {
+                return ctx.image_to_vectorization(
+                    image_view(data, width, height, pixel_format), cfg
+                );
+            },
+            pybind11::arg("data"), pybind11::arg("width"), pybind11::arg("height"),
+            pybind11::arg("cfg"), pybind11::arg("pixel_format") = 0,
+            "Same as image_to_vectorization, reusing this context's buffers."
+        )
+        .def(
+            "image_to_arcs",
+            [image_view](
+                img2num::Context& ctx, pybind11::array_t<uint8_t, pybind11::array::c_style> data,
+                int width, int height, const img2num::ImageToSvgConfig& cfg, uint8_t pixel_format
+            ) {
+                return pybind11::str(
+                    ctx.image_to_arcs(image_view(data, width, height, pixel_format), cfg)
+                );
+            },
+            pybind11::arg("data"), pybind11::arg("width"), pybind11::arg("height"),
+            pybind11::arg("cfg"), pybind11::arg("pixel_format") = 0,
+            "Same as image_to_arcs, reusing this context's buffers."
+        )
+        .def("release", &img2num::Context::release, "Free every cached buffer and kernel.");
+
+    // ------------------------------------------ Binary Container ---------------------
+    pybind11::class_<img2num::VectorizationBinaryConfig>(m, "VectorizationBinaryConfig", R"docstring(
+    Options for vectorization_to_binary.
+    )docstring")
+        .def(pybind11::init<>())
+        .def_readwrite(
+            "point_format", &img2num::VectorizationBinaryConfig::point_format, R"docstring(
+    Curve point storage flag: 0 = float32, 1 = int16 quantized to ``grid``. Default: 0
+    )docstring"
+        )
+        .def_readwrite("grid", &img2num::VectorizationBinaryConfig::grid, R"docstring(
+    Quantization step (in pixels) for int16 points; 0 picks the finest step that fits. Default: 0
+    )docstring")
+        .def_readwrite(
+            "include_labels", &img2num::VectorizationBinaryConfig::include_labels, R"docstring(
+    Whether to store the per-pixel region raster. Default: False
+    )docstring"
+        )
+        .def("__repr__", [](const img2num::VectorizationBinaryConfig& c) {
+            return "{'point_format': " + std::to_string(c.point_format) +
+                   ", 'grid': " + std::to_string(c.grid) +
+                   ", 'include_labels': " + (c.include_labels ? "True" : "False") + "}";
+        });
+
+    m.def(
+        "vectorization_to_binary",
+        [](const img2num::VectorizationResult& result,
+           const img2num::VectorizationBinaryConfig& config) {
+            std::vector<uint8_t> bin {img2num::vectorization_to_binary(result, config)};
+
+            return pybind11::bytes(reinterpret_cast<const char*>(bin.data()), bin.size());
+        },
+        pybind11::arg("result"), pybind11::arg("config") = img2num::VectorizationBinaryConfig {},
+        R"docstring(
+        Serialize a vectorization result into the binary container format.
+
+        Parameters
+        ----------
+        result : VectorizationResult
+            Regions produced by labels_to_vectorization or image_to_vectorization.
+        config : VectorizationBinaryConfig
+            Point format, quantization step and label raster options.
+
+        Returns
+        -------
+        bytes
+            A little-endian container that can be written to disk as-is.
+        )docstring"
+    );
+
+    m.def(
+        "read_vectorization_binary",
+        [borrowed_view](pybind11::object source) {
+            // The views are based on a memoryview rather than `source`: it holds the buffer
+            // export for as long as they live, so the exporter cannot free or move the memory
+            // (a bytearray refuses to resize, an mmap to close).
+            const pybind11::object buffer {
+                pybind11::reinterpret_steal<pybind11::object>(PyMemoryView_FromObject(source.ptr()))
+            };
+            if (!buffer)
+                throw pybind11::error_already_set();
+            const Py_buffer& buf {*PyMemoryView_GET_BUFFER(buffer.ptr())};
+            if (!PyBuffer_IsContiguous(&buf, 'C'))
+                throw std::invalid_argument("buffer must be contiguous");
+            const img2num::VectorizationBinaryView view {img2num::read_vectorization_binary(
+                static_cast<const uint8_t*>(buf.buf), static_cast<size_t>(buf.len)
+            )};
+            const img2num::VectorizationBinaryHeader& h {*view.header};
+
+            auto n = [](uint64_t count) {
+                return static_cast<pybind11::ssize_t>(count);
+            };
+            pybind11::dict out;
+            out["width"] = h.width;
+            out["height"] = h.height;
+            out["point_scale"] = h.point_scale;
+            out["palette"] = borrowed_view(buffer, view.palette, {n(h.num_colors), 4});
+            out["regions"] = borrowed_view(
+                buffer, reinterpret_cast<const uint32_t*>(view.regions), {n(h.num_regions), 4}
+            );
+            out["loops"] = borrowed_view(
+                buffer, reinterpret_cast<const uint32_t*>(view.loops), {n(h.num_loops), 2}
+            );
+            if (view.curves_i16)
+                out["curves"] = borrowed_view(buffer, view.curves_i16, {n(h.num_curves), 3, 2});
+            else
+                out["curves"] = borrowed_view(buffer, view.curves_f32, {n(h.num_curves), 3, 2});
+            out["adjacency_offsets"] =
+                borrowed_view(buffer, view.adjacency_offsets, {n(h.num_regions) + 1});
+            out["adjacency"] = borrowed_view(buffer, view.adjacency, {n(h.num_adjacency)});
+            if (view.labels)
+                out["labels"] = borrowed_view(buffer, view.labels, {n(h.height), n(h.width)});
+            else
+                out["labels"] = pybind11::none();
+            return out;
+        },
+        pybind11::arg("buffer"),
+        R"docstring(
+        Validate a binary vectorization container and return numpy views into it.
+
+        Parameters
+        ----------
+        buffer : bytes-like
+            The container, e.g. a ``mmap.mmap`` of a file written by vectorization_to_binary.
+            It must be 8-byte aligned. The returned arrays keep it exported, so it stays
+            valid (and cannot be resized or closed) while any of them is alive.
+
+        Returns
+        -------
+        dict
+            ``width``, ``height`` and ``point_scale`` plus read-only arrays ``palette`` (RGBA),
+            ``regions`` (color_index, area, first_loop, num_loops), ``loops``
+            (first_curve, num_curves), ``curves``, ``adjacency_offsets``, ``adjacency`` and
+            ``labels`` (None when not stored). Nothing is copied.
+        )docstring"
+    );
 }
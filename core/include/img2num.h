@@ -10,7 +10,12 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
 #include <string>
+#include <vector>
 
 /// @note All image buffers are assumed to be stored in row-major order, unless otherwise noted.
 namespace img2num {
@@ -36,6 +41,13 @@ struct ImageToSvgConfig {
         /// Maximum number of iterations for the K-Means algorithm.
         /// The algorithm may terminate earlier if it converges.
         int32_t max_iter = 100;
+        /// Number of 2x box-downsampling steps to run the iterations on first (CPU only).
+        /// - 0 = off, 1 = 2x, 2 = 4x per axis.
+        /// The coarse centroids then warm-start the full-resolution iterations below.
+        int32_t pyramid_levels = 0;
+        /// Full-resolution iterations refining the coarse centroids, followed by a final
+        /// full-resolution assignment. Only used with `pyramid_levels` > 0.
+        int32_t refine_iter = 2;
     } kmeans;
 
     /// Minimum area (in pixels) for a region to be included in the SVG.
@@ -50,6 +62,234 @@ struct ImageToSvgConfig {
     /// - 0 = CIE LAB (more perceptually accurate)
     /// - 1 = sRGB (faster).
     uint8_t color_space = 0;
+
+    /// Configuration settings for the SVG serializer in image_to_svg.
+    struct SvgConfig {
+        /// Path encoding flag.
+        /// - 0 = standard (absolute commands, two decimals, one `fill` per path)
+        /// - 1 = compact (relative commands, quantized coordinates, paths grouped by color).
+        uint8_t encoding = 0;
+        /// Coordinate grid step (in pixels) used by the compact encoding.
+        /// All coordinates are snapped to multiples of this value.
+        /// Larger values give smaller documents at the cost of precision.
+        double grid = 0.5;
+    } svg;
+
+    /// Configuration settings for tiled processing of very large images.
+    /// Working memory then scales with one row of tiles instead of the image size.
+    struct TilingConfig {
+        /// Edge length (in pixels) of the square tiles the image is processed in.
+        /// 0 disables tiling; images that fit in one tile are never tiled.
+        int tile_size = 0;
+        /// Maximum number of pixels (of a downscaled copy of the image) used to learn the
+        /// palette shared by all tiles.
+        int palette_samples = 1 << 18;
+    } tiling;
+
+    /// Configuration settings for processing large images at a reduced resolution.
+    /// The input is area-averaged down to the budget, processed, and the curves are scaled
+    /// back to the original size; `min_cluster_area`, `min_thickness` and
+    /// `bilateral_filter.sigma_spatial` keep their meaning in original pixels.
+    struct ResampleConfig {
+        /// Pixel budget (in megapixels) the pipeline runs at. Larger images are downscaled
+        /// to fit it; 0 disables resampling.
+        double max_megapixels = 0.0;
+    } resample;
+
+    /// Device the GPU-capable stages run on. A stage set to the GPU runs on the CPU when no
+    /// GPU is available (or while a warmup() is still running).
+    struct ExecutionConfig {
+        /// Device flag for the bilateral filter.
+        /// - 0 = auto (GPU for images of at least `gpu_min_pixels` pixels)
+        /// - 1 = CPU
+        /// - 2 = GPU.
+        uint8_t bilateral_filter = 0;
+        /// Device flag for K-Means, as for `bilateral_filter`. Auto picks the GPU once
+        /// `width * height * k` reaches `gpu_min_kmeans_work`. k above 64 always runs on the
+        /// CPU.
+        uint8_t kmeans = 0;
+        /// Smallest image (in pixels) auto runs the bilateral filter on the GPU for. Below it
+        /// upload and readback cost more than the CPU filter saves.
+        int64_t gpu_min_pixels = 1 << 18;
+        /// Smallest `width * height * k` auto runs K-Means on the GPU for.
+        int64_t gpu_min_kmeans_work = int64_t {1} << 22;
+    } execution;
+};
+
+/// @brief Vectorized regions of an image stored as flat, contiguous arrays.
+/// @ingroup IMG2NUM_H
+/// @details Regions own a range of loops and loops own a range of curves, both described by
+///          offset arrays (CSR layout): region `r` owns loops
+///          `[region_loop_offsets[r], region_loop_offsets[r + 1])` and loop `l` owns curves
+///          `[loop_curve_offsets[l], loop_curve_offsets[l + 1])`.
+struct VectorizationResult {
+    /// Width of the source image in pixels.
+    int width = 0;
+    /// Height of the source image in pixels.
+    int height = 0;
+
+    /// Fill color of each region as packed RGB triplets (`3 * num_regions()` bytes).
+    std::vector<uint8_t> colors;
+    /// Area (in pixels) of each region.
+    std::vector<int32_t> areas;
+    /// Loop range of each region (`num_regions() + 1` entries).
+    std::vector<int32_t> region_loop_offsets;
+    /// Curve range of each loop (`num_loops() + 1` entries).
+    std::vector<int32_t> loop_curve_offsets;
+    /// Closed quadratic Bézier chains, 6 floats per curve:
+    /// start x, start y, control x, control y, end x, end y.
+    std::vector<float> curves;
+    /// Neighbour range of each region in `adjacency` (`num_regions() + 1` entries).
+    std::vector<int32_t> adjacency_offsets;
+    /// Indices of neighbouring regions.
+    std::vector<int32_t> adjacency;
+    /// Region index of each pixel in row-major order (`width * height` entries).
+    std::vector<int32_t> labels;
+
+    /// Number of regions.
+    inline size_t num_regions() const {
+        return areas.size();
+    }
+    /// Total number of loops across all regions.
+    inline size_t num_loops() const {
+        return loop_curve_offsets.empty() ? 0 : loop_curve_offsets.size() - 1;
+    }
+    /// Total number of curves across all loops.
+    inline size_t num_curves() const {
+        return curves.size() / 6;
+    }
+};
+
+/// @brief Options for vectorization_to_binary.
+/// @ingroup IMG2NUM_H
+struct VectorizationBinaryConfig {
+    /// Curve point storage flag.
+    /// - 0 = float32 (exact)
+    /// - 1 = int16 (quantized to `grid`, half the size).
+    uint8_t point_format = 0;
+    /// Quantization step (in pixels) for int16 points.
+    /// 0 selects the finest power-of-two step that still fits every curve point in int16.
+    double grid = 0.0;
+    /// Whether to store the per-pixel region raster (`VectorizationResult::labels`).
+    bool include_labels = false;
+};
+
+/// @brief Memory layout of one input pixel.
+/// @ingroup IMG2NUM_H
+enum class PixelFormat : uint8_t {
+    /// 4 bytes: red, green, blue, alpha.
+    RGBA8 = 0,
+    /// 4 bytes: blue, green, red, alpha.
+    BGRA8 = 1,
+    /// 3 bytes: red, green, blue (opaque).
+    RGB8 = 2,
+    /// 3 bytes: blue, green, red (opaque).
+    BGR8 = 3,
+    /// 1 byte: luminance (opaque).
+    GRAY8 = 4,
+};
+
+/// @brief Input image in any PixelFormat, with optionally padded rows.
+/// @ingroup IMG2NUM_H
+/// @details The CIELAB pipeline with both stages on the CPU reads the rows in place in their
+///          own format, and the tiled and resampled pipelines convert them a band at a time.
+///          Every other path (the RGB color space, or either stage on the GPU) first copies the
+///          whole image into a tightly packed RGBA buffer of the Workspace, which the bilateral
+///          filter then modifies in place; that copy is made for RGBA input too.
+struct ImageView {
+    /// First pixel of the first row; must stay valid for the whole call.
+    const uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    PixelFormat format = PixelFormat::RGBA8;
+    /// Bytes from the start of one row to the next; 0 means tightly packed rows.
+    size_t stride = 0;
+};
+
+/// @brief One input of image_to_svg_batch.
+/// @ingroup IMG2NUM_H
+using BatchImage = ImageView;
+
+/// @brief An RGBA image whose rows are read on demand rather than held in memory.
+/// @ingroup IMG2NUM_H
+/// @details Consumers read rows in increasing order within a pass, reading each row once per
+///          pass. The tiled image_to_svg pipeline makes two passes (palette sample, then tiles);
+///          the streaming bilateral_filter makes one.
+class RowSource {
+  public:
+    virtual ~RowSource() = default;
+    /// Width of the image in pixels.
+    virtual int width() const = 0;
+    /// Height of the image in pixels.
+    virtual int height() const = 0;
+    /// Copy rows `[y, y + count)` into `out` as packed RGBA (`count * width() * 4` bytes).
+    virtual void read_rows(int y, int count, uint8_t* out) = 0;
+};
+
+/// @brief Fixed-size header at the start of a binary vectorization container.
+/// @ingroup IMG2NUM_H
+/// @details All fields are little-endian. `section_offsets` holds the byte offset of each
+///          section (palette, regions, loops, curves, adjacency offsets, adjacency, labels);
+///          the last entry is the total file size. Every section starts 8-byte aligned.
+struct VectorizationBinaryHeader {
+    /// `"I2NV"`.
+    char magic[4];
+    /// Format version (currently 1).
+    uint16_t version;
+    /// Bit 0: curve points are int16. Bit 1: the label raster is present.
+    uint16_t flags;
+    uint32_t width;
+    uint32_t height;
+    uint32_t num_colors;
+    uint32_t num_regions;
+    uint32_t num_loops;
+    uint32_t num_curves;
+    uint32_t num_adjacency;
+    /// Pixel size of one int16 point unit (1 for float32 points).
+    float point_scale;
+    uint64_t section_offsets[8];
+};
+
+/// @brief Per-region record of a binary vectorization container.
+/// @ingroup IMG2NUM_H
+struct VectorizationBinaryRegion {
+    /// Index into the RGBA palette.
+    uint32_t color_index;
+    /// Area (in pixels).
+    uint32_t area;
+    /// First entry of this region in the loop table.
+    uint32_t first_loop;
+    /// Number of loops owned by this region.
+    uint32_t num_loops;
+};
+
+/// @brief Per-loop record of a binary vectorization container.
+/// @ingroup IMG2NUM_H
+struct VectorizationBinaryLoop {
+    /// First curve of this loop.
+    uint32_t first_curve;
+    /// Number of curves in this loop.
+    uint32_t num_curves;
+};
+
+/// @brief Zero-copy view into a binary vectorization container (e.g. a memory-mapped file).
+/// @ingroup IMG2NUM_H
+/// @details Every pointer aliases the buffer passed to read_vectorization_binary and is only
+///          valid while that buffer is.
+struct VectorizationBinaryView {
+    const VectorizationBinaryHeader* header = nullptr;
+    /// RGBA colors (`4 * header->num_colors` bytes).
+    const uint8_t* palette = nullptr;
+    const VectorizationBinaryRegion* regions = nullptr;
+    const VectorizationBinaryLoop* loops = nullptr;
+    /// 6 values per curve (start, control, end); exactly one of the two is set.
+    const float* curves_f32 = nullptr;
+    const int16_t* curves_i16 = nullptr;
+    /// Neighbour range of each region (`num_regions + 1` entries).
+    const uint32_t* adjacency_offsets = nullptr;
+    const uint32_t* adjacency = nullptr;
+    /// Region index of each pixel, or nullptr when the raster was not stored.
+    const int32_t* labels = nullptr;
 };
 
 /// @copydoc IMG2NUM_H_GAUSSIAN_BLUR_DOC
@@ -69,7 +309,15 @@ void black_threshold_image(
 /// @copydoc IMG2NUM_H_KMEANS_DOC
 void kmeans(
     const uint8_t* data, uint8_t* out_data, int32_t* out_labels, const int32_t width,
-    const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space
+    const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space,
+    const int32_t pyramid_levels = 0, const int32_t refine_iter = 2
+);
+
+/// @copydoc IMG2NUM_H_KMEANS_LABELS_DOC
+void kmeans_labels(
+    const uint8_t* data, int32_t* out_labels, const int32_t width, const int32_t height,
+    const int32_t k, const int32_t max_iter, const uint8_t color_space,
+    const int32_t pyramid_levels = 0, const int32_t refine_iter = 2
 );
 
 /// @copydoc IMG2NUM_H_BILATERAL_FILTER_DOC
@@ -78,17 +326,181 @@ void bilateral_filter(
     uint8_t color_space
 );
 
+/// @copydoc IMG2NUM_H_BILATERAL_FILTER_ROWS_DOC
+void bilateral_filter(
+    RowSource& source, double sigma_spatial, double sigma_range, uint8_t color_space,
+    const std::function<void(int y, const uint8_t* row)>& write_row
+);
+
+/// @copydoc IMG2NUM_H_MAP_RGBA_FILE_DOC
+std::unique_ptr<RowSource>
+map_rgba_file(const std::string& path, const int width, const int height, size_t offset = 0);
+
+/// @copydoc IMG2NUM_H_CALLBACK_ROW_SOURCE_DOC
+std::unique_ptr<RowSource> callback_row_source(
+    const int width, const int height, std::function<void(int y, uint8_t* row)> read_row
+);
+
 /// @copydoc IMG2NUM_H_LABELS_TO_SVG_DOC
 std::string labels_to_svg(
     const uint8_t* data, const int32_t* labels, const int width, const int height,
     const int min_area, const int min_thickness
 );
 
+/// @copydoc IMG2NUM_H_LABELS_TO_SVG_CONFIG_DOC
+std::string labels_to_svg(
+    const uint8_t* data, const int32_t* labels, const int width, const int height,
+    const int min_area, const int min_thickness, const ImageToSvgConfig::SvgConfig& svg_config
+);
+
+/// @copydoc IMG2NUM_H_LABELS_TO_VECTORIZATION_DOC
+VectorizationResult labels_to_vectorization(
+    const uint8_t* data, const int32_t* labels, const int width, const int height,
+    const int min_area, const int min_thickness
+);
+
+/// @copydoc IMG2NUM_H_VECTORIZATION_TO_SVG_DOC
+std::string vectorization_to_svg(
+    const VectorizationResult& result, const ImageToSvgConfig::SvgConfig& svg_config
+);
+
+/// @copydoc IMG2NUM_H_VECTORIZATION_TO_SVGZ_DOC
+std::vector<uint8_t> vectorization_to_svgz(
+    const VectorizationResult& result, const ImageToSvgConfig::SvgConfig& svg_config
+);
+
+/// @copydoc IMG2NUM_H_VECTORIZATION_TO_BINARY_DOC
+std::vector<uint8_t> vectorization_to_binary(
+    const VectorizationResult& result, const VectorizationBinaryConfig& config
+);
+
+/// @copydoc IMG2NUM_H_READ_VECTORIZATION_BINARY_DOC
+VectorizationBinaryView read_vectorization_binary(const uint8_t* data, size_t size);
+
+/// @copydoc IMG2NUM_H_LABELS_TO_ARCS_DOC
+std::string labels_to_arcs(
+    const uint8_t* data, const int32_t* labels, const int width, const int height,
+    const int min_area, const int min_thickness, const double grid
+);
+
 /// @copydoc IMG2NUM_H_IMAGE_TO_SVG_DOC
 std::string image_to_svg(
     const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
 );
 
+/// @copydoc IMG2NUM_H_IMAGE_TO_SVGZ_DOC
+std::vector<uint8_t> image_to_svgz(
+    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+);
+
+/// @copydoc IMG2NUM_H_IMAGE_TO_VECTORIZATION_DOC
+VectorizationResult image_to_vectorization(
+    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+);
+
+/// @copydoc IMG2NUM_H_IMAGE_TO_ARCS_DOC
+std::string image_to_arcs(
+    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+);
+
+/// @copydoc IMG2NUM_H_IMAGE_TO_SVG_VIEW_DOC
+std::string image_to_svg(const ImageView& image, const ImageToSvgConfig& config);
+
+/// @copydoc IMG2NUM_H_IMAGE_TO_SVG_VIEW_DOC
+std::vector<uint8_t> image_to_svgz(const ImageView& image, const ImageToSvgConfig& config);
+
+/// @copydoc IMG2NUM_H_IMAGE_TO_SVG_VIEW_DOC
+VectorizationResult image_to_vectorization(const ImageView& image, const ImageToSvgConfig& config);
+
+/// @copydoc IMG2NUM_H_IMAGE_TO_SVG_VIEW_DOC
+std::string image_to_arcs(const ImageView& image, const ImageToSvgConfig& config);
+
+/// @copydoc IMG2NUM_H_IMAGE_TO_SVG_ROWS_DOC
+std::string image_to_svg(RowSource& source, const ImageToSvgConfig& config);
+
+/// @copydoc IMG2NUM_H_IMAGE_TO_VECTORIZATION_ROWS_DOC
+VectorizationResult image_to_vectorization(RowSource& source, const ImageToSvgConfig& config);
+
+/// @copydoc IMG2NUM_H_IMAGE_TO_SVG_BATCH_DOC
+std::vector<std::string> image_to_svg_batch(
+    const std::vector<BatchImage>& images, const std::vector<ImageToSvgConfig>& configs,
+    int num_threads = 0
+);
+
+/// @brief Completion callback of image_to_svg_async.
+/// @ingroup IMG2NUM_H
+/// Receives the SVG, or an empty string and the exception the pipeline threw.
+using SvgCallback = std::function<void(std::string svg, std::exception_ptr error)>;
+
+/// @copydoc IMG2NUM_H_IMAGE_TO_SVG_ASYNC_DOC
+std::future<std::string> image_to_svg_async(const ImageView& image, const ImageToSvgConfig& config);
+
+/// @copydoc IMG2NUM_H_IMAGE_TO_SVG_ASYNC_CALLBACK_DOC
+void image_to_svg_async(
+    const ImageView& image, const ImageToSvgConfig& config, SvgCallback on_done
+);
+
+/// @copydoc IMG2NUM_H_WARMUP_DOC
+void warmup();
+
+struct Workspace;
+
+/// @copydoc IMG2NUM_H_CONTEXT_DOC
+class Context {
+  public:
+    Context();
+    ~Context();
+    Context(Context&&) noexcept;
+    Context& operator=(Context&&) noexcept;
+    Context(const Context&) = delete;
+    Context& operator=(const Context&) = delete;
+
+    /// @copydoc IMG2NUM_H_IMAGE_TO_SVG_DOC
+    std::string image_to_svg(
+        const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+    );
+
+    /// @copydoc IMG2NUM_H_IMAGE_TO_SVGZ_DOC
+    std::vector<uint8_t> image_to_svgz(
+        const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+    );
+
+    /// @copydoc IMG2NUM_H_IMAGE_TO_VECTORIZATION_DOC
+    VectorizationResult image_to_vectorization(
+        const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+    );
+
+    /// @copydoc IMG2NUM_H_IMAGE_TO_ARCS_DOC
+    std::string image_to_arcs(
+        const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+    );
+
+    /// @copydoc IMG2NUM_H_IMAGE_TO_SVG_VIEW_DOC
+    std::string image_to_svg(const ImageView& image, const ImageToSvgConfig& config);
+
+    /// @copydoc IMG2NUM_H_IMAGE_TO_SVG_VIEW_DOC
+    std::vector<uint8_t> image_to_svgz(const ImageView& image, const ImageToSvgConfig& config);
+
+    /// @copydoc IMG2NUM_H_IMAGE_TO_SVG_VIEW_DOC
+    VectorizationResult
+    image_to_vectorization(const ImageView& image, const ImageToSvgConfig& config);
+
+    /// @copydoc IMG2NUM_H_IMAGE_TO_SVG_VIEW_DOC
+    std::string image_to_arcs(const ImageView& image, const ImageToSvgConfig& config);
+
+    /// @copydoc IMG2NUM_H_IMAGE_TO_SVG_ROWS_DOC
+    std::string image_to_svg(RowSource& source, const ImageToSvgConfig& config);
+
+    /// @copydoc IMG2NUM_H_IMAGE_TO_VECTORIZATION_ROWS_DOC
+    VectorizationResult image_to_vectorization(RowSource& source, const ImageToSvgConfig& config);
+
+    /// @copydoc IMG2NUM_H_CONTEXT_RELEASE_DOC
+    void release();
+
+  private:
+    std::unique_ptr<Workspace> m_workspace;
+};
+
 } // namespace img2num
 
 #endif // IMG2NUM_H
@@ -46,6 +46,13 @@ template <typename PixelT> class Image {
         }
     }
 
+    // Reshape without releasing capacity; pixel values are unspecified afterwards
+    void resize(int width, int height) {
+        this->width = width;
+        this->height = height;
+        data.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+    }
+
     void fill(const PixelT& color) {
         std::fill(data.begin(), data.end(), color);
     }
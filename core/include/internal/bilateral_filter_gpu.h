@@ -1,9 +1,21 @@
 #ifndef BILATERAL_FILTER_GPU_H
 #define BILATERAL_FILTER_GPU_H
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 
+static constexpr double SIGMA_RADIUS_FACTOR {3.0}; // 3 standard deviations
+static constexpr int MAX_KERNEL_RADIUS {50};
+
+// Kernel radius (px) of the bilateral filter, shared by the CPU and GPU paths so both
+// see the same neighbourhood
+inline int bilateral_kernel_radius(double sigma_spatial) {
+    const int raw_radius {static_cast<int>(std::ceil(SIGMA_RADIUS_FACTOR * sigma_spatial))};
+    return std::min(raw_radius, MAX_KERNEL_RADIUS);
+}
+
 // Apply bilateral filter to an image.
 // The filter modifies the image buffer in-place.
 // Parameters:
@@ -0,0 +1,65 @@
+#ifndef CIELAB_PIPELINE_H
+#define CIELAB_PIPELINE_H
+
+#include "internal/Image.h"
+#include "internal/LABAPixel.h"
+#include "internal/RGBAPixel.h"
+#include "internal/workspace.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/*
+CPU stages that keep pixels in float CIELAB between the bilateral filter and
+k-means. The regular entry points convert RGB -> LAB -> RGB (8-bit) inside the
+filter and RGB -> LAB again inside k-means; chaining these two avoids both
+round-trips and the 8-bit quantization in between.
+*/
+
+// Bilateral filter in CIELAB that writes the filtered image as float LAB.
+// Parameters:
+//  - source: Rows of the RGBA input, read once from top to bottom
+//  - sigma_spatial, sigma_range: as for bilateral_filter
+//  - out_lab: Receives width * height LABA pixels (alpha copied from the input)
+//  - scratch: Reusable buffers and kernels
+// Invalid sigmas skip the smoothing and only convert to LAB.
+void bilateral_filter_lab_cpu(
+    img2num::RowSource& source, double sigma_spatial, double sigma_range, LabImage& out_lab,
+    BilateralScratch& scratch
+);
+
+// K-means clustering of a float LAB image.
+// Parameters:
+//  - lab: Pixels to cluster
+//  - out_labels: Receives one cluster index per pixel
+//  - k, max_iter: as for kmeans
+//  - out_centroids: Optional; receives the k centroids converted back to RGBA
+//  - scratch: Optional reusable buffers
+//  - pyramid_levels, refine_iter: coarse-to-fine schedule, as for kmeans
+void kmeans_lab_cpu(
+    const LabImage& lab, int32_t* out_labels, const int32_t k, const int32_t max_iter,
+    ImageLib::Image<ImageLib::RGBAPixel<float>>* out_centroids = nullptr,
+    KMeansScratch* scratch = nullptr, const int32_t pyramid_levels = 0,
+    const int32_t refine_iter = 0
+);
+
+// bilateral_filter_cpu / kmeans_cpu drawing their buffers from a workspace
+void bilateral_filter_cpu(
+    uint8_t* image, size_t width, size_t height, double sigma_spatial, double sigma_range,
+    uint8_t color_space, BilateralScratch& scratch
+);
+void kmeans_cpu(
+    const uint8_t* data, uint8_t* out_data, int32_t* out_labels, const int32_t width,
+    const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space,
+    KMeansScratch& scratch, const int32_t pyramid_levels = 0, const int32_t refine_iter = 0
+);
+
+// Streaming bilateral_filter_cpu: rows are pulled from `source` and each filtered row
+// is passed to `write_row`, in order, with O(radius * width) scratch
+void bilateral_filter_cpu(
+    img2num::RowSource& source, double sigma_spatial, double sigma_range, uint8_t color_space,
+    const std::function<void(int y, const uint8_t* row)>& write_row, BilateralScratch& scratch
+);
+
+#endif // CIELAB_PIPELINE_H
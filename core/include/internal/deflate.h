@@ -0,0 +1,97 @@
+#ifndef DEFLATE_H
+#define DEFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <streambuf>
+#include <vector>
+
+/**
+ * `@brief` Streaming gzip (RFC 1952) encoder producing standard deflate (RFC 1951) data.
+ *
+ * Input is buffered in a sliding window of at most 32 KiB history plus one block of
+ * pending bytes; each full block is LZ77-matched and emitted as a dynamic-Huffman
+ * deflate block, so only the compressed bytes grow with the input size. The output
+ * is readable by zlib, gzip and any SVGZ-aware viewer.
+ */
+class GzipEncoder {
+  public:
+    /**
+     * `@brief` Create an encoder appending to `out`.
+     *
+     * `@param` out Destination for the compressed stream (header is written immediately).
+     */
+    explicit GzipEncoder(std::vector<uint8_t>& out);
+
+    /**
+     * `@brief` Feed uncompressed bytes.
+     *
+     * `@param` data Bytes to compress.
+     * `@param` size Number of bytes.
+     */
+    void write(const uint8_t* data, size_t size);
+
+    /**
+     * `@brief` Flush pending input and write the gzip trailer. No writes may follow.
+     */
+    void finish();
+
+  private:
+    struct Token {
+        uint16_t litlen;  // literal byte, or match length when dist > 0
+        uint16_t dist;    // 0 for literals
+    };
+
+    std::vector<uint8_t>& m_out;
+    uint64_t m_bit_buffer {0};
+    int m_bit_count {0};
+
+    // m_window[0] is stream position m_window_start
+    std::vector<uint8_t> m_window;
+    uint64_t m_window_start {0};
+    uint64_t m_pending {0}; // first stream position not yet compressed
+
+    std::vector<int64_t> m_head; // hash -> most recent stream position
+    std::vector<int64_t> m_prev; // position & window mask -> previous position with same hash
+
+    std::vector<Token> m_tokens;
+    uint32_t m_crc {0xFFFFFFFFu};
+    uint64_t m_total_in {0};
+    bool m_finished {false};
+
+    void put_bits(uint32_t value, int count);
+    void flush_bits();
+
+    void compress_pending(bool flush_all);
+    void emit_block();
+};
+
+/**
+ * `@brief` std::streambuf adapter so serializers writing to std::ostream can emit gzip.
+ *
+ * Characters are collected in a small put area and handed to the encoder in chunks;
+ * call `pubsync()` (or flush the owning stream) before GzipEncoder::finish().
+ */
+class GzipStreamBuf : public std::streambuf {
+  public:
+    explicit GzipStreamBuf(GzipEncoder& encoder)
+        : m_encoder(encoder)
+        , m_buffer(BUFFER_SIZE) {
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    }
+
+  protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+  private:
+    static constexpr size_t BUFFER_SIZE {16384};
+
+    GzipEncoder& m_encoder;
+    std::vector<char> m_buffer;
+
+    void drain();
+};
+
+#endif
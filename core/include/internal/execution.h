@@ -0,0 +1,67 @@
+#ifndef EXECUTION_H
+#define EXECUTION_H
+
+#include "img2num.h"
+#include "internal/kmeans_gpu.h"
+
+#include <cstdint>
+
+/*
+Per-stage device choice (ImageToSvgConfig::ExecutionConfig). Stages ask these with
+whether a GPU is available; pass `true` to decide before initializing the device, so
+work that will run on the CPU anyway never pays for it.
+*/
+
+namespace img2num {
+// Stage flags of ImageToSvgConfig::ExecutionConfig; any other value acts as auto
+constexpr uint8_t EXECUTION_AUTO {0};
+constexpr uint8_t EXECUTION_CPU {1};
+constexpr uint8_t EXECUTION_GPU {2};
+
+// Whether a stage runs on the GPU: never without one, always when forced, and under auto
+// once its work reaches the threshold
+inline bool stage_on_gpu(
+    const uint8_t policy, const bool gpu_available, const int64_t work, const int64_t min_work
+) {
+    if (!gpu_available || policy == EXECUTION_CPU)
+        return false;
+    return policy == EXECUTION_GPU || work >= min_work;
+}
+
+inline bool bilateral_filter_on_gpu(
+    const ImageToSvgConfig::ExecutionConfig& execution, const bool gpu_available,
+    const int64_t num_pixels
+) {
+    return stage_on_gpu(
+        execution.bilateral_filter, gpu_available, num_pixels, execution.gpu_min_pixels
+    );
+}
+
+// k above KMEANS_GPU_MAX_K stays on the CPU, even when the GPU is forced
+inline bool kmeans_on_gpu(
+    const ImageToSvgConfig::ExecutionConfig& execution, const bool gpu_available,
+    const int64_t num_pixels, const int32_t k
+) {
+    if (k > KMEANS_GPU_MAX_K)
+        return false;
+    return stage_on_gpu(
+        execution.kmeans, gpu_available, num_pixels * k, execution.gpu_min_kmeans_work
+    );
+}
+
+// Whether filter + k-means of an image touch the GPU at all
+inline bool clusters_on_gpu(
+    const ImageToSvgConfig& config, const bool gpu_available, const int64_t num_pixels
+) {
+    return bilateral_filter_on_gpu(config.execution, gpu_available, num_pixels) ||
+           kmeans_on_gpu(config.execution, gpu_available, num_pixels, config.kmeans.k);
+}
+
+// Whether any image run with `config` might use the GPU, before its size is known
+inline bool may_use_gpu(const ImageToSvgConfig& config) {
+    return config.execution.bilateral_filter != EXECUTION_CPU ||
+           config.execution.kmeans != EXECUTION_CPU;
+}
+} // namespace img2num
+
+#endif // EXECUTION_H
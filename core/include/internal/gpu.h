@@ -6,12 +6,19 @@
 #include <emscripten/html5.h>
 #endif
 
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
 #include <webgpu/webgpu_cpp.h>
 
 // auto generated by tools/embed_shaders.py
@@ -24,12 +31,103 @@ class GPU {
     wgpu::Device device;
     wgpu::Queue queue;
 
-    bool adapter_ready = false;
-    bool device_ready = false;
-    bool gpu_initialized = false;
+    std::atomic<bool> gpu_initialized {false};
+    std::mutex init_mutex; // serializes init_gpu
+
+    // Uncaptured device errors so far; the callback cannot capture `this`
+    inline static std::atomic<uint32_t> uncaptured_errors {0};
+
+    // Dawn objects are not thread-safe: every use of the device, the pipeline cache and the
+    // pool below happens under this lock (see lock_device)
+    std::recursive_mutex device_mutex;
+
+    // Background initialization started by start_warmup
+    enum WarmupState { WARMUP_NONE, WARMUP_RUNNING, WARMUP_DONE };
+    std::atomic<int> warmup_state {WARMUP_NONE};
+    std::thread warmup_thread;
+
+    // Compiled pipelines and their bind-group layout 0, by shader id. Built on first use
+    // (or by prewarm_pipelines) and kept for the lifetime of the device.
+    struct CachedPipeline {
+        wgpu::ComputePipeline pipeline;
+        wgpu::BindGroupLayout layout;
+    };
+    std::map<std::string, CachedPipeline, std::less<>> pipeline_cache;
+
+    // Idle buffers and textures handed back by releaseBuffer / releaseTexture. Buffers are
+    // keyed by (usage, size class) and textures by (format, usage, width, height); each
+    // entry remembers when it was released so the oldest are destroyed first when the pool
+    // goes over pool_limit.
+    template <typename Resource> struct Pooled {
+        Resource resource;
+        uint64_t bytes;
+        uint64_t released;
+    };
+    using BufferKey = std::pair<uint64_t, uint64_t>;
+    using TextureKey = std::tuple<uint32_t, uint64_t, uint32_t, uint32_t>;
+    std::multimap<BufferKey, Pooled<wgpu::Buffer>> buffer_pool;
+    std::multimap<TextureKey, Pooled<wgpu::Texture>> texture_pool;
+    uint64_t pool_bytes = 0;
+    uint64_t pool_limit = 256ull << 20;
+    uint64_t pool_clock = 0;
 
     GPU() = default;
 
+    CachedPipeline cachedPipeline(const std::string& shader_id) {
+        std::lock_guard<std::recursive_mutex> lock(device_mutex);
+        auto it = pipeline_cache.find(shader_id);
+        if (it != pipeline_cache.end())
+            return it->second;
+
+        CachedPipeline cached;
+        cached.pipeline = createPipeline(shader_id, shader_id);
+        if (!cached.pipeline)
+            return cached; // not cached, so a later call can retry
+        cached.layout = cached.pipeline.GetBindGroupLayout(0);
+        pipeline_cache.emplace(shader_id, cached);
+        return cached;
+    }
+
+    static TextureKey textureKey(const wgpu::TextureDescriptor& desc) {
+        return {
+            static_cast<uint32_t>(desc.format), static_cast<uint64_t>(desc.usage),
+            desc.size.width, desc.size.height};
+    }
+
+    static uint64_t bytesPerTexel(const wgpu::TextureFormat format) {
+        return format == wgpu::TextureFormat::RGBA8Unorm ? 4 : 16;
+    }
+
+    // Destroys the least recently released resources until at most `keep` bytes are
+    // pooled. Caller holds device_mutex.
+    void evictPooled(const uint64_t keep) {
+        while (pool_bytes > keep && (!buffer_pool.empty() || !texture_pool.empty())) {
+            auto oldest_buffer = buffer_pool.begin();
+            for (auto it = buffer_pool.begin(); it != buffer_pool.end(); ++it) {
+                if (it->second.released < oldest_buffer->second.released)
+                    oldest_buffer = it;
+            }
+            auto oldest_texture = texture_pool.begin();
+            for (auto it = texture_pool.begin(); it != texture_pool.end(); ++it) {
+                if (it->second.released < oldest_texture->second.released)
+                    oldest_texture = it;
+            }
+            const bool take_buffer {
+                texture_pool.empty() ||
+                (!buffer_pool.empty() &&
+                 oldest_buffer->second.released < oldest_texture->second.released)};
+            if (take_buffer) {
+                pool_bytes -= oldest_buffer->second.bytes;
+                oldest_buffer->second.resource.Destroy();
+                buffer_pool.erase(oldest_buffer);
+            } else {
+                pool_bytes -= oldest_texture->second.bytes;
+                oldest_texture->second.resource.Destroy();
+                texture_pool.erase(oldest_texture);
+            }
+        }
+    }
+
     bool validate_device() {
         if (!device)
             return false;
@@ -66,6 +164,47 @@ class GPU {
         return gpu_initialized;
     }
 
+    // Validation and other device errors reported so far (each is also printed)
+    uint32_t error_count() const {
+        return uncaptured_errors.load(std::memory_order_relaxed);
+    }
+
+    // Held by each GPU stage from its first command to its last readback, so stages started
+    // on different threads (image_to_svg_async's lane, image_to_svg_batch, the synchronous
+    // entry points) take turns on the device. Recursive: stages may call each other.
+    std::unique_lock<std::recursive_mutex> lock_device() {
+        return std::unique_lock<std::recursive_mutex>(device_mutex);
+    }
+
+    // init_gpu + is_initialized for callers that can run on the CPU instead: while a
+    // start_warmup is still running this returns false at once rather than waiting for it
+    bool ensure_initialized() {
+        const int state {warmup_state.load(std::memory_order_acquire)};
+        if (state == WARMUP_RUNNING)
+            return false;
+        if (state == WARMUP_NONE)
+            init_gpu();
+        return gpu_initialized;
+    }
+
+    // Requests the device and compiles every pipeline (init_gpu(true)) on a background
+    // thread; only the first call does anything. Without threads (Emscripten without
+    // pthreads) the work runs on the calling thread instead.
+    void start_warmup() {
+        int expected {WARMUP_NONE};
+        if (!warmup_state.compare_exchange_strong(expected, WARMUP_RUNNING))
+            return;
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+        init_gpu(true);
+        warmup_state.store(WARMUP_DONE, std::memory_order_release);
+#else
+        warmup_thread = std::thread([this] {
+            init_gpu(true);
+            warmup_state.store(WARMUP_DONE, std::memory_order_release);
+        });
+#endif
+    }
+
     // Delete copy constructor and assignment operator to prevent duplication
     GPU(const GPU&) = delete;
     GPU& operator=(const GPU&) = delete;
@@ -85,6 +224,7 @@ class GPU {
         return "";
     }
 
+    // Compiles a new pipeline on every call; use getPipeline for the cached one
     wgpu::ComputePipeline createPipeline(const std::string& filename, const std::string& label) {
         wgpu::ShaderSourceWGSL wgsl;
         std::string shaderCode = readWGSLFile(filename);
@@ -100,6 +240,140 @@ class GPU {
         return device.CreateComputePipeline(&cpd);
     };
 
+    // Compute pipeline (entry point `main`) of an embedded shader, compiled once per device
+    wgpu::ComputePipeline getPipeline(const std::string& shader_id) {
+        return cachedPipeline(shader_id).pipeline;
+    }
+
+    // Bind-group layout 0 of getPipeline(shader_id)
+    wgpu::BindGroupLayout getBindGroupLayout(const std::string& shader_id) {
+        return cachedPipeline(shader_id).layout;
+    }
+
+    // Compile every embedded shader now, so no later call pays for shader compilation; every
+    // file in resources/ is embedded, so it must only hold shaders the pipeline uses
+    void prewarm_pipelines() {
+        if (!gpu_initialized)
+            return;
+        for (const auto& entry : embedded_shaders::shaders)
+            cachedPipeline(std::string(entry.id));
+    }
+
+    // Size a pooled buffer is allocated with: 256-byte granules up to 1 KiB, then a quarter
+    // of the enclosing power of two, so a buffer is never more than 25% larger than asked
+    static uint64_t bufferSizeClass(const uint64_t size) {
+        if (size <= 256)
+            return 256;
+        if (size <= 1024)
+            return ((size + 255) / 256) * 256;
+        uint64_t power {1024};
+        while (power * 2 <= size)
+            power *= 2;
+        const uint64_t step {power / 4};
+        return ((size + step - 1) / step) * step;
+    }
+
+    // A buffer of at least `size` bytes from the pool, or a new one of the size class.
+    // Bind entries and copies must keep using `size`, not the buffer's own size.
+    wgpu::Buffer acquireBuffer(const uint64_t size, const wgpu::BufferUsage usage) {
+        const uint64_t size_class {bufferSizeClass(size)};
+        std::lock_guard<std::recursive_mutex> lock(device_mutex);
+        auto it = buffer_pool.find({static_cast<uint64_t>(usage), size_class});
+        if (it != buffer_pool.end()) {
+            wgpu::Buffer buffer {std::move(it->second.resource)};
+            pool_bytes -= it->second.bytes;
+            buffer_pool.erase(it);
+            return buffer;
+        }
+        wgpu::BufferDescriptor desc = {};
+        desc.size = size_class;
+        desc.usage = usage;
+        return device.CreateBuffer(&desc);
+    }
+
+    // Hands a buffer from acquireBuffer back to the pool; `size` and `usage` as acquired.
+    // The buffer must be unmapped.
+    void releaseBuffer(wgpu::Buffer buffer, const uint64_t size, const wgpu::BufferUsage usage) {
+        if (!buffer)
+            return;
+        const uint64_t size_class {bufferSizeClass(size)};
+        std::lock_guard<std::recursive_mutex> lock(device_mutex);
+        if (size_class > pool_limit) {
+            buffer.Destroy();
+            return;
+        }
+        buffer_pool.emplace(
+            BufferKey {static_cast<uint64_t>(usage), size_class},
+            Pooled<wgpu::Buffer> {std::move(buffer), size_class, pool_clock++}
+        );
+        pool_bytes += size_class;
+        evictPooled(pool_limit);
+    }
+
+    // A 2D texture matching `desc` (format, usage and size) from the pool, or a new one.
+    // Pooled textures keep their previous contents.
+    wgpu::Texture acquireTexture(const wgpu::TextureDescriptor& desc) {
+        std::lock_guard<std::recursive_mutex> lock(device_mutex);
+        auto it = texture_pool.find(textureKey(desc));
+        if (it != texture_pool.end()) {
+            wgpu::Texture texture {std::move(it->second.resource)};
+            pool_bytes -= it->second.bytes;
+            texture_pool.erase(it);
+            return texture;
+        }
+        return device.CreateTexture(&desc);
+    }
+
+    // Hands a texture from acquireTexture back to the pool; `desc` as acquired
+    void releaseTexture(wgpu::Texture texture, const wgpu::TextureDescriptor& desc) {
+        if (!texture)
+            return;
+        const uint64_t bytes {
+            static_cast<uint64_t>(desc.size.width) * desc.size.height * bytesPerTexel(desc.format)};
+        std::lock_guard<std::recursive_mutex> lock(device_mutex);
+        if (bytes > pool_limit) {
+            texture.Destroy();
+            return;
+        }
+        texture_pool.emplace(
+            textureKey(desc), Pooled<wgpu::Texture> {std::move(texture), bytes, pool_clock++}
+        );
+        pool_bytes += bytes;
+        evictPooled(pool_limit);
+    }
+
+    // Caps the memory held by idle pooled resources (256 MiB by default); 0 disables
+    // pooling. Resources over the new cap are destroyed now.
+    void set_pool_limit(const uint64_t bytes) {
+        std::lock_guard<std::recursive_mutex> lock(device_mutex);
+        pool_limit = bytes;
+        evictPooled(pool_limit);
+    }
+
+    // Destroys idle pooled resources, oldest first, until at most `keep_bytes` remain
+    void trim_pool(const uint64_t keep_bytes = 0) {
+        std::lock_guard<std::recursive_mutex> lock(device_mutex);
+        evictPooled(keep_bytes);
+    }
+
+    // Bytes currently held by idle pooled resources
+    uint64_t pooled_bytes() {
+        std::lock_guard<std::recursive_mutex> lock(device_mutex);
+        return pool_bytes;
+    }
+
+    // Blocks until `future` has completed and its callback has run; the callback must have
+    // been registered with CallbackMode::WaitAnyOnly. Native builds sleep inside WaitAny
+    // rather than spinning on ProcessEvents; the browser is polled, yielding between polls.
+    void wait(const wgpu::Future& future) {
+#if defined(__EMSCRIPTEN__)
+        while (instance.WaitAny(future, 0) == wgpu::WaitStatus::TimedOut)
+            emscripten_sleep(1);
+#else
+        instance.WaitAny(future, UINT64_MAX);
+#endif
+    }
+
     static uint32_t getAlignedBytesPerRow(uint32_t width, uint32_t bytesPerPixel = 4) {
         uint32_t unaligned = width * bytesPerPixel;
         uint32_t align = 256;
@@ -128,11 +402,23 @@ class GPU {
         );
     };
 
-    void init_gpu() {
-        if (gpu_initialized)
+    // `prewarm` also compiles every embedded shader (see prewarm_pipelines)
+    void init_gpu(const bool prewarm = false) {
+        std::lock_guard<std::mutex> lock(init_mutex);
+        if (gpu_initialized) {
+            if (prewarm)
+                prewarm_pipelines();
             return;
+        }
 
         wgpu::InstanceDescriptor instanceDesc = {};
+#if !defined(__EMSCRIPTEN__)
+        // lets wait() sleep inside WaitAny instead of polling
+        static const wgpu::InstanceFeatureName timedWaitAny {
+            wgpu::InstanceFeatureName::TimedWaitAny};
+        instanceDesc.requiredFeatureCount = 1;
+        instanceDesc.requiredFeatures = &timedWaitAny;
+#endif
         instance = wgpu::CreateInstance(&instanceDesc);
 
         if (!instance) {
@@ -144,11 +430,17 @@ class GPU {
         // 1. Get Adapter
         // ---------------------------------------------------------
         std::cout << "Requesting Adapter..." << std::endl;
-        adapter_ready = false;
 
-        instance.RequestAdapter(
-            nullptr,
-            wgpu::CallbackMode::AllowProcessEvents, // <--- ALLOW EVENTS
+        wgpu::RequestAdapterOptions adapterOptions = {};
+#if !defined(__EMSCRIPTEN__)
+        // IMG2NUM_WEBGPU_FALLBACK=1 picks Dawn's software adapter (SwiftShader), so the GPU
+        // stages can run on a headless machine
+        const char* fallback {std::getenv("IMG2NUM_WEBGPU_FALLBACK")};
+        adapterOptions.forceFallbackAdapter = fallback && *fallback && *fallback != '0';
+#endif
+
+        wgpu::Future adapterFuture = instance.RequestAdapter(
+            &adapterOptions, wgpu::CallbackMode::WaitAnyOnly,
             [this](wgpu::RequestAdapterStatus status, wgpu::Adapter a, wgpu::StringView msg) {
                 if (status == wgpu::RequestAdapterStatus::Success) {
                     adapter = std::move(a);
@@ -158,17 +450,9 @@ class GPU {
                               << std::string_view(msg.data ? msg.data : "", msg.length)
                               << std::endl;
                 }
-                adapter_ready = true; // Unblock the loop
             }
         );
-
-        // WAIT LOOP: Yield to browser so it can actually find the adapter
-        while (!adapter_ready) {
-            instance.ProcessEvents();
-#if defined(__EMSCRIPTEN__)
-            emscripten_sleep(10); // Sleep 10ms
-#endif
-        }
+        wait(adapterFuture);
 
         if (!adapter) {
             std::cerr << "Fatal: Could not get WebGPU Adapter." << std::endl;
@@ -179,11 +463,12 @@ class GPU {
         // 2. Get Device
         // ---------------------------------------------------------
         std::cout << "Requesting Device..." << std::endl;
-        device_ready = false;
 
         wgpu::DeviceDescriptor deviceDesc = {};
         deviceDesc.SetUncapturedErrorCallback([](const wgpu::Device&, wgpu::ErrorType type,
                                                  wgpu::StringView msg) {
+            uncaptured_errors.fetch_add(1, std::memory_order_relaxed);
+
             // 1. Safely extract the string using the provided length
             std::string err_str = (msg.data && msg.length > 0) ? std::string(msg.data, msg.length)
                                                                : "Unknown Error (Null message)";
@@ -220,9 +505,8 @@ class GPU {
             deviceDesc.requiredLimits = &requiredLimits;
         }
 
-        adapter.RequestDevice(
-            &deviceDesc,
-            wgpu::CallbackMode::AllowProcessEvents, // <--- ALLOW EVENTS
+        wgpu::Future deviceFuture = adapter.RequestDevice(
+            &deviceDesc, wgpu::CallbackMode::WaitAnyOnly,
             [this](wgpu::RequestDeviceStatus status, wgpu::Device d, wgpu::StringView msg) {
                 if (status == wgpu::RequestDeviceStatus::Success) {
                     device = std::move(d);
@@ -233,17 +517,9 @@ class GPU {
                                                              : "Unknown error")
                               << std::endl;
                 }
-                device_ready = true; // Unblock the loop
             }
         );
-
-        // WAIT LOOP
-        while (!device_ready) {
-            instance.ProcessEvents();
-#if defined(__EMSCRIPTEN__)
-            emscripten_sleep(10);
-#endif
-        }
+        wait(deviceFuture);
 
         if (!device) {
             std::cerr << "Fatal: Could not get WebGPU Device." << std::endl;
@@ -258,9 +534,16 @@ class GPU {
         queue = device.GetQueue();
         gpu_initialized = true;
         std::cout << "GPU Fully Initialized." << std::endl;
+
+        if (prewarm)
+            prewarm_pipelines();
     };
 
     ~GPU() {
+        if (warmup_thread.joinable())
+            warmup_thread.join();
+        trim_pool();
+        pipeline_cache.clear();
         device = nullptr;
         adapter = nullptr;
         queue = nullptr;
@@ -0,0 +1,43 @@
+#ifndef GPU_PIPELINE_H
+#define GPU_PIPELINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <webgpu/webgpu_cpp.h>
+
+/*
+GPU stages that keep pixels on the device between the bilateral filter and
+k-means. The regular entry points read the filtered image back into host memory
+and k-means uploads it again (as RGBA32Float, 4x the bytes); chaining these two
+leaves the filtered texture on the device, so only the final labels and
+centroids are read back.
+
+The hand-off texture is RGBA32Float with the channels k-means clusters on, on
+the scale the k-means shaders expect: RGB / 255 in RGB mode, L*a*b* / 255 in
+CIELAB mode, with alpha / 255. It is drawn from the GPU pool (see gpu.h).
+*/
+
+// Bilateral filter on the device, ending in the k-means hand-off texture.
+// Parameters:
+//  - image: RGBA pixel buffer to upload
+//  - width, height, sigma_spatial, sigma_range, color_space: as for bilateral_filter_gpu
+//  - out_desc: Receives the descriptor to return the texture to the pool with
+// Invalid sigmas skip the smoothing and only convert. The work is submitted but not
+// waited on; later submissions that read the texture are ordered after it.
+wgpu::Texture bilateral_filter_gpu_resident(
+    const uint8_t* image, size_t width, size_t height, double sigma_spatial, double sigma_range,
+    uint8_t color_space, wgpu::TextureDescriptor& out_desc
+);
+
+// K-means clustering of a hand-off texture, as for kmeans_gpu.
+// Parameters:
+//  - input: Texture from bilateral_filter_gpu_resident (needs TextureBinding and CopySrc)
+//  - width, height: Texture dimensions (px)
+//  - out_labels: Receives one cluster index per pixel
+//  - k, max_iter: as for kmeans; k at most KMEANS_GPU_MAX_K (kmeans_gpu.h)
+void kmeans_gpu_resident(
+    const wgpu::Texture& input, const int32_t width, const int32_t height, int32_t* out_labels,
+    const int32_t k, const int32_t max_iter
+);
+
+#endif // GPU_PIPELINE_H
@@ -2,6 +2,7 @@
 #define GRAPH_H
 
 #include "internal/node.h"
+#include "internal/shared_contours.h"
 
 #include <unordered_map>
 
@@ -35,6 +36,8 @@ class Graph {
     int m_width, m_height;
     std::unique_ptr<std::vector<Node_ptr>> m_nodes;
     std::unordered_map<int32_t, int32_t> m_node_ids;
+    // shared-edge topology from the last compute_contours() call
+    SharedTopology m_topology;
 
     void hash_node_ids(void);
     void process_overlapping_edges();
@@ -101,8 +104,28 @@ class Graph {
     void discover_edges(
         const std::vector<int32_t>& region_labels, const int32_t width, const int32_t height
     );
-    void merge_small_area_nodes(const int32_t min_area, const int32_t min_thickness = 0);
-    void compute_contours();
+    /**
+     * `@brief` Merge nodes smaller or thinner than the limits into their best neighbour.
+     *
+     * `@param` pinned Optional flag per node id; pinned nodes are never merged away,
+     * though they may absorb others.
+     */
+    void merge_small_area_nodes(
+        const int32_t min_area, const int32_t min_thickness = 0,
+        const std::vector<uint8_t>& pinned = {}
+    );
+    /**
+     * `@brief` Fit shared-edge contours for every surviving node.
+     *
+     * `@param` labels Region raster (e.g. the one passed to discover_edges); overwritten in
+     * place with the current node id per pixel, -1 where no node remains.
+     */
+    void compute_contours(std::vector<int32_t>& labels);
+
+    // arcs are shared between neighbouring regions; loops are keyed by node id
+    inline const SharedTopology& get_topology() const {
+        return m_topology;
+    }
 };
 
 #endif
@@ -4,6 +4,10 @@
 #include <cstddef>
 #include <cstdint>
 
+// Largest k the GPU k-means supports: the per-workgroup cluster sums of
+// assign_update_shader.wgsl (MAX_K there) hold this many clusters. Larger k throws.
+static constexpr int32_t KMEANS_GPU_MAX_K {64};
+
 void kmeans_gpu(
     const uint8_t* data, uint8_t* out_data, int32_t* out_labels, const int32_t width,
     const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space
@@ -0,0 +1,80 @@
+#ifndef PIXEL_FORMAT_H
+#define PIXEL_FORMAT_H
+
+#include "img2num.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+Readers for ImageView inputs. The first stage of every pipeline pulls pixels
+through these, so non-RGBA or padded inputs are converted a row (or a pixel) at a
+time instead of being repacked up front.
+*/
+
+namespace img2num {
+// 0 for an unknown format
+inline size_t bytes_per_pixel(const PixelFormat format) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+    case PixelFormat::BGRA8:
+        return 4;
+    case PixelFormat::RGB8:
+    case PixelFormat::BGR8:
+        return 3;
+    case PixelFormat::GRAY8:
+        return 1;
+    }
+    return 0;
+}
+
+// Bytes between consecutive rows (the packed row size when `stride` is 0)
+inline size_t row_stride(const ImageView& image) {
+    return image.stride ? image.stride
+                        : static_cast<size_t>(image.width) * bytes_per_pixel(image.format);
+}
+
+// True when the view is tightly packed RGBA, i.e. usable as a plain `const uint8_t*`
+bool is_packed_rgba(const ImageView& image);
+
+// Throws std::invalid_argument for null data, non-positive dimensions, an unknown
+// format or a stride shorter than one row
+void validate_image_view(const ImageView& image, const char* caller);
+
+// Convert row `y` to packed RGBA (`width * 4` bytes)
+void load_rgba_row(const ImageView& image, const int y, uint8_t* out);
+
+// Convert the whole image to packed RGBA
+void load_rgba(const ImageView& image, std::vector<uint8_t>& out);
+
+// R, G, B of pixel (x, y)
+inline void pixel_rgb(
+    const ImageView& image, const size_t x, const size_t y, uint8_t& r, uint8_t& g, uint8_t& b
+) {
+    const uint8_t* row {image.data + y * row_stride(image)};
+    switch (image.format) {
+    case PixelFormat::RGBA8:
+    case PixelFormat::RGB8: {
+        const uint8_t* p {row + x * bytes_per_pixel(image.format)};
+        r = p[0];
+        g = p[1];
+        b = p[2];
+        break;
+    }
+    case PixelFormat::BGRA8:
+    case PixelFormat::BGR8: {
+        const uint8_t* p {row + x * bytes_per_pixel(image.format)};
+        r = p[2];
+        g = p[1];
+        b = p[0];
+        break;
+    }
+    case PixelFormat::GRAY8:
+        r = g = b = row[x];
+        break;
+    }
+}
+} // namespace img2num
+
+#endif // PIXEL_FORMAT_H
@@ -0,0 +1,35 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include "img2num.h"
+#include "internal/workspace.h"
+
+/*
+Reduced-resolution image_to_svg pipeline (config.resample). Filter and k-means
+cost grows with the pixel count, while the detail that survives into the SVG is
+bounded by min_cluster_area, so inputs above the pixel budget are:
+
+1. Area-averaged down to the largest size within `max_megapixels`, keeping the
+   aspect ratio (one pass over the rows).
+2. Run through the regular (or, if still larger than a tile, tiled) pipeline
+   with min_cluster_area, min_thickness and sigma_spatial rescaled, so they
+   keep their meaning in original pixels.
+3. Scaled back: curve coordinates and region areas are mapped to the original
+   size before serialization, and the region raster (if any) is upsampled by
+   nearest neighbour.
+*/
+
+namespace img2num {
+// True when config.resample sets a budget and the image exceeds it
+bool uses_resampling(const int width, const int height, const ImageToSvgConfig& config);
+
+// Run the reduced-resolution pipeline; the downscaled copy and all scratch buffers come
+// from `workspace`. The result describes the original `source` size; its `labels` are
+// upsampled to that size only `with_labels`.
+VectorizationResult resampled_vectorization(
+    RowSource& source, const ImageToSvgConfig& config, const bool use_gpu, Workspace& workspace,
+    const bool with_labels
+);
+} // namespace img2num
+
+#endif // RESAMPLE_H
@@ -0,0 +1,32 @@
+#ifndef ROW_SOURCE_H
+#define ROW_SOURCE_H
+
+#include "img2num.h"
+
+#include <cstdint>
+
+namespace img2num {
+// RowSource over a resident image in any PixelFormat, so the in-memory entry points can
+// share the streaming stages; rows are converted to RGBA as they are read
+class MemoryRowSource final : public RowSource {
+  public:
+    MemoryRowSource(const uint8_t* data, const int width, const int height);
+    explicit MemoryRowSource(const ImageView& image);
+
+    int width() const override {
+        return m_image.width;
+    }
+    int height() const override {
+        return m_image.height;
+    }
+    void read_rows(int y, int count, uint8_t* out) override;
+
+  private:
+    ImageView m_image;
+};
+
+// Throws std::invalid_argument unless rows [y, y + count) lie inside the source
+void check_row_range(const RowSource& source, const int y, const int count);
+} // namespace img2num
+
+#endif // ROW_SOURCE_H
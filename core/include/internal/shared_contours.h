@@ -8,6 +8,41 @@
 #include <unordered_map>
 #include <vector>
 
+/**
+ * `@brief` Shared-edge topology of a labelled image.
+ *
+ * Every canonical edge between two regions (or a region and the image frame) is
+ * fitted once and stored in `arcs`. Region loops reference arcs by index; a
+ * negative reference `~i` (i.e. `-i - 1`) walks arc `i` backwards, following the
+ * TopoJSON convention.
+ */
+struct SharedTopology {
+    // arcs[i] is a continuous quadratic chain (arcs[i][k].p2 == arcs[i][k + 1].p0)
+    std::vector<std::vector<QuadBezier>> arcs;
+    // region id -> closed loops, each a sequence of signed arc references
+    std::unordered_map<int32_t, std::vector<std::vector<int32_t>>> loops;
+};
+
+/**
+ * `@brief` Build the crack-grid shared-edge topology of a labelled image.
+ *
+ * `@param` labels Per-pixel region ids in row-major order (`w * h` entries).
+ * `@param` w Image width in pixels.
+ * `@param` h Image height in pixels.
+ * `@param` eps Curve-fit tolerance applied to each canonical edge.
+ * `@return` Fitted arcs and per-region loops of signed arc references.
+ */
+SharedTopology build_shared_topology(const std::vector<int32_t>& labels, int w, int h, float eps);
+
+/**
+ * `@brief` Expand a loop of signed arc references into its quadratic curves.
+ *
+ * `@param` topo Topology the references point into.
+ * `@param` loop Signed arc references (see SharedTopology).
+ * `@return` The loop's curves in walking order.
+ */
+std::vector<QuadBezier> expand_loop(const SharedTopology& topo, const std::vector<int32_t>& loop);
+
 /**
  * `@brief` Build crack-grid shared boundary loops for each region.
  *
@@ -0,0 +1,44 @@
+#ifndef TILING_H
+#define TILING_H
+
+#include "img2num.h"
+#include "internal/workspace.h"
+
+#include <cstdint>
+
+/*
+Tiled image_to_svg pipeline for inputs too large for several full-resolution
+working copies (filtered image, CIELAB doubles, label rasters, per-pixel graph
+nodes). Pixels are pulled from a RowSource, so the input itself need not be
+resident either; working memory is bounded by config.tiling and the image width:
+
+1. A global palette is learned by k-means on a box-downscaled copy of the image
+   holding at most `palette_samples` pixels (first pass over the rows).
+2. Rows are read again one row of tiles (plus halos) at a time (second pass).
+   Each tile is bilateral-filtered together with a halo of one kernel radius, so
+   its core pixels see exactly the neighbourhood the whole-image filter would,
+   then every core pixel is assigned its nearest palette color.
+3. Each tile is vectorized on its own. Tile seams behave like the image frame:
+   contour points on them are pinned, so curves on both sides meet exactly.
+   Regions touching a seam are only pieces and are not merged as too small yet.
+4. Region pieces that continue across a seam with the same palette color are
+   stitched into one region (areas summed, colors area-weighted, adjacency
+   merged). Regions still smaller than min_cluster_area are then merged into a
+   neighbour (min_thickness only applies inside tiles), and the pieces of each
+   region are spliced into one outline along the seams they share.
+
+Only the vectorized result grows with the image; it carries no `labels` raster.
+*/
+
+namespace img2num {
+// True when config.tiling asks for tiles and the image is larger than one tile
+bool uses_tiling(const int width, const int height, const ImageToSvgConfig& config);
+
+// Run the tiled pipeline; scratch buffers come from `workspace`. The result's
+// `labels` is left empty.
+VectorizationResult tiled_vectorization(
+    RowSource& source, const ImageToSvgConfig& config, const bool use_gpu, Workspace& workspace
+);
+} // namespace img2num
+
+#endif // TILING_H
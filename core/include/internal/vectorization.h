@@ -0,0 +1,14 @@
+#ifndef VECTORIZATION_H
+#define VECTORIZATION_H
+
+#include "img2num.h"
+
+namespace img2num {
+// Check that the arrays of a (possibly caller-built) VectorizationResult are consistent
+// before a serializer indexes them: offset tables of the right length, starting at 0,
+// non-decreasing and ending at the size of the array they index, and adjacency entries
+// naming existing regions. Throws std::invalid_argument prefixed with `caller`.
+void validate_vectorization(const VectorizationResult& result, const char* caller);
+} // namespace img2num
+
+#endif // VECTORIZATION_H
@@ -0,0 +1,96 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include "img2num.h"
+#include "internal/Image.h"
+#include "internal/LABAPixel.h"
+#include "internal/RGBAPixel.h"
+
+#include <cstdint>
+#include <vector>
+
+using LabImage = ImageLib::Image<ImageLib::LABAPixel<float>>;
+
+/*
+Scratch memory for the CPU pipeline stages. Every buffer is resized (never
+shrunk) on use, so a workspace that has seen an image of a given size serves
+later images of that size or smaller without allocating. Kernels are cached by
+the parameters they were built from.
+*/
+
+struct BilateralScratch {
+    // Ring buffers of the 2 * radius + 1 source rows the kernel can see, so scratch grows
+    // with radius * width rather than with the image
+    std::vector<uint8_t> rows;     // RGBA, 4 bytes per pixel
+    std::vector<double> lab_rows;  // the same rows in CIELAB, 3 doubles per pixel
+    std::vector<uint8_t> out_row;  // filtered row handed to the row writer
+
+    int spatial_radius {-1};
+    double spatial_sigma {0.0};
+    std::vector<double> spatial_weights;
+
+    double range_sigma {0.0};
+    std::vector<double> range_lut; // RGB mode only
+};
+
+struct KMeansScratch {
+    ImageLib::Image<ImageLib::RGBAPixel<float>> pixels;
+    LabImage lab;
+    std::vector<double> min_dist_sq; // k-means++ seeding
+
+    // coarse pyramid level for coarse-to-fine k-means
+    ImageLib::Image<ImageLib::RGBAPixel<float>> coarse_pixels; // RGB mode
+    LabImage coarse_lab;                                       // CIELAB mode
+    std::vector<int32_t> coarse_labels;
+};
+
+namespace img2num {
+// Owned by img2num::Context; the free image_to_* functions use a temporary one
+struct Workspace {
+    std::vector<uint8_t> image;          // working copy of the input RGBA
+    std::vector<uint8_t> resampled;      // area-downscaled input RGBA (see resample.h)
+    std::vector<int32_t> labels;         // k-means cluster per pixel
+    std::vector<int32_t> region_labels;  // region id per pixel (see labels_to_vectorization)
+    LabImage lab;                        // fused CIELAB pipeline hand-off
+    BilateralScratch bilateral;
+    KMeansScratch kmeans;
+};
+
+// Whether the GPU stages can be used, initializing the device on first use. False while a
+// warmup() is still running, so the caller runs on the CPU instead of waiting for it.
+bool init_gpu_backend();
+
+// Stage 1 of image_to_svg: bilateral filter + k-means, leaving one cluster label per
+// pixel in workspace.labels. `image` is read in its own format (see pixel_format.h).
+// With `gpu_available`, config.execution picks the device of each stage (see execution.h).
+void cluster_labels(
+    const ImageView& image, const ImageToSvgConfig& config, const bool gpu_available,
+    Workspace& workspace
+);
+
+// Stage 2 of image_to_svg: regions, contours and SVG from workspace.labels (CPU only)
+std::string
+clustered_to_svg(const ImageView& image, const ImageToSvgConfig& config, Workspace& workspace);
+
+// Sides of a tile along which its regions continue into a neighbouring tile (see
+// tiling.h); regions touching them are left to the small-region merge after stitching
+constexpr uint8_t SEAM_LEFT {1};
+constexpr uint8_t SEAM_TOP {2};
+constexpr uint8_t SEAM_RIGHT {4};
+constexpr uint8_t SEAM_BOTTOM {8};
+
+// labels_to_vectorization / labels_to_arcs using workspace.region_labels as the region
+// raster, which stays in the workspace for the next call. labels_to_vectorization leaves
+// region indices in it and copies them to the result's `labels` only `with_labels`. Region
+// colors are read from `image` in its own format.
+VectorizationResult labels_to_vectorization(
+    const ImageView& image, const int32_t* labels, const int min_area, const int min_thickness,
+    Workspace& workspace, const bool with_labels, const uint8_t seam_sides = 0
+);
+std::string labels_to_arcs(
+    const ImageView& image, const int32_t* labels, const int min_area, const int min_thickness,
+    const double grid, Workspace& workspace
+);
+} // namespace img2num
+
+#endif // WORKSPACE_H
@@ -0,0 +1,407 @@
+#include "img2num.h"
+#include "internal/execution.h"
+#include "internal/gpu.h"
+#include "internal/pixel_format.h"
+#include "internal/resample.h"
+#include "internal/row_source.h"
+#include "internal/tiling.h"
+#include "internal/workspace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define IMG2NUM_BATCH_SEQUENTIAL
+#endif
+
+namespace {
+// Records the first failure; later ones are dropped
+class ErrorSlot {
+  public:
+    void capture() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_error)
+            m_error = std::current_exception();
+        m_failed.store(true, std::memory_order_relaxed);
+    }
+    bool failed() const {
+        return m_failed.load(std::memory_order_relaxed);
+    }
+    void rethrow() const {
+        if (m_error)
+            std::rethrow_exception(m_error);
+    }
+
+  private:
+    std::mutex m_mutex;
+    std::exception_ptr m_error;
+    std::atomic<bool> m_failed {false};
+};
+
+// Images whose cluster labels are ready for the CPU stage. Resampled and tiled images
+// skip the GPU lane and run their whole pipeline on a worker, on the CPU.
+struct Clustered {
+    size_t index;
+    std::vector<int32_t> labels;
+    bool whole {false};
+};
+
+// Bounded hand-off from the GPU lane to the CPU workers. The bound caps how many
+// label rasters are alive at once when the GPU outpaces contour fitting.
+template <typename Item> class BoundedQueue {
+  public:
+    explicit BoundedQueue(size_t capacity)
+        : m_capacity {capacity} {
+    }
+
+    // Returns false if the queue was closed while waiting for room. Without
+    // `wait_for_room` the item is queued even past the bound.
+    bool push(Item&& item, const bool wait_for_room = true) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_full.wait(lock, [this, wait_for_room] {
+            return m_closed || !wait_for_room || m_items.size() < m_capacity;
+        });
+        if (m_closed)
+            return false;
+        m_items.push_back(std::move(item));
+        m_not_empty.notify_one();
+        return true;
+    }
+
+    // Returns false once the queue is closed and drained
+    bool pop(Item& item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_empty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+        if (m_items.empty())
+            return false;
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        m_not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_not_empty.notify_all();
+        m_not_full.notify_all();
+    }
+
+  private:
+    const size_t m_capacity;
+    std::deque<Item> m_items;
+    bool m_closed {false};
+    std::mutex m_mutex;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_not_full;
+};
+using ClusteredQueue = BoundedQueue<Clustered>;
+
+// Images whose pipeline does not split into the two batch stages
+bool runs_whole(const img2num::BatchImage& image, const img2num::ImageToSvgConfig& config) {
+    return img2num::uses_resampling(image.width, image.height, config) ||
+           img2num::uses_tiling(image.width, image.height, config);
+}
+
+// Images the GPU lane clusters; the rest run their whole pipeline on a CPU worker
+bool on_gpu_lane(const img2num::BatchImage& image, const img2num::ImageToSvgConfig& config) {
+    const int64_t num_pixels {static_cast<int64_t>(image.width) * image.height};
+    return !runs_whole(image, config) && img2num::clusters_on_gpu(config, true, num_pixels);
+}
+
+// The whole image_to_svg pipeline of one image on the calling thread
+std::string whole_svg(
+    const img2num::BatchImage& image, const img2num::ImageToSvgConfig& config, const bool use_gpu,
+    img2num::Workspace& workspace
+) {
+    if (!runs_whole(image, config)) {
+        img2num::cluster_labels(image, config, use_gpu, workspace);
+        return img2num::clustered_to_svg(image, config, workspace);
+    }
+    img2num::MemoryRowSource source {image};
+    if (img2num::uses_resampling(image.width, image.height, config)) {
+        return img2num::vectorization_to_svg(
+            img2num::resampled_vectorization(source, config, use_gpu, workspace, false),
+            config.svg
+        );
+    }
+    return img2num::vectorization_to_svg(
+        img2num::tiled_vectorization(source, config, use_gpu, workspace), config.svg
+    );
+}
+
+// Hands an image_to_svg_async result to its callback, which must not throw
+void deliver(const img2num::SvgCallback& on_done, std::string svg, std::exception_ptr error) {
+    try {
+        on_done(std::move(svg), error);
+    } catch (...) {
+        // nothing is left to report the callback's own failure to
+    }
+}
+
+#ifndef IMG2NUM_BATCH_SEQUENTIAL
+// A pending image_to_svg_async call; `labels` is filled in by the GPU lane
+struct AsyncJob {
+    img2num::ImageView image;
+    img2num::ImageToSvgConfig config;
+    img2num::SvgCallback on_done;
+    std::vector<int32_t> labels;
+    bool clustered {false};
+};
+
+// Threads behind image_to_svg_async, started on first use: a GPU lane running filter +
+// k-means for each job in submission order, and CPU workers behind it as in
+// image_to_svg_batch. At exit the queues are closed and the pending jobs are finished.
+class AsyncRunner {
+  public:
+    static AsyncRunner& instance() {
+        static AsyncRunner runner;
+        return runner;
+    }
+
+    // Blocks while the lane is MAX_QUEUED_PER_WORKER jobs per worker behind, so a fast
+    // submitter is held back. Jobs submitted from on_done callbacks are queued at once:
+    // a worker waiting for room could stall the lane it is waiting on.
+    void submit(AsyncJob&& job) {
+        m_gpu_jobs.push(std::move(job), !t_on_runner_thread);
+    }
+
+    ~AsyncRunner() {
+        m_gpu_jobs.close();
+        m_gpu_lane.join(); // closes m_cpu_jobs once the GPU queue is drained
+        for (std::thread& worker : m_workers)
+            worker.join();
+    }
+
+  private:
+    static constexpr size_t MAX_QUEUED_PER_WORKER {2};
+    static thread_local bool t_on_runner_thread;
+
+    AsyncRunner()
+        : m_gpu_jobs {MAX_QUEUED_PER_WORKER * worker_count()}
+        , m_cpu_jobs {worker_count()} {
+        // constructed first so the device outlives the lanes at exit
+        GPU::getClassInstance();
+        m_gpu_lane = std::thread([this] { run_gpu_lane(); });
+        for (size_t t = 0; t < worker_count(); ++t)
+            m_workers.emplace_back([this] { run_worker(); });
+    }
+
+    static size_t worker_count() {
+        return std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    void run_gpu_lane() {
+        t_on_runner_thread = true;
+        img2num::Workspace workspace;
+        AsyncJob job;
+        while (m_gpu_jobs.pop(job)) {
+            // per job, so jobs queued during a warmup() pick the GPU up once it is ready
+            if (on_gpu_lane(job.image, job.config) && img2num::init_gpu_backend()) {
+                try {
+                    img2num::cluster_labels(job.image, job.config, true, workspace);
+                    job.labels = std::move(workspace.labels);
+                    job.clustered = true;
+                } catch (...) {
+                    deliver(job.on_done, {}, std::current_exception());
+                    continue;
+                }
+            }
+            m_cpu_jobs.push(std::move(job));
+        }
+        m_cpu_jobs.close();
+    }
+
+    void run_worker() {
+        t_on_runner_thread = true;
+        img2num::Workspace workspace;
+        AsyncJob job;
+        while (m_cpu_jobs.pop(job)) {
+            std::string svg;
+            std::exception_ptr error;
+            try {
+                if (job.clustered) {
+                    workspace.labels.swap(job.labels);
+                    svg = img2num::clustered_to_svg(job.image, job.config, workspace);
+                } else {
+                    svg = whole_svg(job.image, job.config, false, workspace);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+            deliver(job.on_done, std::move(svg), error);
+        }
+    }
+
+    BoundedQueue<AsyncJob> m_gpu_jobs;
+    BoundedQueue<AsyncJob> m_cpu_jobs;
+    std::thread m_gpu_lane;
+    std::vector<std::thread> m_workers;
+};
+thread_local bool AsyncRunner::t_on_runner_thread {false};
+#endif
+
+const img2num::ImageToSvgConfig& config_for(
+    const std::vector<img2num::ImageToSvgConfig>& configs, size_t index
+) {
+    return configs.size() == 1 ? configs[0] : configs[index];
+}
+} // namespace
+
+namespace img2num {
+std::vector<std::string> image_to_svg_batch(
+    const std::vector<BatchImage>& images, const std::vector<ImageToSvgConfig>& configs,
+    int num_threads
+) {
+    if (configs.size() != 1 && configs.size() != images.size())
+        throw std::invalid_argument("configs must hold one config or one per image");
+    if (num_threads < 0)
+        throw std::invalid_argument("num_threads must be >= 0");
+    for (const BatchImage& image : images)
+        validate_image_view(image, "image_to_svg_batch");
+
+    std::vector<std::string> svgs(images.size());
+    if (images.empty())
+        return svgs;
+
+    // decide once, here, for the whole batch
+    const bool use_gpu {
+        std::any_of(configs.begin(), configs.end(), may_use_gpu) && init_gpu_backend()};
+
+#ifdef IMG2NUM_BATCH_SEQUENTIAL
+    (void)num_threads;
+    Workspace workspace;
+    for (size_t i = 0; i < images.size(); ++i) {
+        svgs[i] = whole_svg(images[i], config_for(configs, i), use_gpu, workspace);
+    }
+    return svgs;
+#else
+    size_t threads {num_threads > 0 ? static_cast<size_t>(num_threads)
+                                    : static_cast<size_t>(std::thread::hardware_concurrency())};
+    threads = std::max<size_t>(1, std::min(threads, images.size()));
+
+    ErrorSlot error;
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    if (!use_gpu) {
+        // Every stage is CPU-bound: one whole image per worker at a time
+        std::atomic<size_t> next {0};
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                Workspace workspace;
+                for (size_t i = next++; i < images.size() && !error.failed(); i = next++) {
+                    try {
+                        svgs[i] = whole_svg(images[i], config_for(configs, i), false, workspace);
+                    } catch (...) {
+                        error.capture();
+                    }
+                }
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+        error.rethrow();
+        return svgs;
+    }
+
+    // GPU lane on this thread (filter + k-means, in order), CPU workers behind it
+    ClusteredQueue queue {threads};
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            Workspace workspace;
+            Clustered item;
+            while (queue.pop(item)) {
+                if (error.failed())
+                    continue; // drain so the GPU lane never blocks
+                try {
+                    const BatchImage& image {images[item.index]};
+                    if (item.whole) {
+                        svgs[item.index] = whole_svg(
+                            image, config_for(configs, item.index), false, workspace
+                        );
+                        continue;
+                    }
+                    workspace.labels.swap(item.labels);
+                    svgs[item.index] =
+                        clustered_to_svg(image, config_for(configs, item.index), workspace);
+                } catch (...) {
+                    error.capture();
+                }
+            }
+        });
+    }
+
+    Workspace gpu_workspace;
+    for (size_t i = 0; i < images.size() && !error.failed(); ++i) {
+        try {
+            const BatchImage& image {images[i]};
+            const ImageToSvgConfig& config {config_for(configs, i)};
+            if (!on_gpu_lane(image, config)) {
+                if (!queue.push(Clustered {i, {}, true}))
+                    break;
+                continue;
+            }
+            cluster_labels(image, config, true, gpu_workspace);
+            if (!queue.push(Clustered {i, std::move(gpu_workspace.labels)}))
+                break;
+        } catch (...) {
+            error.capture();
+        }
+    }
+    queue.close();
+    for (std::thread& worker : workers)
+        worker.join();
+    error.rethrow();
+    return svgs;
+#endif
+}
+
+void image_to_svg_async(
+    const ImageView& image, const ImageToSvgConfig& config, SvgCallback on_done
+) {
+    if (!on_done)
+        throw std::invalid_argument("image_to_svg_async: on_done is empty");
+    validate_image_view(image, "image_to_svg_async");
+
+#ifdef IMG2NUM_BATCH_SEQUENTIAL
+    // no threads to hand the job to: run it now, before returning
+    std::string svg;
+    std::exception_ptr error;
+    try {
+        svg = image_to_svg(image, config);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    deliver(on_done, std::move(svg), error);
+#else
+    AsyncRunner::instance().submit(AsyncJob {image, config, std::move(on_done), {}, false});
+#endif
+}
+
+std::future<std::string>
+image_to_svg_async(const ImageView& image, const ImageToSvgConfig& config) {
+    auto promise {std::make_shared<std::promise<std::string>>()};
+    std::future<std::string> result {promise->get_future()};
+    image_to_svg_async(image, config, [promise](std::string svg, std::exception_ptr error) {
+        if (error)
+            promise->set_exception(error);
+        else
+            promise->set_value(std::move(svg));
+    });
+    return result;
+}
+} // namespace img2num
@@ -1,7 +1,10 @@
 #include "img2num.h"
 #include "internal/bilateral_filter_gpu.h"
 #include "internal/cielab.h"
+#include "internal/cielab_pipeline.h"
+#include "internal/execution.h"
 #include "internal/gpu.h"
+#include "internal/row_source.h"
 
 #include <algorithm>
 #include <climits>
@@ -10,8 +13,6 @@
 #include <functional>
 #include <vector>
 
-static constexpr double SIGMA_RADIUS_FACTOR {3.0}; // 3 standard deviations
-static constexpr int MAX_KERNEL_RADIUS {50};
 // Max possible squared Euclidean distance in a 3-channel 8-bit image: 255^2 * 3
 // = 195075 Means max delta between images (imageA - imageB) in RGB channels
 // (255^2 * 3)
@@ -23,6 +24,8 @@ inline double gaussian(double x, double sigma) {
     return std::exp(-(x * x) / (2.0 * sigma * sigma));
 }
 
+using RowWriter = std::function<void(int y, const uint8_t* row)>;
+
 /*
 The Bilateral Filter applies a composite weight based on both spatial distance
 and radiometric difference (intensity) to return an image that is smoothed while
@@ -41,30 +44,72 @@ decay)
   └── 1: RGB
 */
 
-void _process(
-    const uint8_t* image, const std::vector<double>& cie_image, std::vector<uint8_t>& result,
+// Rows are pulled from `source` through ring buffers of 2 * radius + 1 rows (and, in
+// CIELAB mode, their LAB conversion), and each filtered row is handed to `write_row` once
+// every row within `radius` of it has been read, so writing it back into the source's
+// own buffer is safe. When lab_result is given (CIELAB only), the filtered L, A, B are
+// written there as floats instead and `write_row` is not called.
+static void _process(
+    img2num::RowSource& source, const RowWriter& write_row,
     const std::vector<double>& spatial_weights, const std::vector<double>& range_lut, int radius,
-    double sigma_range, int start_row, int end_row, size_t height, size_t width, uint8_t color_space
+    double sigma_range, uint8_t color_space, BilateralScratch& scratch,
+    LabImage* lab_result = nullptr
 ) {
-    int h {static_cast<int>(height)};
-    int w {static_cast<int>(width)};
+    const int h {source.height()};
+    const int w {source.width()};
+    const size_t width {static_cast<size_t>(w)};
     const int kernel_diameter {2 * radius + 1};
+    const int ring_rows {std::min(kernel_diameter, h)};
+    const bool cielab {color_space == COLOR_SPACE_OPTION_CIELAB};
+
+    std::vector<uint8_t>& rows {scratch.rows};
+    std::vector<double>& lab_rows {scratch.lab_rows};
+    std::vector<uint8_t>& out_row {scratch.out_row};
+    rows.resize(static_cast<size_t>(ring_rows) * width * 4);
+    out_row.resize(width * 4);
+    if (cielab)
+        lab_rows.resize(static_cast<size_t>(ring_rows) * width * 3);
+
+    // Copy source row y into its ring slot, converting it to CIELAB if needed
+    auto load_row = [&](int y) {
+        const size_t slot {static_cast<size_t>(y % ring_rows)};
+        uint8_t* row {rows.data() + slot * width * 4};
+        source.read_rows(y, 1, row);
+        if (!cielab)
+            return;
+        double* lab_row {lab_rows.data() + slot * width * 3};
+        for (size_t x {0}; x < width; ++x) {
+            rgb_to_lab<uint8_t, double>(
+                row[x * 4], row[x * 4 + 1], row[x * 4 + 2], lab_row[x * 3], lab_row[x * 3 + 1],
+                lab_row[x * 3 + 2]
+            );
+        }
+    };
+
+    for (int y {0}; y < std::min(radius, h); ++y)
+        load_row(y);
 
-    for (int y {start_row}; y < end_row; ++y) {
+    for (int y {0}; y < h; ++y) {
+        // The slot refilled here held row y - radius - 1, which no output row needs anymore
+        if (y + radius < h)
+            load_row(y + radius);
+
+        const size_t center_slot {static_cast<size_t>(y % ring_rows)};
         for (int x {0}; x < w; ++x) {
-            size_t center_idx {(y * width + x) * 4};
+            const uint8_t* center {rows.data() + (center_slot * width + x) * 4};
 
-            uint8_t r0 {image[center_idx]};
-            uint8_t g0 {image[center_idx + 1]};
-            uint8_t b0 {image[center_idx + 2]};
-            uint8_t a0 {image[center_idx + 3]};
+            uint8_t r0 {center[0]};
+            uint8_t g0 {center[1]};
+            uint8_t b0 {center[2]};
+            uint8_t a0 {center[3]};
 
             // ========= CIELAB-only section start =========
             double L0, A0, B0;
-            if (color_space == COLOR_SPACE_OPTION_CIELAB) {
-                L0 = cie_image[center_idx];
-                A0 = cie_image[center_idx + 1];
-                B0 = cie_image[center_idx + 2];
+            if (cielab) {
+                const double* lab_center {lab_rows.data() + (center_slot * width + x) * 3};
+                L0 = lab_center[0];
+                A0 = lab_center[1];
+                B0 = lab_center[2];
             }
             // ========= CIELAB-only section end =========
 
@@ -78,20 +123,16 @@ void _process(
             double dL, dA, dB, dist;
 
             for (int ky {-radius}; ky <= radius; ++ky) {
-                int ny {std::clamp(y + ky, 0, h - 1)};
+                const size_t slot {static_cast<size_t>(std::clamp(y + ky, 0, h - 1) % ring_rows)};
+                const uint8_t* row {rows.data() + slot * width * 4};
+                const double* lab_row {cielab ? lab_rows.data() + slot * width * 3 : nullptr};
 
                 for (int kx {-radius}; kx <= radius; ++kx) {
                     int nx {std::clamp(x + kx, 0, w - 1)};
 
-                    size_t neighbor_idx {(ny * width + nx) * 4};
-
-                    uint8_t r {image[neighbor_idx]};
-                    uint8_t g {image[neighbor_idx + 1]};
-                    uint8_t b {image[neighbor_idx + 2]};
-
-                    double L {cie_image[neighbor_idx]};
-                    double A {cie_image[neighbor_idx + 1]};
-                    double B {cie_image[neighbor_idx + 2]};
+                    uint8_t r {row[nx * 4]};
+                    uint8_t g {row[nx * 4 + 1]};
+                    uint8_t b {row[nx * 4 + 2]};
 
                     w_space = spatial_weights[(ky + radius) * kernel_diameter + (kx + radius)];
 
@@ -109,6 +150,11 @@ void _process(
                         break;
                     }
                     case COLOR_SPACE_OPTION_CIELAB: {
+                        // lab_rows is only populated in CIELAB mode
+                        const double L {lab_row[nx * 3]};
+                        const double A {lab_row[nx * 3 + 1]};
+                        const double B {lab_row[nx * 3 + 2]};
+
                         dL = L - L0;
                         dA = A - A0;
                         dB = B - B0;
@@ -127,53 +173,53 @@ void _process(
                 }
             }
 
+            const size_t out_idx {static_cast<size_t>(x) * 4};
             switch (color_space) {
             case COLOR_SPACE_OPTION_RGB: {
-                result[center_idx] =
+                out_row[out_idx] =
                     static_cast<uint8_t>(std::clamp(weight_acc_channel_0 / weight_acc, 0.0, 255.0));
-                result[center_idx + 1] =
+                out_row[out_idx + 1] =
                     static_cast<uint8_t>(std::clamp(weight_acc_channel_1 / weight_acc, 0.0, 255.0));
-                result[center_idx + 2] =
+                out_row[out_idx + 2] =
                     static_cast<uint8_t>(std::clamp(weight_acc_channel_2 / weight_acc, 0.0, 255.0));
-                result[center_idx + 3] = a0;
+                out_row[out_idx + 3] = a0;
                 break;
             }
             case COLOR_SPACE_OPTION_CIELAB: {
                 double L {weight_acc_channel_0 / weight_acc};
                 double A {weight_acc_channel_1 / weight_acc};
                 double B {weight_acc_channel_2 / weight_acc};
+                if (lab_result) {
+                    (*lab_result)[static_cast<int>(y * width + x)] = {
+                        static_cast<float>(L), static_cast<float>(A), static_cast<float>(B),
+                        static_cast<float>(a0)};
+                    break;
+                }
                 uint8_t r, g, b;
                 lab_to_rgb<double, uint8_t>(L, A, B, r, g, b);
-                result[center_idx] = r;
-                result[center_idx + 1] = g;
-                result[center_idx + 2] = b;
-                result[center_idx + 3] = a0;
+                out_row[out_idx] = r;
+                out_row[out_idx + 1] = g;
+                out_row[out_idx + 2] = b;
+                out_row[out_idx + 3] = a0;
                 break;
             }
             }
         }
+        if (!lab_result)
+            write_row(y, out_row.data());
     }
 }
 
-void bilateral_filter_cpu(
-    uint8_t* image, size_t width, size_t height, double sigma_spatial, double sigma_range,
-    uint8_t color_space
-) {
-    // bad data -> return
-    if (sigma_spatial <= 0.0 || sigma_range <= 0.0 || width <= 0 || height <= 0)
-        return;
-    if (color_space != COLOR_SPACE_OPTION_CIELAB && color_space != COLOR_SPACE_OPTION_RGB)
-        return;
+// Gaussian spatial kernel of size (2 * radius + 1)^2, rebuilt only when the parameters change
+static const std::vector<double>&
+spatial_kernel(int radius, double sigma_spatial, BilateralScratch& scratch) {
+    if (scratch.spatial_radius == radius && scratch.spatial_sigma == sigma_spatial)
+        return scratch.spatial_weights;
 
-    const int raw_radius {static_cast<int>(std::ceil(SIGMA_RADIUS_FACTOR * sigma_spatial))};
-    const int radius {std::min(raw_radius, MAX_KERNEL_RADIUS)};
     const int kernel_diameter {2 * radius + 1};
+    std::vector<double>& spatial_weights {scratch.spatial_weights};
+    spatial_weights.resize(kernel_diameter * kernel_diameter);
 
-    std::vector<uint8_t> result(width * height * 4);
-
-    std::vector<double> spatial_weights(kernel_diameter * kernel_diameter);
-
-    // Precompute Spatial Weights (Gaussian Kernel)
     for (int ky {-radius}; ky <= radius; ++ky) {
         for (int kx {-radius}; kx <= radius; ++kx) {
             const double dist {static_cast<double>(std::sqrt(kx * kx + ky * ky))};
@@ -181,49 +227,123 @@ void bilateral_filter_cpu(
                 gaussian(dist, sigma_spatial);
         }
     }
+    scratch.spatial_radius = radius;
+    scratch.spatial_sigma = sigma_spatial;
+    return spatial_weights;
+}
 
-    // ========= RGB-only section start =========
-    // Precompute Range Weights
-    std::vector<double> range_lut;
-    if (color_space == COLOR_SPACE_OPTION_RGB) {
-        range_lut.resize(MAX_RGB_DIST_SQ + 1);
-        for (int i {0}; i <= MAX_RGB_DIST_SQ; ++i) {
-            range_lut[i] = gaussian(static_cast<double>(std::sqrt(i)), sigma_range);
+// Range weights indexed by squared RGB distance, rebuilt only when sigma_range changes
+static const std::vector<double>& range_lut(double sigma_range, BilateralScratch& scratch) {
+    if (!scratch.range_lut.empty() && scratch.range_sigma == sigma_range)
+        return scratch.range_lut;
+
+    scratch.range_lut.resize(MAX_RGB_DIST_SQ + 1);
+    for (int i {0}; i <= MAX_RGB_DIST_SQ; ++i) {
+        scratch.range_lut[i] = gaussian(static_cast<double>(std::sqrt(i)), sigma_range);
+    }
+    scratch.range_sigma = sigma_range;
+    return scratch.range_lut;
+}
+
+void bilateral_filter_cpu(
+    img2num::RowSource& source, double sigma_spatial, double sigma_range, uint8_t color_space,
+    const RowWriter& write_row, BilateralScratch& scratch
+) {
+    // bad data -> rows pass through unchanged
+    if (sigma_spatial <= 0.0 || sigma_range <= 0.0 ||
+        (color_space != COLOR_SPACE_OPTION_CIELAB && color_space != COLOR_SPACE_OPTION_RGB)) {
+        scratch.out_row.resize(static_cast<size_t>(source.width()) * 4);
+        for (int y {0}; y < source.height(); ++y) {
+            source.read_rows(y, 1, scratch.out_row.data());
+            write_row(y, scratch.out_row.data());
         }
+        return;
     }
+
+    const int radius {bilateral_kernel_radius(sigma_spatial)};
+
+    // Precompute Spatial Weights (Gaussian Kernel)
+    const std::vector<double>& spatial_weights {spatial_kernel(radius, sigma_spatial, scratch)};
+
+    // ========= RGB-only section start =========
+    // Precompute Range Weights
+    static const std::vector<double> no_range_lut;
+    const std::vector<double>& range_weights {
+        color_space == COLOR_SPACE_OPTION_RGB ? range_lut(sigma_range, scratch) : no_range_lut};
     // ========= RGB-only section end =========
 
-    // ========= CIELAB section start =========
-    // Compute full image RGB - CIELAB conversion
-    std::vector<double> cie_image;
-    if (color_space == COLOR_SPACE_OPTION_CIELAB) {
-        cie_image.resize(width * height * 4);
-
-        for (int y {0}; y < height; y++) {
-            for (int x {0}; x < width; x++) {
-                int center_idx {(y * static_cast<int>(width) + x) * 4};
-                uint8_t r0 {image[center_idx]};
-                uint8_t g0 {image[center_idx + 1]};
-                uint8_t b0 {image[center_idx + 2]};
-                uint8_t a0 {image[center_idx + 3]};
-                double L0, A0, B0;
-                rgb_to_lab<uint8_t, double>(r0, g0, b0, L0, A0, B0);
-
-                cie_image[center_idx] = L0;
-                cie_image[center_idx + 1] = A0;
-                cie_image[center_idx + 2] = B0;
-                cie_image[center_idx + 3] = 0.0; // unused but keep for indexing purposes
+    // The CIELAB conversion happens row by row inside _process
+    _process(
+        source, write_row, spatial_weights, range_weights, radius, sigma_range, color_space,
+        scratch
+    );
+}
+
+void bilateral_filter_cpu(
+    uint8_t* image, size_t width, size_t height, double sigma_spatial, double sigma_range,
+    uint8_t color_space, BilateralScratch& scratch
+) {
+    // bad data -> return
+    if (sigma_spatial <= 0.0 || sigma_range <= 0.0 || width <= 0 || height <= 0)
+        return;
+    if (color_space != COLOR_SPACE_OPTION_CIELAB && color_space != COLOR_SPACE_OPTION_RGB)
+        return;
+
+    // Filtered in place: _process only hands back row y once it no longer needs it
+    img2num::MemoryRowSource source {image, static_cast<int>(width), static_cast<int>(height)};
+    bilateral_filter_cpu(
+        source, sigma_spatial, sigma_range, color_space,
+        [&](int y, const uint8_t* row) {
+            std::memcpy(image + static_cast<size_t>(y) * width * 4, row, width * 4);
+        },
+        scratch
+    );
+}
+
+void bilateral_filter_cpu(
+    uint8_t* image, size_t width, size_t height, double sigma_spatial, double sigma_range,
+    uint8_t color_space
+) {
+    BilateralScratch scratch;
+    bilateral_filter_cpu(image, width, height, sigma_spatial, sigma_range, color_space, scratch);
+}
+
+void bilateral_filter_lab_cpu(
+    img2num::RowSource& source, double sigma_spatial, double sigma_range, LabImage& out_lab,
+    BilateralScratch& scratch
+) {
+    const int width {source.width()};
+    const int height {source.height()};
+    out_lab.resize(width, height);
+    if (width <= 0 || height <= 0)
+        return;
+
+    // bad data -> plain conversion, matching bilateral_filter_cpu leaving the image untouched
+    if (sigma_spatial <= 0.0 || sigma_range <= 0.0) {
+        std::vector<uint8_t>& row {scratch.out_row};
+        row.resize(static_cast<size_t>(width) * 4);
+        for (int y {0}; y < height; ++y) {
+            source.read_rows(y, 1, row.data());
+            for (int x {0}; x < width; ++x) {
+                const uint8_t* p {&row[static_cast<size_t>(x) * 4]};
+                double L, A, B;
+                rgb_to_lab<uint8_t, double>(p[0], p[1], p[2], L, A, B);
+                out_lab[y * width + x] = {
+                    static_cast<float>(L), static_cast<float>(A), static_cast<float>(B),
+                    static_cast<float>(p[3])};
             }
         }
+        return;
     }
-    // ========= CIELAB section end =========
+
+    const int radius {bilateral_kernel_radius(sigma_spatial)};
+    const std::vector<double>& spatial_weights {spatial_kernel(radius, sigma_spatial, scratch)};
+    const std::vector<double> no_range_lut;
 
     _process(
-        image, cie_image, result, spatial_weights, range_lut, radius, sigma_range, 0,
-        static_cast<int>(height), height, width, color_space
+        source, RowWriter {}, spatial_weights, no_range_lut, radius, sigma_range,
+        COLOR_SPACE_OPTION_CIELAB, scratch, &out_lab
     );
-
-    std::memcpy(image, result.data(), result.size());
 }
 
 namespace img2num {
@@ -231,12 +351,23 @@ void bilateral_filter(
     uint8_t* image, size_t width, size_t height, double sigma_spatial, double sigma_range,
     uint8_t color_space
 ) {
-    GPU::getClassInstance().init_gpu();
-
-    if (GPU::getClassInstance().is_initialized()) {
+    // the default auto policy of ImageToSvgConfig::execution
+    const ImageToSvgConfig::ExecutionConfig execution {};
+    const int64_t num_pixels {static_cast<int64_t>(width * height)};
+    if (bilateral_filter_on_gpu(execution, true, num_pixels) &&
+        GPU::getClassInstance().ensure_initialized()) {
         bilateral_filter_gpu(image, width, height, sigma_spatial, sigma_range, color_space);
     } else {
         bilateral_filter_cpu(image, width, height, sigma_spatial, sigma_range, color_space);
     }
 }
+
+void bilateral_filter(
+    RowSource& source, double sigma_spatial, double sigma_range, uint8_t color_space,
+    const std::function<void(int y, const uint8_t* row)>& write_row
+) {
+    // Streaming runs on the CPU: the GPU kernel needs the whole image resident
+    BilateralScratch scratch;
+    bilateral_filter_cpu(source, sigma_spatial, sigma_range, color_space, write_row, scratch);
+}
 } // namespace img2num
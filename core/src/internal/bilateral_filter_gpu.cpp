@@ -3,6 +3,7 @@
 #include "img2num.h"
 #include "internal/cielab.h"
 #include "internal/gpu.h"
+#include "internal/gpu_pipeline.h"
 
 #include <algorithm>
 #include <climits>
@@ -11,6 +12,8 @@
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <string>
+#include <utility>
 #include <vector>
 
 static constexpr uint8_t COLOR_SPACE_OPTION_CIELAB {0};
@@ -23,10 +26,25 @@ static constexpr uint8_t COLOR_SPACE_OPTION_RGB {1};
 struct FilterParams {
     float sigmaSpatial;
     float sigmaRange;
+    int32_t radius; // bilateral_kernel_radius(sigmaSpatial)
     // std140 requires 16-byte alignment for structs/vec4s.
-    // Two floats = 8 bytes. We likely need padding if this struct grows,
-    // but for a standalone bind group of 2 floats, standard alignment usually suffices.
-    // However, it is safer to pad to 16 bytes to be sure.
+    float _pad;
+}
+#ifndef _MSC_VER
+__attribute__((packed))
+#endif
+;
+#ifdef _MSC_VER
+#pragma pack(pop)
+#endif
+
+// Matches the Params uniform of kmeans_input.wgsl
+#ifdef _MSC_VER
+#pragma pack(push, 1)
+#endif
+struct ScaleParams {
+    float scale;
+    float _pad0;
     float _pad1;
     float _pad2;
 }
@@ -38,6 +56,47 @@ __attribute__((packed))
 #pragma pack(pop)
 #endif
 
+// Largest radii the *_tiled filter shaders stage in workgroup memory (MAX_TILED_RADIUS
+// in the WGSL); larger kernels use the untiled shaders
+static constexpr int MAX_TILED_RADIUS_RGB {23};
+static constexpr int MAX_TILED_RADIUS_LAB {14};
+
+static std::string filter_shader_id(const bool lab, const int radius) {
+    if (lab)
+        return radius <= MAX_TILED_RADIUS_LAB ? "bilateral_filter_lab_tiled"
+                                              : "bilateral_filter_lab";
+    return radius <= MAX_TILED_RADIUS_RGB ? "bilateral_filter_rgb_tiled" : "bilateral_filter_rgb";
+}
+
+// The 2 * radius + 1 entry 1D spatial Gaussian the filter shaders read as spatialWeights
+static std::vector<float> spatial_weight_table(const int radius, const double sigma_spatial) {
+    std::vector<float> table(2 * radius + 1);
+    for (int r {-radius}; r <= radius; ++r) {
+        table[r + radius] =
+            static_cast<float>(std::exp(-(r * r) / (2.0 * sigma_spatial * sigma_spatial)));
+    }
+    return table;
+}
+
+// Records one pass of an embedded 16x16-workgroup shader over a width x height image
+static void dispatch_image_pass(
+    const wgpu::CommandEncoder& encoder, const std::string& shader_id,
+    const wgpu::BindGroupEntry* entries, const size_t entry_count, const size_t width,
+    const size_t height
+) {
+    wgpu::BindGroupDescriptor desc = {};
+    desc.layout = GPU::getClassInstance().getBindGroupLayout(shader_id);
+    desc.entryCount = entry_count;
+    desc.entries = entries;
+    wgpu::BindGroup bindGroup = GPU::getClassInstance().get_device().CreateBindGroup(&desc);
+
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    pass.SetPipeline(GPU::getClassInstance().getPipeline(shader_id));
+    pass.SetBindGroup(0, bindGroup);
+    pass.DispatchWorkgroups((width + 15) / 16, (height + 15) / 16);
+    pass.End();
+}
+
 void bilateral_filter_gpu(
     uint8_t* image, size_t width, size_t height, double sigma_spatial, double sigma_range,
     uint8_t color_space
@@ -46,6 +105,8 @@ void bilateral_filter_gpu(
         return;
     if (color_space != COLOR_SPACE_OPTION_CIELAB && color_space != COLOR_SPACE_OPTION_RGB)
         return;
+    // one stage on the device at a time (see GPU::lock_device)
+    auto device_lock {GPU::getClassInstance().lock_device()};
 
     std::vector<uint8_t> result(width * height * 4);
     // copy image data to result incase filter fails
@@ -59,7 +120,7 @@ void bilateral_filter_gpu(
     int bytesPerPixel {4};
     texDesc.format = wgpu::TextureFormat::RGBA8Unorm;
     texDesc.usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::CopyDst;
-    wgpu::Texture inputTexture = GPU::getClassInstance().get_device().CreateTexture(&texDesc);
+    wgpu::Texture inputTexture = GPU::getClassInstance().acquireTexture(texDesc);
 
     std::cout << "upload texture" << std::endl;
     // Upload data to Input Texture
@@ -78,53 +139,57 @@ void bilateral_filter_gpu(
     // 2. Create Output Texture (Storage)
     wgpu::TextureDescriptor outDesc = texDesc;
     outDesc.usage = wgpu::TextureUsage::StorageBinding | wgpu::TextureUsage::CopySrc;
-    wgpu::Texture outputTexture = GPU::getClassInstance().get_device().CreateTexture(&outDesc);
+    wgpu::Texture outputTexture = GPU::getClassInstance().acquireTexture(outDesc);
 
     // 2a. Intermediate textures for LAB if needed
     wgpu::TextureDescriptor descLab = texDesc;
     descLab.format = wgpu::TextureFormat::RGBA32Float; // <--- CRITICAL
     descLab.usage = wgpu::TextureUsage::StorageBinding | wgpu::TextureUsage::TextureBinding;
-    // input lab
-    wgpu::Texture texLabRaw = GPU::getClassInstance().get_device().CreateTexture(&descLab);
-    // filtered lab
-    wgpu::Texture texLabFiltered = GPU::getClassInstance().get_device().CreateTexture(&descLab);
+    wgpu::Texture texLabRaw;
+    wgpu::Texture texLabFiltered;
+    if (color_space == COLOR_SPACE_OPTION_CIELAB) {
+        // input lab
+        texLabRaw = GPU::getClassInstance().acquireTexture(descLab);
+        // filtered lab
+        texLabFiltered = GPU::getClassInstance().acquireTexture(descLab);
+    }
 
     std::cout << "create buffer" << std::endl;
     // 3. Create Uniform Buffer
     float sr = static_cast<float>(sigma_range);
-    FilterParams params = {static_cast<float>(sigma_spatial), sr, 0.0f, 0.0f};
-    wgpu::BufferDescriptor bufDesc = {};
-    bufDesc.size = sizeof(FilterParams);
-    bufDesc.usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst;
-    wgpu::Buffer paramBuffer = GPU::getClassInstance().get_device().CreateBuffer(&bufDesc);
+    const int radius {bilateral_kernel_radius(sigma_spatial)};
+    FilterParams params = {static_cast<float>(sigma_spatial), sr, radius, 0.0f};
+    const wgpu::BufferUsage paramUsage {wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst};
+    wgpu::Buffer paramBuffer =
+        GPU::getClassInstance().acquireBuffer(sizeof(FilterParams), paramUsage);
     GPU::getClassInstance().get_queue().WriteBuffer(paramBuffer, 0, &params, sizeof(FilterParams));
 
-    wgpu::ComputePipeline pipeline;
+    // 3a. Spatial weight table
+    const std::vector<float> weights {spatial_weight_table(radius, sigma_spatial)};
+    const uint64_t weightBytes {weights.size() * sizeof(float)};
+    const wgpu::BufferUsage weightUsage {wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst};
+    wgpu::Buffer weightBuffer = GPU::getClassInstance().acquireBuffer(weightBytes, weightUsage);
+    GPU::getClassInstance().get_queue().WriteBuffer(weightBuffer, 0, weights.data(), weightBytes);
+
+    // pipelines are compiled once and cached by the GPU singleton
+    const std::string filter_shader {
+        filter_shader_id(color_space == COLOR_SPACE_OPTION_CIELAB, radius)};
+    wgpu::ComputePipeline pipeline {GPU::getClassInstance().getPipeline(filter_shader)};
     wgpu::ComputePipeline pipelineRGB2LAB;
     wgpu::ComputePipeline pipelineLAB2RGB;
 
-    switch (color_space) {
-    case COLOR_SPACE_OPTION_RGB: {
-        pipeline =
-            GPU::getClassInstance().createPipeline("bilateral_filter_rgb", "BilateralFilterShader");
-        break;
-    }
-    case COLOR_SPACE_OPTION_CIELAB: {
+    if (color_space == COLOR_SPACE_OPTION_CIELAB) {
         // also requires RGB-CIELAB conversion shaders
-        pipeline =
-            GPU::getClassInstance().createPipeline("bilateral_filter_lab", "BilateralFilterShader");
-        pipelineRGB2LAB = GPU::getClassInstance().createPipeline("rgb2cielab", "rgb2lab");
-        pipelineLAB2RGB = GPU::getClassInstance().createPipeline("cielab2rgb", "lab2rgb");
-        break;
-    }
+        pipelineRGB2LAB = GPU::getClassInstance().getPipeline("rgb2cielab");
+        pipelineLAB2RGB = GPU::getClassInstance().getPipeline("cielab2rgb");
     }
 
     // 6. Create Bind Group
 
     // filter bind group
     wgpu::BindGroupDescriptor bindGroupDesc = {};
-    bindGroupDesc.layout = pipeline.GetBindGroupLayout(0);
-    wgpu::BindGroupEntry entries[3];
+    bindGroupDesc.layout = GPU::getClassInstance().getBindGroupLayout(filter_shader);
+    wgpu::BindGroupEntry entries[4];
     // Entry 0: Input Texture View
     entries[0].binding = 0;
     entries[1].binding = 1;
@@ -147,7 +212,11 @@ void bilateral_filter_gpu(
     entries[2].binding = 2;
     entries[2].buffer = paramBuffer;
     entries[2].size = sizeof(FilterParams);
-    bindGroupDesc.entryCount = 3;
+    // Entry 3: Spatial weights
+    entries[3].binding = 3;
+    entries[3].buffer = weightBuffer;
+    entries[3].size = weightBytes;
+    bindGroupDesc.entryCount = 4;
     bindGroupDesc.entries = entries;
     wgpu::BindGroup bindGroup =
         GPU::getClassInstance().get_device().CreateBindGroup(&bindGroupDesc);
@@ -163,7 +232,7 @@ void bilateral_filter_gpu(
         bg1Entries[1].binding = 1;
         bg1Entries[1].textureView = texLabRaw.CreateView();
         wgpu::BindGroupDescriptor bg1Desc = {};
-        bg1Desc.layout = pipelineRGB2LAB.GetBindGroupLayout(0);
+        bg1Desc.layout = GPU::getClassInstance().getBindGroupLayout("rgb2cielab");
         bg1Desc.entryCount = 2;
         bg1Desc.entries = bg1Entries;
         bindGroupRGB2LAB = GPU::getClassInstance().get_device().CreateBindGroup(&bg1Desc);
@@ -174,7 +243,7 @@ void bilateral_filter_gpu(
         bg2Entries[1].binding = 1;
         bg2Entries[1].textureView = outputTexture.CreateView();
         wgpu::BindGroupDescriptor bg2Desc = {};
-        bg2Desc.layout = pipelineLAB2RGB.GetBindGroupLayout(0);
+        bg2Desc.layout = GPU::getClassInstance().getBindGroupLayout("cielab2rgb");
         bg2Desc.entryCount = 2;
         bg2Desc.entries = bg2Entries;
         bindGroupLAB2RGB = GPU::getClassInstance().get_device().CreateBindGroup(&bg2Desc);
@@ -214,10 +283,8 @@ void bilateral_filter_gpu(
         GPU::getAlignedBytesPerRow(width, static_cast<uint32_t>(bytesPerPixel));
     uint32_t bufferSize = alignedBytesPerRow * height;
 
-    wgpu::BufferDescriptor readBufDesc = {};
-    readBufDesc.size = bufferSize;
-    readBufDesc.usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst;
-    wgpu::Buffer readBuffer = GPU::getClassInstance().get_device().CreateBuffer(&readBufDesc);
+    const wgpu::BufferUsage readUsage {wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst};
+    wgpu::Buffer readBuffer = GPU::getClassInstance().acquireBuffer(bufferSize, readUsage);
 
     wgpu::TexelCopyTextureInfo srcTex = {};
     srcTex.texture = outputTexture;
@@ -232,82 +299,159 @@ void bilateral_filter_gpu(
     GPU::getClassInstance().get_queue().Submit(1, &commands);
     std::cout << "queue submit" << std::endl;
 
-    // static volatile bool waiting = true;
-
-    // 9. Map Async (To read data back to C++)
-    // In a real app, you likely pass a callback function here.
-    struct ReadbackContext {
-        wgpu::Buffer buffer;
-        uint32_t size;
-        uint32_t alignedBytesPerRow;
-        int width;
-        int height;
-    };
-
-    uint8_t* result_ptr = result.data();
-    bool* waiting = new bool(true);
-
-    readBuffer.MapAsync(
-        wgpu::MapMode::Read, 0, bufferSize, wgpu::CallbackMode::AllowProcessEvents,
-        [](wgpu::MapAsyncStatus status, wgpu::StringView message, void* userdata) {
-            std::cout << "In callback" << std::endl;
-            bool* flag = static_cast<bool*>(userdata);
-            bool success = false;
-            if (status == wgpu::MapAsyncStatus::Success) {
-                success = true;
-                // std::cout << "Map success: " << message.data << std::endl;
-            } else {
-                // Handle error
-                success = false;
-                // std::cerr << "Map failed: " << message.data << std::endl;
-            }
-            *flag = false;
-        },
-        (void*)waiting
+    // 9. Map the readback buffer; GPU::wait blocks without spinning a core
+    bool mapped {false};
+    wgpu::Future mapFuture = readBuffer.MapAsync(
+        wgpu::MapMode::Read, 0, bufferSize, wgpu::CallbackMode::WaitAnyOnly,
+        [&mapped](wgpu::MapAsyncStatus status, wgpu::StringView) {
+            mapped = status == wgpu::MapAsyncStatus::Success;
+        }
     );
+    GPU::getClassInstance().wait(mapFuture);
+    uint8_t* result_ptr = result.data();
 
-    std::cout << "waiting " << *waiting << std::endl;
-
-    while (*waiting) {
-        GPU::getClassInstance().get_instance().ProcessEvents();
-#if defined(__EMSCRIPTEN__)
-        emscripten_sleep(10);
-#endif
-    }
     std::cout << "done wgpu" << std::endl;
-    const uint8_t* mappedData = (const uint8_t*)readBuffer.GetConstMappedRange(0, bufferSize);
-    // copy to cpu buffer
-    for (size_t y = 0; y < height; ++y) {
-        const uint8_t* rowPtr = mappedData + (y * alignedBytesPerRow);
-        for (size_t x = 0; x < width; ++x) {
-            const uint8_t* pixelPtr = rowPtr + (x * bytesPerPixel);
-            size_t dstIndex = 4 * (y * width + x); // RGBA
-
-            std::memcpy(&result_ptr[dstIndex], pixelPtr, sizeof(uint8_t));
-            std::memcpy(&result_ptr[dstIndex + 1], pixelPtr + 1, sizeof(uint8_t));
-            std::memcpy(&result_ptr[dstIndex + 2], pixelPtr + 2, sizeof(uint8_t));
-            std::memcpy(&result_ptr[dstIndex + 3], pixelPtr + 3, sizeof(uint8_t));
+    // a failed map leaves the image unfiltered
+    if (mapped) {
+        const uint8_t* mappedData = (const uint8_t*)readBuffer.GetConstMappedRange(0, bufferSize);
+        // copy to cpu buffer
+        for (size_t y = 0; y < height; ++y) {
+            const uint8_t* rowPtr = mappedData + (y * alignedBytesPerRow);
+            for (size_t x = 0; x < width; ++x) {
+                const uint8_t* pixelPtr = rowPtr + (x * bytesPerPixel);
+                size_t dstIndex = 4 * (y * width + x); // RGBA
+
+                std::memcpy(&result_ptr[dstIndex], pixelPtr, sizeof(uint8_t));
+                std::memcpy(&result_ptr[dstIndex + 1], pixelPtr + 1, sizeof(uint8_t));
+                std::memcpy(&result_ptr[dstIndex + 2], pixelPtr + 2, sizeof(uint8_t));
+                std::memcpy(&result_ptr[dstIndex + 3], pixelPtr + 3, sizeof(uint8_t));
+            }
         }
+        readBuffer.Unmap();
+        std::memcpy(image, result.data(), result.size());
     }
-    readBuffer.Unmap();
-    std::memcpy(image, result.data(), result.size());
     std::cout << "done memcpy" << std::endl;
 
-    // explicit clean up
-
-    if (inputTexture)
-        inputTexture.Destroy();
-    if (outputTexture)
-        outputTexture.Destroy();
-    if (texLabRaw)
-        texLabRaw.Destroy();
-    if (texLabFiltered)
-        texLabFiltered.Destroy();
-    readBuffer.Destroy();
-    delete waiting;
+    // hand everything back to the GPU pool for the next call
+    GPU::getClassInstance().releaseTexture(inputTexture, texDesc);
+    GPU::getClassInstance().releaseTexture(outputTexture, outDesc);
+    GPU::getClassInstance().releaseTexture(texLabRaw, descLab);
+    GPU::getClassInstance().releaseTexture(texLabFiltered, descLab);
+    GPU::getClassInstance().releaseBuffer(paramBuffer, sizeof(FilterParams), paramUsage);
+    GPU::getClassInstance().releaseBuffer(weightBuffer, weightBytes, weightUsage);
+    GPU::getClassInstance().releaseBuffer(readBuffer, bufferSize, readUsage);
 #if defined(__EMSCRIPTEN__)
     emscripten_sleep(50);
 #endif
     result.clear();
     result.shrink_to_fit();
 }
+
+wgpu::Texture bilateral_filter_gpu_resident(
+    const uint8_t* image, size_t width, size_t height, double sigma_spatial, double sigma_range,
+    uint8_t color_space, wgpu::TextureDescriptor& out_desc
+) {
+    GPU& gpu {GPU::getClassInstance()};
+    auto device_lock {gpu.lock_device()}; // see GPU::lock_device
+    const bool lab {color_space == COLOR_SPACE_OPTION_CIELAB};
+    const bool smooth {sigma_spatial > 0.0 && sigma_range > 0.0};
+
+    // 1. Upload the RGBA8 input
+    wgpu::TextureDescriptor inDesc = {};
+    inDesc.size = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+    inDesc.format = wgpu::TextureFormat::RGBA8Unorm;
+    inDesc.usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::CopyDst;
+    wgpu::Texture inputTexture = gpu.acquireTexture(inDesc);
+
+    wgpu::TexelCopyTextureInfo dst = {};
+    dst.texture = inputTexture;
+    wgpu::TexelCopyBufferLayout layout = {};
+    layout.bytesPerRow = width * 4;
+    layout.rowsPerImage = height;
+    gpu.get_queue().WriteTexture(&dst, image, width * height * 4, &layout, &inDesc.size);
+
+    // 2. Intermediates: float LAB in CIELAB mode, RGBA8 (as the regular filter) in RGB mode
+    wgpu::TextureDescriptor labDesc = inDesc;
+    labDesc.format = wgpu::TextureFormat::RGBA32Float;
+    labDesc.usage = wgpu::TextureUsage::StorageBinding | wgpu::TextureUsage::TextureBinding;
+    wgpu::TextureDescriptor rgbDesc = inDesc;
+    rgbDesc.usage = wgpu::TextureUsage::StorageBinding | wgpu::TextureUsage::TextureBinding;
+    std::vector<std::pair<wgpu::Texture, const wgpu::TextureDescriptor*>> intermediates;
+
+    out_desc = labDesc;
+    out_desc.usage = wgpu::TextureUsage::StorageBinding | wgpu::TextureUsage::TextureBinding |
+                     wgpu::TextureUsage::CopySrc;
+    wgpu::Texture outputTexture = gpu.acquireTexture(out_desc);
+
+    const wgpu::BufferUsage paramUsage {wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst};
+    const int radius {smooth ? bilateral_kernel_radius(sigma_spatial) : 0};
+    FilterParams filterParams = {
+        static_cast<float>(sigma_spatial), static_cast<float>(sigma_range), radius, 0.0f};
+    wgpu::Buffer filterBuffer = gpu.acquireBuffer(sizeof(FilterParams), paramUsage);
+    gpu.get_queue().WriteBuffer(filterBuffer, 0, &filterParams, sizeof(FilterParams));
+    const std::vector<float> weights {spatial_weight_table(radius, smooth ? sigma_spatial : 1.0)};
+    const uint64_t weightBytes {weights.size() * sizeof(float)};
+    const wgpu::BufferUsage weightUsage {wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst};
+    wgpu::Buffer weightBuffer = gpu.acquireBuffer(weightBytes, weightUsage);
+    gpu.get_queue().WriteBuffer(weightBuffer, 0, weights.data(), weightBytes);
+    ScaleParams scaleParams = {lab ? 1.0f / 255.0f : 1.0f, 0.0f, 0.0f, 0.0f};
+    wgpu::Buffer scaleBuffer = gpu.acquireBuffer(sizeof(ScaleParams), paramUsage);
+    gpu.get_queue().WriteBuffer(scaleBuffer, 0, &scaleParams, sizeof(ScaleParams));
+
+    // 3. Passes: [rgb2cielab] -> [bilateral filter] -> kmeans_input, each reading the
+    // previous one's output
+    wgpu::CommandEncoder encoder = gpu.get_device().CreateCommandEncoder();
+    wgpu::Texture source = inputTexture;
+
+    if (lab) {
+        wgpu::Texture texLab = gpu.acquireTexture(labDesc);
+        wgpu::BindGroupEntry entries[2];
+        entries[0].binding = 0;
+        entries[0].textureView = source.CreateView();
+        entries[1].binding = 1;
+        entries[1].textureView = texLab.CreateView();
+        dispatch_image_pass(encoder, "rgb2cielab", entries, 2, width, height);
+        intermediates.emplace_back(texLab, &labDesc);
+        source = texLab;
+    }
+
+    if (smooth) {
+        wgpu::Texture filtered = gpu.acquireTexture(lab ? labDesc : rgbDesc);
+        wgpu::BindGroupEntry entries[4];
+        entries[0].binding = 0;
+        entries[0].textureView = source.CreateView();
+        entries[1].binding = 1;
+        entries[1].textureView = filtered.CreateView();
+        entries[2].binding = 2;
+        entries[2].buffer = filterBuffer;
+        entries[2].size = sizeof(FilterParams);
+        entries[3].binding = 3;
+        entries[3].buffer = weightBuffer;
+        entries[3].size = weightBytes;
+        dispatch_image_pass(encoder, filter_shader_id(lab, radius), entries, 4, width, height);
+        intermediates.emplace_back(filtered, lab ? &labDesc : &rgbDesc);
+        source = filtered;
+    }
+
+    wgpu::BindGroupEntry entries[3];
+    entries[0].binding = 0;
+    entries[0].textureView = source.CreateView();
+    entries[1].binding = 1;
+    entries[1].textureView = outputTexture.CreateView();
+    entries[2].binding = 2;
+    entries[2].buffer = scaleBuffer;
+    entries[2].size = sizeof(ScaleParams);
+    dispatch_image_pass(encoder, "kmeans_input", entries, 3, width, height);
+
+    wgpu::CommandBuffer commands = encoder.Finish();
+    gpu.get_queue().Submit(1, &commands);
+
+    // queue order keeps the recycled resources safe for whoever acquires them next
+    gpu.releaseTexture(inputTexture, inDesc);
+    for (auto& [texture, desc] : intermediates)
+        gpu.releaseTexture(texture, *desc);
+    gpu.releaseBuffer(filterBuffer, sizeof(FilterParams), paramUsage);
+    gpu.releaseBuffer(weightBuffer, weightBytes, weightUsage);
+    gpu.releaseBuffer(scaleBuffer, sizeof(ScaleParams), paramUsage);
+    return outputTexture;
+}
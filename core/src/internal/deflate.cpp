@@ -0,0 +1,423 @@
+#include "internal/deflate.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+static constexpr size_t WINDOW_SIZE {32768};
+static constexpr size_t WINDOW_MASK {WINDOW_SIZE - 1};
+static constexpr size_t BLOCK_SIZE {65536}; // uncompressed bytes per deflate block
+static constexpr int HASH_BITS {15};
+static constexpr size_t MIN_MATCH {3};
+static constexpr size_t MAX_MATCH {258};
+static constexpr int MAX_CHAIN {64};
+static constexpr size_t NICE_MATCH {128}; // stop searching once a match is this long
+
+static constexpr int NUM_LITLEN {286};
+static constexpr int NUM_DIST {30};
+static constexpr int NUM_CODELEN {19};
+static constexpr int END_OF_BLOCK {256};
+
+static constexpr uint16_t LENGTH_BASE[29] {3,  4,  5,  6,  7,  8,  9,  10,  11,  13,
+                                           15, 17, 19, 23, 27, 31, 35, 43,  51,  59,
+                                           67, 83, 99, 115, 131, 163, 195, 227, 258};
+static constexpr uint8_t LENGTH_EXTRA[29] {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                           2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static constexpr uint16_t DIST_BASE[30] {1,    2,    3,    4,    5,    7,     9,     13,
+                                         17,   25,   33,   49,   65,   97,    129,   193,
+                                         257,  385,  513,  769,  1025, 1537,  2049,  3073,
+                                         4097, 6145, 8193, 12289, 16385, 24577};
+static constexpr uint8_t DIST_EXTRA[30] {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                         6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static constexpr uint8_t CODELEN_ORDER[NUM_CODELEN] {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                                     11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+static const std::array<uint32_t, 256>& crc_table() {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t {};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c {n};
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+/*
+Huffman code lengths limited to `max_bits`. When the optimal tree is too deep
+the frequencies are flattened and the tree rebuilt. At least two symbols always
+get a code so that every emitted code is complete.
+*/
+static std::vector<uint8_t> code_lengths(const std::vector<uint32_t>& freqs, int max_bits) {
+    const int n {static_cast<int>(freqs.size())};
+    std::vector<uint8_t> lengths(n, 0);
+    std::vector<uint32_t> f {freqs};
+
+    std::vector<int> used;
+    for (int i = 0; i < n; ++i)
+        if (f[i] > 0)
+            used.push_back(i);
+    if (used.size() < 2) {
+        const int first {used.empty() ? 0 : used[0]};
+        lengths[first] = 1;
+        lengths[first == 0 ? 1 : 0] = 1;
+        return lengths;
+    }
+
+    for (;;) {
+        // nodes [0, used) are leaves; parents are appended
+        std::vector<int> parent(2 * used.size(), -1);
+        using Item = std::pair<uint64_t, int>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+        for (size_t i = 0; i < used.size(); ++i)
+            heap.push({f[used[i]], static_cast<int>(i)});
+
+        int next {static_cast<int>(used.size())};
+        while (heap.size() > 1) {
+            Item a {heap.top()};
+            heap.pop();
+            Item b {heap.top()};
+            heap.pop();
+            parent[a.second] = next;
+            parent[b.second] = next;
+            heap.push({a.first + b.first, next++});
+        }
+
+        // depth of each node; parents always have larger indices than children
+        std::vector<int> depth(next, 0);
+        int max_depth {0};
+        for (int i = next - 2; i >= 0; --i) {
+            depth[i] = depth[parent[i]] + 1;
+            max_depth = std::max(max_depth, depth[i]);
+        }
+
+        if (max_depth <= max_bits) {
+            for (size_t i = 0; i < used.size(); ++i)
+                lengths[used[i]] = static_cast<uint8_t>(depth[i]);
+            return lengths;
+        }
+        for (int s : used)
+            f[s] = (f[s] >> 1) | 1;
+    }
+}
+
+// Canonical codes (RFC 1951 3.2.2), bit-reversed for the LSB-first bit writer
+static std::vector<uint16_t> canonical_codes(const std::vector<uint8_t>& lengths) {
+    uint16_t bl_count[16] {};
+    for (uint8_t l : lengths)
+        bl_count[l]++;
+    bl_count[0] = 0;
+
+    uint16_t next_code[16] {};
+    uint16_t code {0};
+    for (int bits = 1; bits < 16; ++bits) {
+        code = static_cast<uint16_t>((code + bl_count[bits - 1]) << 1);
+        next_code[bits] = code;
+    }
+
+    std::vector<uint16_t> codes(lengths.size(), 0);
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        const int len {lengths[i]};
+        if (len == 0)
+            continue;
+        uint16_t c {next_code[len]++};
+        uint16_t reversed {0};
+        for (int b = 0; b < len; ++b) {
+            reversed = static_cast<uint16_t>((reversed << 1) | (c & 1));
+            c >>= 1;
+        }
+        codes[i] = reversed;
+    }
+    return codes;
+}
+
+static int length_symbol(int length) {
+    const int i {static_cast<int>(
+        std::upper_bound(std::begin(LENGTH_BASE), std::end(LENGTH_BASE), length) -
+        std::begin(LENGTH_BASE) - 1
+    )};
+    return i;
+}
+
+static int dist_symbol(int dist) {
+    const int i {static_cast<int>(
+        std::upper_bound(std::begin(DIST_BASE), std::end(DIST_BASE), dist) - std::begin(DIST_BASE) -
+        1
+    )};
+    return i;
+}
+
+GzipEncoder::GzipEncoder(std::vector<uint8_t>& out)
+    : m_out(out)
+    , m_head(size_t(1) << HASH_BITS, -1)
+    , m_prev(WINDOW_SIZE, -1) {
+    // ID1 ID2 CM=deflate FLG=0 MTIME=0 XFL=0 OS=unknown
+    const uint8_t header[10] {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+    m_out.insert(m_out.end(), header, header + sizeof(header));
+}
+
+void GzipEncoder::write(const uint8_t* data, size_t size) {
+    if (m_finished)
+        throw std::logic_error("GzipEncoder: write after finish");
+
+    const std::array<uint32_t, 256>& table {crc_table()};
+    for (size_t i = 0; i < size; ++i)
+        m_crc = table[(m_crc ^ data[i]) & 0xFF] ^ (m_crc >> 8);
+    m_total_in += size;
+
+    m_window.insert(m_window.end(), data, data + size);
+    while (m_window_start + m_window.size() - m_pending >= BLOCK_SIZE + MAX_MATCH)
+        compress_pending(false);
+}
+
+void GzipEncoder::finish() {
+    if (m_finished)
+        return;
+    if (m_window_start + m_window.size() > m_pending)
+        compress_pending(true);
+
+    // empty final block with fixed codes: BFINAL=1, BTYPE=01, end-of-block (7 zero bits)
+    put_bits(1, 1);
+    put_bits(1, 2);
+    put_bits(0, 7);
+    flush_bits();
+
+    const uint32_t crc {m_crc ^ 0xFFFFFFFFu};
+    const uint32_t isize {static_cast<uint32_t>(m_total_in)};
+    for (int i = 0; i < 4; ++i)
+        m_out.push_back(static_cast<uint8_t>(crc >> (8 * i)));
+    for (int i = 0; i < 4; ++i)
+        m_out.push_back(static_cast<uint8_t>(isize >> (8 * i)));
+    m_finished = true;
+}
+
+void GzipEncoder::put_bits(uint32_t value, int count) {
+    m_bit_buffer |= static_cast<uint64_t>(value) << m_bit_count;
+    m_bit_count += count;
+    while (m_bit_count >= 8) {
+        m_out.push_back(static_cast<uint8_t>(m_bit_buffer));
+        m_bit_buffer >>= 8;
+        m_bit_count -= 8;
+    }
+}
+
+void GzipEncoder::flush_bits() {
+    if (m_bit_count > 0)
+        put_bits(0, 8 - m_bit_count);
+}
+
+void GzipEncoder::compress_pending(bool flush_all) {
+    const uint64_t end {m_window_start + m_window.size()};
+    // keep a full match of lookahead unless this is the last block
+    const uint64_t limit {flush_all ? end : std::min(end - MAX_MATCH, m_pending + BLOCK_SIZE)};
+
+    auto at = [&](uint64_t pos) {
+        return m_window[pos - m_window_start];
+    };
+    auto hash = [&](uint64_t pos) {
+        const uint32_t v {static_cast<uint32_t>(at(pos)) << 16 |
+                          static_cast<uint32_t>(at(pos + 1)) << 8 | at(pos + 2)};
+        return (v * 2654435761u) >> (32 - HASH_BITS);
+    };
+    auto insert = [&](uint64_t pos) {
+        if (pos + MIN_MATCH > end)
+            return;
+        const uint32_t h {hash(pos)};
+        m_prev[pos & WINDOW_MASK] = m_head[h];
+        m_head[h] = static_cast<int64_t>(pos);
+    };
+
+    uint64_t p {m_pending};
+    while (p < limit) {
+        size_t best_len {0};
+        uint64_t best_dist {0};
+
+        if (p + MIN_MATCH <= end) {
+            const size_t max_len {static_cast<size_t>(std::min<uint64_t>(MAX_MATCH, end - p))};
+            int64_t cand {m_head[hash(p)]};
+            int chain {MAX_CHAIN};
+            while (cand >= 0 && chain-- > 0) {
+                const uint64_t c {static_cast<uint64_t>(cand)};
+                if (c < m_window_start || p - c > WINDOW_SIZE)
+                    break;
+                const uint8_t* a {&m_window[c - m_window_start]};
+                const uint8_t* b {&m_window[p - m_window_start]};
+                size_t len {0};
+                if (a[best_len] == b[best_len] || best_len >= max_len) {
+                    while (len < max_len && a[len] == b[len])
+                        ++len;
+                }
+                if (len > best_len) {
+                    best_len = len;
+                    best_dist = p - c;
+                    if (len >= std::min(max_len, NICE_MATCH))
+                        break;
+                }
+                const int64_t older {m_prev[c & WINDOW_MASK]};
+                if (older >= cand)
+                    break; // slot was reused by a newer position
+                cand = older;
+            }
+        }
+
+        if (best_len >= MIN_MATCH) {
+            m_tokens.push_back({static_cast<uint16_t>(best_len), static_cast<uint16_t>(best_dist)});
+            for (size_t i = 0; i < best_len; ++i)
+                insert(p + i);
+            p += best_len;
+        } else {
+            m_tokens.push_back({at(p), 0});
+            insert(p);
+            ++p;
+        }
+    }
+    m_pending = p;
+    emit_block();
+
+    // drop history that can no longer be referenced
+    const uint64_t keep_from {m_pending > WINDOW_SIZE ? m_pending - WINDOW_SIZE : 0};
+    if (keep_from > m_window_start) {
+        m_window.erase(
+            m_window.begin(), m_window.begin() + static_cast<std::ptrdiff_t>(keep_from - m_window_start)
+        );
+        m_window_start = keep_from;
+    }
+}
+
+void GzipEncoder::emit_block() {
+    std::vector<uint32_t> litlen_freq(NUM_LITLEN, 0);
+    std::vector<uint32_t> dist_freq(NUM_DIST, 0);
+    for (const Token& t : m_tokens) {
+        if (t.dist == 0) {
+            litlen_freq[t.litlen]++;
+        } else {
+            litlen_freq[257 + length_symbol(t.litlen)]++;
+            dist_freq[dist_symbol(t.dist)]++;
+        }
+    }
+    litlen_freq[END_OF_BLOCK]++;
+
+    const std::vector<uint8_t> litlen_len {code_lengths(litlen_freq, 15)};
+    const std::vector<uint8_t> dist_len {code_lengths(dist_freq, 15)};
+    const std::vector<uint16_t> litlen_code {canonical_codes(litlen_len)};
+    const std::vector<uint16_t> dist_code {canonical_codes(dist_len)};
+
+    int hlit {NUM_LITLEN};
+    while (hlit > 257 && litlen_len[hlit - 1] == 0)
+        --hlit;
+    int hdist {NUM_DIST};
+    while (hdist > 1 && dist_len[hdist - 1] == 0)
+        --hdist;
+
+    // run-length encode both length tables with the code length alphabet
+    std::vector<uint8_t> all_lengths(litlen_len.begin(), litlen_len.begin() + hlit);
+    all_lengths.insert(all_lengths.end(), dist_len.begin(), dist_len.begin() + hdist);
+
+    std::vector<std::pair<uint8_t, uint8_t>> rle; // (symbol, extra bits value)
+    for (size_t i = 0; i < all_lengths.size();) {
+        const uint8_t len {all_lengths[i]};
+        size_t run {1};
+        while (i + run < all_lengths.size() && all_lengths[i + run] == len)
+            ++run;
+
+        if (len == 0 && run >= 3) {
+            const size_t r {std::min<size_t>(run, 138)};
+            if (r >= 11)
+                rle.push_back({18, static_cast<uint8_t>(r - 11)});
+            else
+                rle.push_back({17, static_cast<uint8_t>(r - 3)});
+            i += r;
+        } else if (len != 0 && run >= 4) {
+            rle.push_back({len, 0});
+            const size_t r {std::min<size_t>(run - 1, 6)};
+            rle.push_back({16, static_cast<uint8_t>(r - 3)});
+            i += 1 + r;
+        } else {
+            rle.push_back({len, 0});
+            ++i;
+        }
+    }
+
+    std::vector<uint32_t> codelen_freq(NUM_CODELEN, 0);
+    for (const auto& [sym, _] : rle)
+        codelen_freq[sym]++;
+    const std::vector<uint8_t> codelen_len {code_lengths(codelen_freq, 7)};
+    const std::vector<uint16_t> codelen_code {canonical_codes(codelen_len)};
+
+    int hclen {NUM_CODELEN};
+    while (hclen > 4 && codelen_len[CODELEN_ORDER[hclen - 1]] == 0)
+        --hclen;
+
+    // block header: BFINAL=0, BTYPE=10 (dynamic Huffman)
+    put_bits(0, 1);
+    put_bits(2, 2);
+    put_bits(static_cast<uint32_t>(hlit - 257), 5);
+    put_bits(static_cast<uint32_t>(hdist - 1), 5);
+    put_bits(static_cast<uint32_t>(hclen - 4), 4);
+    for (int i = 0; i < hclen; ++i)
+        put_bits(codelen_len[CODELEN_ORDER[i]], 3);
+
+    for (const auto& [sym, extra] : rle) {
+        put_bits(codelen_code[sym], codelen_len[sym]);
+        if (sym == 16)
+            put_bits(extra, 2);
+        else if (sym == 17)
+            put_bits(extra, 3);
+        else if (sym == 18)
+            put_bits(extra, 7);
+    }
+
+    for (const Token& t : m_tokens) {
+        if (t.dist == 0) {
+            put_bits(litlen_code[t.litlen], litlen_len[t.litlen]);
+            continue;
+        }
+        const int ls {length_symbol(t.litlen)};
+        put_bits(litlen_code[257 + ls], litlen_len[257 + ls]);
+        put_bits(static_cast<uint32_t>(t.litlen - LENGTH_BASE[ls]), LENGTH_EXTRA[ls]);
+        const int ds {dist_symbol(t.dist)};
+        put_bits(dist_code[ds], dist_len[ds]);
+        put_bits(static_cast<uint32_t>(t.dist - DIST_BASE[ds]), DIST_EXTRA[ds]);
+    }
+    put_bits(litlen_code[END_OF_BLOCK], litlen_len[END_OF_BLOCK]);
+
+    m_tokens.clear();
+}
+
+void GzipStreamBuf::drain() {
+    const std::ptrdiff_t n {pptr() - pbase()};
+    if (n > 0)
+        m_encoder.write(reinterpret_cast<const uint8_t*>(pbase()), static_cast<size_t>(n));
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+GzipStreamBuf::int_type GzipStreamBuf::overflow(int_type ch) {
+    drain();
+    if (traits_type::eq_int_type(ch, traits_type::eof()))
+        return traits_type::not_eof(ch);
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+std::streamsize GzipStreamBuf::xsputn(const char* s, std::streamsize n) {
+    if (n <= epptr() - pptr()) {
+        std::memcpy(pptr(), s, static_cast<size_t>(n));
+        pbump(static_cast<int>(n));
+        return n;
+    }
+    drain();
+    m_encoder.write(reinterpret_cast<const uint8_t*>(s), static_cast<size_t>(n));
+    return n;
+}
+
+int GzipStreamBuf::sync() {
+    drain();
+    return 0;
+}
@@ -261,7 +261,7 @@ std::vector<uint8_t> Graph::analyzeJunctions(const std::vector<uint8_t>& skel, i
     return junction_map;
 }
 
-void Graph::compute_contours() {
+void Graph::compute_contours(std::vector<int32_t>& labels) {
 
     /*
     Shared-edge mode: build region boundaries on the crack grid so
@@ -271,7 +271,9 @@ void Graph::compute_contours() {
 
     float eps = 0.25f;
 
-    std::vector<int32_t> labels(static_cast<size_t>(m_width) * m_height, -1);
+    // refresh the caller's raster with post-merge node ids instead of allocating a new one
+    labels.resize(static_cast<size_t>(m_width) * m_height);
+    std::fill(labels.begin(), labels.end(), -1);
     for (const Node_ptr& n : get_nodes()) {
         if (n->area() == 0)
             continue;
@@ -279,18 +281,19 @@ void Graph::compute_contours() {
             labels[static_cast<size_t>(p.position.y) * m_width + p.position.x] = n->id();
     }
 
-    auto loops = build_shared_loops(labels, m_width, m_height, eps);
+    m_topology = build_shared_topology(labels, m_width, m_height, eps);
 
     for (const Node_ptr& n : get_nodes()) {
         if (n->area() == 0)
             continue;
         n->clear_contour();
-        auto it = loops.find(n->id());
-        if (it == loops.end())
+        auto it = m_topology.loops.find(n->id());
+        if (it == m_topology.loops.end())
             continue;
         ImageLib::RGBPixel<uint8_t> c = n->color();
         ImageLib::RGBAPixel<uint8_t> col {c.red, c.green, c.blue, 255};
-        for (std::vector<QuadBezier>& curve : it->second) {
+        for (const std::vector<int32_t>& loop : it->second) {
+            std::vector<QuadBezier> curve = expand_loop(m_topology, loop);
             std::vector<Point> anchors; // keep contours[] parallel to curves[]
             anchors.reserve(curve.size() + 1);
             for (const QuadBezier& q : curve)
@@ -396,7 +399,14 @@ float max_inscribed_radius(const Node_ptr& n) {
 
 } // namespace
 
-void Graph::merge_small_area_nodes(const int32_t min_area, const int32_t min_thickness) {
+void Graph::merge_small_area_nodes(
+    const int32_t min_area, const int32_t min_thickness, const std::vector<uint8_t>& pinned
+) {
+    auto is_pinned = [&pinned](const Node_ptr& n) {
+        const size_t id {static_cast<size_t>(n->id())};
+        return id < pinned.size() && pinned[id];
+    };
+
     // Keep merging while any pass still makes progress. Using "did this pass
     // merge anything?" as the loop guard (instead of re-testing every node)
     // also avoids spinning forever on a node that is too small/thin but has no
@@ -406,7 +416,7 @@ void Graph::merge_small_area_nodes(const int32_t min_area, const int32_t min_thi
         merged_any = false;
 
         for (const Node_ptr& n : get_nodes()) {
-            if (n->area() == 0)
+            if (n->area() == 0 || is_pinned(n))
                 continue;
 
             bool needs_merge = n->area() < static_cast<size_t>(min_area);
@@ -437,7 +447,7 @@ void Graph::merge_small_area_nodes(const int32_t min_area, const int32_t min_thi
                 continue;
             }
 
-            if (best_neighbor->area() >= n->area()) {
+            if (is_pinned(best_neighbor) || best_neighbor->area() >= n->area()) {
                 merge_nodes(best_neighbor, n);
             } else {
                 merge_nodes(n, best_neighbor);
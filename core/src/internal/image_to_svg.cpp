@@ -1,32 +1,348 @@
 #include "img2num.h"
+#include "internal/bilateral_filter_gpu.h"
+#include "internal/cielab_pipeline.h"
+#include "internal/execution.h"
+#include "internal/gpu.h"
+#include "internal/gpu_pipeline.h"
+#include "internal/kmeans_gpu.h"
+#include "internal/pixel_format.h"
+#include "internal/resample.h"
+#include "internal/row_source.h"
+#include "internal/tiling.h"
+#include "internal/workspace.h"
 
-#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
+static constexpr uint8_t COLOR_SPACE_OPTION_CIELAB {0};
+
 namespace img2num {
-std::string image_to_svg(
-    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+bool init_gpu_backend() {
+    return GPU::getClassInstance().ensure_initialized();
+}
+
+void warmup() {
+    GPU::getClassInstance().start_warmup();
+}
+
+void cluster_labels(
+    const ImageView& image, const ImageToSvgConfig& config, const bool gpu_available,
+    Workspace& workspace
 ) {
-    // self deallocate
-    std::vector<uint8_t> img_data(static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
-    std::vector<uint8_t> out_data(static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
-    std::vector<int32_t> out_labels(static_cast<size_t>(width) * static_cast<size_t>(height));
+    const int width {image.width};
+    const int height {image.height};
+    const size_t num_pixels {static_cast<size_t>(width) * static_cast<size_t>(height)};
+    workspace.labels.resize(num_pixels);
 
-    std::memcpy(
-        img_data.data(), data, static_cast<size_t>(width) * static_cast<size_t>(height) * 4
+    const int64_t pixels {static_cast<int64_t>(num_pixels)};
+    const bool filter_gpu {bilateral_filter_on_gpu(config.execution, gpu_available, pixels)};
+    const bool cluster_gpu {
+        kmeans_on_gpu(config.execution, gpu_available, pixels, config.kmeans.k)};
+
+    // On the CPU, CIELAB stays resident as float between the two stages, and the filter
+    // reads the input rows in their own format
+    if (config.color_space == COLOR_SPACE_OPTION_CIELAB && !filter_gpu && !cluster_gpu) {
+        MemoryRowSource source {image};
+        bilateral_filter_lab_cpu(
+            source, config.bilateral_filter.sigma_spatial, config.bilateral_filter.sigma_range,
+            workspace.lab, workspace.bilateral
+        );
+        kmeans_lab_cpu(
+            workspace.lab, workspace.labels.data(), config.kmeans.k, config.kmeans.max_iter,
+            nullptr, &workspace.kmeans, config.kmeans.pyramid_levels, config.kmeans.refine_iter
+        );
+        return;
+    }
+
+    // the working copy filtered in place doubles as the RGBA conversion
+    load_rgba(image, workspace.image);
+    if (filter_gpu && cluster_gpu) {
+        // the filtered texture stays on the device; only labels and centroids come back.
+        // The device stays locked from upload to release of the hand-off texture.
+        auto device_lock {GPU::getClassInstance().lock_device()};
+        wgpu::TextureDescriptor filtered_desc = {};
+        wgpu::Texture filtered {bilateral_filter_gpu_resident(
+            workspace.image.data(), width, height, config.bilateral_filter.sigma_spatial,
+            config.bilateral_filter.sigma_range, config.color_space, filtered_desc
+        )};
+        kmeans_gpu_resident(
+            filtered, width, height, workspace.labels.data(), config.kmeans.k,
+            config.kmeans.max_iter
+        );
+        GPU::getClassInstance().releaseTexture(filtered, filtered_desc);
+        return;
+    }
+
+    // stages on different devices meet in the RGBA working copy
+    if (filter_gpu) {
+        bilateral_filter_gpu(
+            workspace.image.data(), width, height, config.bilateral_filter.sigma_spatial,
+            config.bilateral_filter.sigma_range, config.color_space
+        );
+    } else {
+        bilateral_filter_cpu(
+            workspace.image.data(), width, height, config.bilateral_filter.sigma_spatial,
+            config.bilateral_filter.sigma_range, config.color_space, workspace.bilateral
+        );
+    }
+    if (cluster_gpu) {
+        kmeans_gpu(
+            workspace.image.data(), nullptr, workspace.labels.data(), width, height,
+            config.kmeans.k, config.kmeans.max_iter, config.color_space
+        );
+    } else {
+        kmeans_cpu(
+            workspace.image.data(), nullptr, workspace.labels.data(), width, height,
+            config.kmeans.k, config.kmeans.max_iter, config.color_space, workspace.kmeans,
+            config.kmeans.pyramid_levels, config.kmeans.refine_iter
+        );
+    }
+}
+
+std::string
+clustered_to_svg(const ImageView& image, const ImageToSvgConfig& config, Workspace& workspace) {
+    const VectorizationResult result {labels_to_vectorization(
+        image, workspace.labels.data(), config.min_cluster_area, config.min_thickness, workspace,
+        false
+    )};
+    return vectorization_to_svg(result, config.svg);
+}
+} // namespace img2num
+
+// Whether the GPU may be used for `config`; never initializes the device for a config that
+// keeps every stage on the CPU
+static bool gpu_available(const img2num::ImageToSvgConfig& config) {
+    return img2num::may_use_gpu(config) && img2num::init_gpu_backend();
+}
+
+// `labels` of the result is only filled `with_labels`; the SVG paths never read it
+static img2num::VectorizationResult image_to_vectorization(
+    const img2num::ImageView& image, const img2num::ImageToSvgConfig& config,
+    img2num::Workspace& workspace, const bool with_labels
+) {
+    const bool use_gpu {gpu_available(config)};
+    if (img2num::uses_resampling(image.width, image.height, config)) {
+        img2num::MemoryRowSource source {image};
+        return img2num::resampled_vectorization(source, config, use_gpu, workspace, with_labels);
+    }
+    if (img2num::uses_tiling(image.width, image.height, config)) {
+        img2num::MemoryRowSource source {image};
+        return img2num::tiled_vectorization(source, config, use_gpu, workspace);
+    }
+
+    img2num::cluster_labels(image, config, use_gpu, workspace);
+    return img2num::labels_to_vectorization(
+        image, workspace.labels.data(), config.min_cluster_area, config.min_thickness, workspace,
+        with_labels
     );
-    bilateral_filter(
-        img_data.data(), width, height, config.bilateral_filter.sigma_spatial,
-        config.bilateral_filter.sigma_range, config.color_space
+}
+
+static std::string image_to_svg(
+    const img2num::ImageView& image, const img2num::ImageToSvgConfig& config,
+    img2num::Workspace& workspace
+) {
+    if (img2num::uses_resampling(image.width, image.height, config) ||
+        img2num::uses_tiling(image.width, image.height, config)) {
+        const img2num::VectorizationResult result {
+            image_to_vectorization(image, config, workspace, false)};
+        return img2num::vectorization_to_svg(result, config.svg);
+    }
+
+    img2num::cluster_labels(image, config, gpu_available(config), workspace);
+    return img2num::clustered_to_svg(image, config, workspace);
+}
+
+static std::vector<uint8_t> image_to_svgz(
+    const img2num::ImageView& image, const img2num::ImageToSvgConfig& config,
+    img2num::Workspace& workspace
+) {
+    const img2num::VectorizationResult result {
+        image_to_vectorization(image, config, workspace, false)};
+    return img2num::vectorization_to_svgz(result, config.svg);
+}
+
+static std::string image_to_arcs(
+    const img2num::ImageView& image, const img2num::ImageToSvgConfig& config,
+    img2num::Workspace& workspace
+) {
+    // arcs share edges across the whole raster: there is no per-tile or downscaled form
+    if (img2num::uses_resampling(image.width, image.height, config) ||
+        img2num::uses_tiling(image.width, image.height, config)) {
+        throw std::invalid_argument(
+            "image_to_arcs: resampling and tiling are not supported; unset resample and tiling"
+        );
+    }
+    img2num::cluster_labels(image, config, gpu_available(config), workspace);
+    return img2num::labels_to_arcs(
+        image, workspace.labels.data(), config.min_cluster_area, config.min_thickness,
+        config.svg.grid, workspace
     );
-    kmeans(
-        img_data.data(), out_data.data(), out_labels.data(), width, height, config.kmeans.k,
-        config.kmeans.max_iter, config.color_space
+}
+
+// Streams the rows through the resampled or tiled pipeline; other inputs are read in whole
+// and take the regular path
+static img2num::VectorizationResult image_to_vectorization(
+    img2num::RowSource& source, const img2num::ImageToSvgConfig& config,
+    img2num::Workspace& workspace, const bool with_labels
+) {
+    const int width {source.width()};
+    const int height {source.height()};
+    if (img2num::uses_resampling(width, height, config)) {
+        return img2num::resampled_vectorization(
+            source, config, gpu_available(config), workspace, with_labels
+        );
+    }
+    if (img2num::uses_tiling(width, height, config)) {
+        return img2num::tiled_vectorization(
+            source, config, gpu_available(config), workspace
+        );
+    }
+
+    std::vector<uint8_t> data(static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
+    source.read_rows(0, height, data.data());
+    return image_to_vectorization(
+        img2num::ImageView {data.data(), width, height}, config, workspace, with_labels
     );
-    std::string svg {labels_to_svg(
-        data, out_labels.data(), width, height, config.min_cluster_area, config.min_thickness
-    )};
+}
+
+static std::string image_to_svg(
+    img2num::RowSource& source, const img2num::ImageToSvgConfig& config,
+    img2num::Workspace& workspace
+) {
+    const img2num::VectorizationResult result {
+        image_to_vectorization(source, config, workspace, false)};
+    return img2num::vectorization_to_svg(result, config.svg);
+}
+
+namespace img2num {
+std::string image_to_svg(
+    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+) {
+    Workspace workspace;
+    return ::image_to_svg(ImageView {data, width, height}, config, workspace);
+}
+
+std::vector<uint8_t> image_to_svgz(
+    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+) {
+    Workspace workspace;
+    return ::image_to_svgz(ImageView {data, width, height}, config, workspace);
+}
+
+VectorizationResult image_to_vectorization(
+    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+) {
+    Workspace workspace;
+    return ::image_to_vectorization(ImageView {data, width, height}, config, workspace, true);
+}
+
+std::string image_to_arcs(
+    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+) {
+    Workspace workspace;
+    return ::image_to_arcs(ImageView {data, width, height}, config, workspace);
+}
+
+std::string image_to_svg(const ImageView& image, const ImageToSvgConfig& config) {
+    validate_image_view(image, "image_to_svg");
+    Workspace workspace;
+    return ::image_to_svg(image, config, workspace);
+}
+
+std::vector<uint8_t> image_to_svgz(const ImageView& image, const ImageToSvgConfig& config) {
+    validate_image_view(image, "image_to_svgz");
+    Workspace workspace;
+    return ::image_to_svgz(image, config, workspace);
+}
+
+VectorizationResult image_to_vectorization(const ImageView& image, const ImageToSvgConfig& config) {
+    validate_image_view(image, "image_to_vectorization");
+    Workspace workspace;
+    return ::image_to_vectorization(image, config, workspace, true);
+}
+
+std::string image_to_arcs(const ImageView& image, const ImageToSvgConfig& config) {
+    validate_image_view(image, "image_to_arcs");
+    Workspace workspace;
+    return ::image_to_arcs(image, config, workspace);
+}
+
+std::string image_to_svg(RowSource& source, const ImageToSvgConfig& config) {
+    Workspace workspace;
+    return ::image_to_svg(source, config, workspace);
+}
+
+VectorizationResult image_to_vectorization(RowSource& source, const ImageToSvgConfig& config) {
+    Workspace workspace;
+    return ::image_to_vectorization(source, config, workspace, true);
+}
+
+Context::Context()
+    : m_workspace(std::make_unique<Workspace>()) {
+}
+
+Context::~Context() = default;
+Context::Context(Context&&) noexcept = default;
+Context& Context::operator=(Context&&) noexcept = default;
+
+std::string Context::image_to_svg(
+    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+) {
+    return ::image_to_svg(ImageView {data, width, height}, config, *m_workspace);
+}
+
+std::vector<uint8_t> Context::image_to_svgz(
+    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+) {
+    return ::image_to_svgz(ImageView {data, width, height}, config, *m_workspace);
+}
+
+VectorizationResult Context::image_to_vectorization(
+    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+) {
+    return ::image_to_vectorization(ImageView {data, width, height}, config, *m_workspace, true);
+}
+
+std::string Context::image_to_arcs(
+    const uint8_t* data, const int width, const int height, const ImageToSvgConfig& config
+) {
+    return ::image_to_arcs(ImageView {data, width, height}, config, *m_workspace);
+}
+
+std::string Context::image_to_svg(const ImageView& image, const ImageToSvgConfig& config) {
+    validate_image_view(image, "image_to_svg");
+    return ::image_to_svg(image, config, *m_workspace);
+}
+
+std::vector<uint8_t>
+Context::image_to_svgz(const ImageView& image, const ImageToSvgConfig& config) {
+    validate_image_view(image, "image_to_svgz");
+    return ::image_to_svgz(image, config, *m_workspace);
+}
+
+VectorizationResult
+Context::image_to_vectorization(const ImageView& image, const ImageToSvgConfig& config) {
+    validate_image_view(image, "image_to_vectorization");
+    return ::image_to_vectorization(image, config, *m_workspace, true);
+}
+
+std::string Context::image_to_arcs(const ImageView& image, const ImageToSvgConfig& config) {
+    validate_image_view(image, "image_to_arcs");
+    return ::image_to_arcs(image, config, *m_workspace);
+}
+
+std::string Context::image_to_svg(RowSource& source, const ImageToSvgConfig& config) {
+    return ::image_to_svg(source, config, *m_workspace);
+}
+
+VectorizationResult
+Context::image_to_vectorization(RowSource& source, const ImageToSvgConfig& config) {
+    return ::image_to_vectorization(source, config, *m_workspace, true);
+}
 
-    return svg;
+void Context::release() {
+    m_workspace = std::make_unique<Workspace>();
 }
-} // namespace img2num
\ No newline at end of file
+} // namespace img2num
@@ -1,5 +1,7 @@
 #include "img2num.h"
 #include "internal/cielab.h"
+#include "internal/cielab_pipeline.h"
+#include "internal/execution.h"
 #include "internal/gpu.h"
 #include "internal/Image.h"
 #include "internal/kmeans_gpu.h"
@@ -20,11 +22,14 @@
 
 static constexpr uint8_t COLOR_SPACE_OPTION_CIELAB {0};
 static constexpr uint8_t COLOR_SPACE_OPTION_RGB {1};
+// 2^3 = 8x per axis already leaves 1/64 of the pixels; deeper levels lose the palette
+static constexpr int32_t KMEANS_MAX_PYRAMID_LEVELS {3};
 
 // The K-Means++ Initialization Function
 template <typename PixelT>
 void kMeansPlusPlusInit(
-    const ImageLib::Image<PixelT>& pixels, ImageLib::Image<PixelT>& out_centroids, int k
+    const ImageLib::Image<PixelT>& pixels, ImageLib::Image<PixelT>& out_centroids, int k,
+    std::vector<double>& min_dist_sq
 ) {
     std::vector<PixelT> centroids;
 
@@ -41,7 +46,7 @@ void kMeansPlusPlusInit(
     // Vector to store the squared distance of each pixel to its NEAREST existing
     // centroid. Initialize with max double so the first distance calculation
     // always updates it.
-    std::vector<double> min_dist_sq(num_pixels, std::numeric_limits<double>::max());
+    min_dist_sq.assign(num_pixels, std::numeric_limits<double>::max());
 
     // --- Step 2 & 3: Repeat until we have k centroids ---
     for (int i = 1; i < k; ++i) {
@@ -90,104 +95,87 @@ void kMeansPlusPlusInit(
     std::copy(centroids.begin(), centroids.end(), out_centroids.begin());
 }
 
-void kmeans_cpu(
-    const uint8_t* data, uint8_t* out_data, int32_t* out_labels, const int32_t width,
-    const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space
+// Per-channel sums and means for the k-means update step
+inline void add_color(ImageLib::LABAPixel<float>& sum, const ImageLib::LABAPixel<float>& px) {
+    sum.l += px.l;
+    sum.a += px.a;
+    sum.b += px.b;
+}
+inline void add_color(ImageLib::RGBAPixel<float>& sum, const ImageLib::RGBAPixel<float>& px) {
+    sum.red += px.red;
+    sum.green += px.green;
+    sum.blue += px.blue;
+}
+inline void set_mean(
+    ImageLib::LABAPixel<float>& centroid, const ImageLib::LABAPixel<float>& sum, int32_t count
 ) {
-    ImageLib::Image<ImageLib::RGBAPixel<float>> pixels;
-    pixels.loadFromBuffer(data, width, height, ImageLib::RGBA_CONVERTER<float>);
-    const int32_t num_pixels {pixels.getSize()};
-
-    // width = k, height = 1
-    // k centroids, initialized to rgba(0,0,0,255)
-    // Init of each pixel is from default in Image constructor
-    ImageLib::Image<ImageLib::RGBAPixel<float>> centroids {k, 1};
-    ImageLib::Image<ImageLib::LABAPixel<float>> centroids_lab {k, 1};
-    std::vector<int32_t> labels(num_pixels, 0);
+    centroid.l = sum.l / count;
+    centroid.a = sum.a / count;
+    centroid.b = sum.b / count;
+}
+inline void set_mean(
+    ImageLib::RGBAPixel<float>& centroid, const ImageLib::RGBAPixel<float>& sum, int32_t count
+) {
+    centroid.red = sum.red / count;
+    centroid.green = sum.green / count;
+    centroid.blue = sum.blue / count;
+}
 
-    ImageLib::Image<ImageLib::LABAPixel<float>> lab(pixels.getWidth(), pixels.getHeight());
-    if (color_space == COLOR_SPACE_OPTION_CIELAB) {
-        for (int i {0}; i < pixels.getSize(); ++i) {
-            rgb_to_lab<float, float>(pixels[i], lab[i]);
+// Assignment step: label every pixel with its nearest centroid. Returns whether any label
+// changed.
+template <typename PixelT>
+bool assign_labels(
+    const ImageLib::Image<PixelT>& pixels, const ImageLib::Image<PixelT>& centroids,
+    int32_t* labels, const int32_t k
+) {
+    const int32_t num_pixels {pixels.getSize()};
+    bool changed {false};
+
+    // Iterate over pixels
+    for (int32_t i {0}; i < num_pixels; ++i) {
+        float min_color_dist {std::numeric_limits<float>::max()};
+        int32_t best_cluster {0};
+
+        // Iterate over centroids to find centroid with most similar color to pixels[i]
+        for (int32_t j {0}; j < k; ++j) {
+            const float dist {PixelT::colorDistance(pixels[i], centroids[j])};
+            if (dist < min_color_dist) {
+                min_color_dist = dist;
+                best_cluster = j;
+            }
         }
-    }
 
-    // Step 2: Initialize centroids randomly
-
-    switch (color_space) {
-    case COLOR_SPACE_OPTION_RGB: {
-        kMeansPlusPlusInit<ImageLib::RGBAPixel<float>>(pixels, centroids, k);
-        break;
-    }
-    case COLOR_SPACE_OPTION_CIELAB: {
-        kMeansPlusPlusInit<ImageLib::LABAPixel<float>>(lab, centroids_lab, k);
-        break;
-    }
+        if (labels[i] != best_cluster) {
+            changed = true;
+            labels[i] = best_cluster;
+        }
     }
+    return changed;
+}
 
-    // Step 3: Run k-means iterations
+// Lloyd iterations starting from `centroids`. Returns true if the labels converged, in
+// which case they match the centroids; otherwise the centroids were updated once more
+// after the last assignment.
+template <typename PixelT>
+bool lloyd_iterations(
+    const ImageLib::Image<PixelT>& pixels, ImageLib::Image<PixelT>& centroids, int32_t* labels,
+    const int32_t k, const int32_t max_iter
+) {
+    const int32_t num_pixels {pixels.getSize()};
 
-    // Assignment step
     for (int32_t iter {0}; iter < max_iter; ++iter) {
-        bool changed {false};
-
-        // Iterate over pixels
-        for (int32_t i {0}; i < num_pixels; ++i) {
-            float min_color_dist {std::numeric_limits<float>::max()};
-            int32_t best_cluster {0};
-
-            // Iterate over centroids to find centroid with most similar color to
-            // pixels[i]
-            float dist;
-            for (int32_t j {0}; j < k; ++j) {
-                switch (color_space) {
-                case COLOR_SPACE_OPTION_RGB: {
-                    dist = ImageLib::RGBAPixel<float>::colorDistance(pixels[i], centroids[j]);
-                    break;
-                }
-                case COLOR_SPACE_OPTION_CIELAB: {
-                    dist = ImageLib::LABAPixel<float>::colorDistance(lab[i], centroids_lab[j]);
-                    break;
-                }
-                }
-                if (dist < min_color_dist) {
-                    min_color_dist = dist;
-                    best_cluster = j;
-                }
-            }
-
-            if (labels[i] != best_cluster) {
-                changed = true;
-                labels[i] = best_cluster;
-            }
-        }
-
         // Stop if no changes
-        if (!changed) {
-            break;
+        if (!assign_labels(pixels, centroids, labels, k)) {
+            return true;
         }
 
         // Update step
-        ImageLib::Image<ImageLib::RGBAPixel<float>> new_centroids(k, 1, 0);
-        ImageLib::Image<ImageLib::LABAPixel<float>> new_centroids_lab(k, 1, 0);
+        ImageLib::Image<PixelT> new_centroids(k, 1, 0);
         std::vector<int32_t> counts(k, 0);
 
         for (int32_t i = 0; i < num_pixels; ++i) {
             int32_t cluster = labels[i];
-            switch (color_space) {
-            case COLOR_SPACE_OPTION_RGB: {
-                new_centroids[cluster].red += pixels[i].red;
-                new_centroids[cluster].green += pixels[i].green;
-                new_centroids[cluster].blue += pixels[i].blue;
-                break;
-            }
-            case COLOR_SPACE_OPTION_CIELAB: {
-                new_centroids_lab[cluster].l += lab[i].l;
-                new_centroids_lab[cluster].a += lab[i].a;
-                new_centroids_lab[cluster].b += lab[i].b;
-                break;
-            }
-            }
+            add_color(new_centroids[cluster], pixels[i]);
             counts[cluster]++;
         }
 
@@ -197,31 +185,141 @@ void kmeans_cpu(
                to it. May be good idea to reinitialize these dead centroids.
                */
             if (counts[j] > 0) {
-                switch (color_space) {
-                case COLOR_SPACE_OPTION_RGB: {
-                    centroids[j].red = new_centroids[j].red / counts[j];
-                    centroids[j].green = new_centroids[j].green / counts[j];
-                    centroids[j].blue = new_centroids[j].blue / counts[j];
-                    break;
-                }
-                case COLOR_SPACE_OPTION_CIELAB: {
-                    centroids_lab[j].l = new_centroids_lab[j].l / counts[j];
-                    centroids_lab[j].a = new_centroids_lab[j].a / counts[j];
-                    centroids_lab[j].b = new_centroids_lab[j].b / counts[j];
-                    break;
-                }
-                }
+                set_mean(centroids[j], new_centroids[j], counts[j]);
             }
         }
     }
+    return false;
+}
 
-    if (color_space == COLOR_SPACE_OPTION_CIELAB) {
+// Box-average `pixels` by 2^levels per axis (edge blocks average fewer pixels)
+template <typename PixelT>
+void pyramid_level(
+    const ImageLib::Image<PixelT>& pixels, const int32_t levels, ImageLib::Image<PixelT>& out
+) {
+    const int width {pixels.getWidth()};
+    const int height {pixels.getHeight()};
+    const int factor {1 << levels};
+    const int out_width {(width + factor - 1) / factor};
+    const int out_height {(height + factor - 1) / factor};
+    out.resize(out_width, out_height);
+
+    std::vector<PixelT> sums(out_width);
+    std::vector<int32_t> counts(out_width);
+    for (int oy = 0; oy < out_height; ++oy) {
+        std::fill(sums.begin(), sums.end(), PixelT(0, 0, 0));
+        std::fill(counts.begin(), counts.end(), 0);
+        for (int y = oy * factor; y < std::min(height, (oy + 1) * factor); ++y) {
+            for (int x = 0; x < width; ++x) {
+                add_color(sums[x / factor], pixels(x, y));
+                ++counts[x / factor];
+            }
+        }
+        for (int ox = 0; ox < out_width; ++ox)
+            set_mean(out(ox, oy), sums[ox], counts[ox]);
+    }
+}
+
+/*
+K-means on `pixels`, leaving one cluster per pixel in `labels` and the centroids in
+`centroids`. With pyramid_levels > 0 the seeding and up to max_iter iterations run on a
+copy box-averaged by 2^pyramid_levels per axis; the coarse centroids then warm-start
+refine_iter full-resolution iterations and a final full-resolution assignment. Levels
+are dropped while the coarse copy would hold fewer than k pixels.
+*/
+template <typename PixelT>
+void cluster(
+    const ImageLib::Image<PixelT>& pixels, ImageLib::Image<PixelT>& centroids, int32_t* labels,
+    const int32_t k, const int32_t max_iter, int32_t pyramid_levels, const int32_t refine_iter,
+    ImageLib::Image<PixelT>& coarse, KMeansScratch& scratch
+) {
+    auto coarse_size = [&](int32_t levels) {
+        const int factor {1 << levels};
+        return static_cast<int64_t>((pixels.getWidth() + factor - 1) / factor) *
+               ((pixels.getHeight() + factor - 1) / factor);
+    };
+    pyramid_levels = std::clamp<int32_t>(pyramid_levels, 0, KMEANS_MAX_PYRAMID_LEVELS);
+    while (pyramid_levels > 0 && coarse_size(pyramid_levels) < k)
+        --pyramid_levels;
+
+    if (pyramid_levels == 0) {
+        kMeansPlusPlusInit<PixelT>(pixels, centroids, k, scratch.min_dist_sq);
+        lloyd_iterations(pixels, centroids, labels, k, max_iter);
+        return;
+    }
+
+    pyramid_level(pixels, pyramid_levels, coarse);
+    scratch.coarse_labels.assign(coarse.getSize(), 0);
+    kMeansPlusPlusInit<PixelT>(coarse, centroids, k, scratch.min_dist_sq);
+    lloyd_iterations(coarse, centroids, scratch.coarse_labels.data(), k, max_iter);
+
+    if (!lloyd_iterations(pixels, centroids, labels, k, std::max(0, refine_iter)))
+        assign_labels(pixels, centroids, labels, k);
+}
+
+void kmeans_lab_cpu(
+    const LabImage& lab, int32_t* out_labels, const int32_t k, const int32_t max_iter,
+    ImageLib::Image<ImageLib::RGBAPixel<float>>* out_centroids, KMeansScratch* scratch,
+    const int32_t pyramid_levels, const int32_t refine_iter
+) {
+    const int32_t num_pixels {lab.getSize()};
+    KMeansScratch local_scratch;
+    KMeansScratch& buffers {scratch ? *scratch : local_scratch};
+
+    ImageLib::Image<ImageLib::LABAPixel<float>> centroids_lab {k, 1};
+    std::fill(out_labels, out_labels + num_pixels, 0);
+
+    cluster(
+        lab, centroids_lab, out_labels, k, max_iter, pyramid_levels, refine_iter,
+        buffers.coarse_lab, buffers
+    );
+
+    // Only the centroids leave LAB
+    if (out_centroids) {
+        *out_centroids = ImageLib::Image<ImageLib::RGBAPixel<float>>(k, 1);
         for (int32_t i {0}; i < k; ++i) {
-            lab_to_rgb<float, float>(centroids_lab[i], centroids[i]);
+            lab_to_rgb<float, float>(centroids_lab[i], (*out_centroids)[i]);
+        }
+    }
+}
+
+void kmeans_cpu(
+    const uint8_t* data, uint8_t* out_data, int32_t* out_labels, const int32_t width,
+    const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space,
+    KMeansScratch& scratch, const int32_t pyramid_levels, const int32_t refine_iter
+) {
+    ImageLib::Image<ImageLib::RGBAPixel<float>>& pixels {scratch.pixels};
+    pixels.loadFromBuffer(data, width, height, ImageLib::RGBA_CONVERTER<float>);
+    const int32_t num_pixels {pixels.getSize()};
+
+    // width = k, height = 1
+    // k centroids, initialized to rgba(0,0,0,255)
+    // Init of each pixel is from default in Image constructor
+    ImageLib::Image<ImageLib::RGBAPixel<float>> centroids {k, 1};
+    // cluster indices are written straight into the caller's buffer
+    int32_t* labels {out_labels};
+    std::fill(labels, labels + num_pixels, 0);
+
+    if (color_space == COLOR_SPACE_OPTION_CIELAB) {
+        LabImage& lab {scratch.lab};
+        lab.resize(pixels.getWidth(), pixels.getHeight());
+        for (int i {0}; i < pixels.getSize(); ++i) {
+            rgb_to_lab<float, float>(pixels[i], lab[i]);
         }
+        kmeans_lab_cpu(
+            lab, labels, k, max_iter, &centroids, &scratch, pyramid_levels, refine_iter
+        );
+    } else {
+        cluster(
+            pixels, centroids, labels, k, max_iter, pyramid_levels, refine_iter,
+            scratch.coarse_pixels, scratch
+        );
     }
 
     // Write the final centroid values to each pixel in the cluster
+    // (skipped for labels-only callers, which pass out_data == nullptr)
+    if (!out_data)
+        return;
     for (int32_t i = 0; i < num_pixels; ++i) {
         const int32_t cluster = labels[i];
         out_data[i * 4 + 0] =
@@ -232,22 +330,48 @@ void kmeans_cpu(
             static_cast<uint8_t>(std::clamp(centroids[cluster].blue, 0.0f, 255.0f));
         out_data[i * 4 + 3] = 255;
     }
+}
 
-    // Write labels to out_labels
-    std::memcpy(out_labels, labels.data(), labels.size() * sizeof(int32_t));
+void kmeans_cpu(
+    const uint8_t* data, uint8_t* out_data, int32_t* out_labels, const int32_t width,
+    const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space,
+    const int32_t pyramid_levels, const int32_t refine_iter
+) {
+    KMeansScratch scratch;
+    kmeans_cpu(
+        data, out_data, out_labels, width, height, k, max_iter, color_space, scratch,
+        pyramid_levels, refine_iter
+    );
 }
 
 namespace img2num {
 void kmeans(
     const uint8_t* data, uint8_t* out_data, int32_t* out_labels, const int32_t width,
-    const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space
+    const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space,
+    const int32_t pyramid_levels, const int32_t refine_iter
 ) {
-    GPU::getClassInstance().init_gpu();
-
-    if (GPU::getClassInstance().is_initialized()) {
+    // the default auto policy of ImageToSvgConfig::execution
+    const ImageToSvgConfig::ExecutionConfig execution {};
+    const int64_t num_pixels {static_cast<int64_t>(width) * height};
+    if (kmeans_on_gpu(execution, true, num_pixels, k) &&
+        GPU::getClassInstance().ensure_initialized()) {
         kmeans_gpu(data, out_data, out_labels, width, height, k, max_iter, color_space);
     } else {
-        kmeans_cpu(data, out_data, out_labels, width, height, k, max_iter, color_space);
+        kmeans_cpu(
+            data, out_data, out_labels, width, height, k, max_iter, color_space, pyramid_levels,
+            refine_iter
+        );
     }
 }
+
+void kmeans_labels(
+    const uint8_t* data, int32_t* out_labels, const int32_t width, const int32_t height,
+    const int32_t k, const int32_t max_iter, const uint8_t color_space,
+    const int32_t pyramid_levels, const int32_t refine_iter
+) {
+    kmeans(
+        data, nullptr, out_labels, width, height, k, max_iter, color_space, pyramid_levels,
+        refine_iter
+    );
+}
 } // namespace img2num
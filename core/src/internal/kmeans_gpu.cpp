@@ -4,6 +4,7 @@
 #include "img2num.h"
 #include "internal/cielab.h"
 #include "internal/gpu.h"
+#include "internal/gpu_pipeline.h"
 #include "internal/Image.h"
 #include "internal/LABAPixel.h"
 #include "internal/PixelConverters.h"
@@ -20,19 +21,28 @@
 #include <limits>
 #include <numeric>
 #include <random>
-#include <type_traits> // Required for std::is_same_v
+#include <stdexcept>
 #include <vector>
 
 static constexpr uint8_t COLOR_SPACE_OPTION_CIELAB {0};
 static constexpr uint8_t COLOR_SPACE_OPTION_RGB {1};
 
+// Iterations submitted between reads of the changed-label counter. Each read is a 4-byte
+// async map that overlaps the next batch, so the GPU never idles waiting on the host.
+static constexpr int32_t KMEANS_GPU_CHECK_INTERVAL {8};
+
+// Cap on the assign/update workgroups; past it each workgroup loops over several 16x16
+// tiles. Bounds the partial-sums buffer to KMEANS_GPU_MAX_GROUPS * k * 16 bytes.
+static constexpr uint32_t KMEANS_GPU_MAX_GROUPS {4096};
+
 #ifdef _MSC_VER
 #pragma pack(push, 1)
 #endif
 struct Params {
     uint32_t numPoints;
     uint32_t numCentroids;
-    uint32_t pad[2];
+    uint32_t numGroups;
+    uint32_t pad;
 }
 #ifndef _MSC_VER
 __attribute__((packed))
@@ -42,30 +52,22 @@ __attribute__((packed))
 #pragma pack(pop)
 #endif
 
-#ifdef _MSC_VER
-#pragma pack(push, 1)
-#endif
-struct ClusterAccumulator {
-    int32_t sumR;
-    int32_t sumG;
-    int32_t sumB;
-    uint32_t count;
+// Workgroups the assign/update pass is dispatched with
+static uint32_t assign_groups(const int32_t width, const int32_t height) {
+    const uint32_t tiles {
+        static_cast<uint32_t>((width + 15) / 16) * static_cast<uint32_t>((height + 15) / 16)};
+    return std::min(tiles, KMEANS_GPU_MAX_GROUPS);
 }
-#ifndef _MSC_VER
-__attribute__((packed))
-#endif
-;
-#ifdef _MSC_VER
-#pragma pack(pop)
-#endif
 
+// Matches the Params uniform of seed_sum_shader.wgsl and seed_select_shader.wgsl
 #ifdef _MSC_VER
 #pragma pack(push, 1)
 #endif
-struct CentroidParams {
-    float r, g, b, a;
+struct SeedParams {
     uint32_t width;
-    uint32_t pad[3]; // Padding to align to 16 bytes
+    uint32_t height;
+    uint32_t tilesX;
+    uint32_t tilesY;
 }
 #ifndef _MSC_VER
 __attribute__((packed))
@@ -76,324 +78,171 @@ __attribute__((packed))
 #endif
 
 // The K-Means++ Initialization Function
-template <typename PixelT>
-void kMeansPlusPlusInitGpu(
-    const ImageLib::Image<PixelT>& pixels, ImageLib::Image<PixelT>& out_centroids, int k,
-    const uint8_t color_space
+// Seeds `centroidTexture` (k x 1) from a device-resident input texture without any
+// readback. The first centroid is a random pixel, copied texel-to-texel. Each further
+// round is three passes recorded into one command buffer:
+//  1. dist_shader lowers every pixel's squared distance to its nearest centroid
+//  2. seed_sum_shader sums those weights per 16x16 tile
+//  3. seed_select_shader (one workgroup) draws a pixel proportionally to its weight,
+//     using a random number generated here, and stores it as the next centroid
+static void kMeansPlusPlusInitGpu(
+    const wgpu::Texture& inputTexture, const uint32_t width, const uint32_t height, const int k,
+    const wgpu::Texture& centroidTexture
 ) {
     if (k <= 0)
         return;
 
-    size_t width = pixels.getWidth();
-    size_t height = pixels.getHeight();
-    size_t num_pixels = width * height;
+    const size_t num_pixels = static_cast<size_t>(width) * height;
+    const uint32_t tilesX = (width + 15) / 16;
+    const uint32_t tilesY = (height + 15) / 16;
+    const size_t num_rounds = static_cast<size_t>(k) - 1;
 
-    std::vector<PixelT> centroids;
+    // RNG Setup: the first pixel and one draw in [0, 1) per further round
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<size_t> dis(0, num_pixels - 1);
+    const size_t first_index = dis(gen);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<float> randoms(std::max<size_t>(num_rounds, 1));
+    for (float& r : randoms)
+        r = unit(gen);
 
     // --- WEBGPU SETUP START ---
-    // (Assuming 'device' and 'queue' are globally available or passed in)
-    // 1. Upload Image Texture
-    wgpu::TextureDescriptor texDesc = {};
-    texDesc.size = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
-    texDesc.format = wgpu::TextureFormat::RGBA32Float;
-    texDesc.usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::CopyDst;
-    texDesc.label = "inputTextureInit";
-    wgpu::Texture inputTexture = GPU::getClassInstance().get_device().CreateTexture(&texDesc);
-
-    // Upload pixel data (Normalization to 0.0-1.0 assumed)
-    std::vector<float> gpu_pixels;
-    gpu_pixels.reserve(num_pixels * 4);
-
-    for (int i = 0; i < num_pixels; i++) {
-        PixelT p = pixels[i];
-        if constexpr (std::is_same_v<PixelT, ImageLib::LABAPixel<float>>) {
-            gpu_pixels.push_back(p.l / 255.0f);
-            gpu_pixels.push_back(p.a / 255.0f);
-            gpu_pixels.push_back(p.b / 255.0f);
-            gpu_pixels.push_back(p.alpha / 255.0f);
-        } else {
-            gpu_pixels.push_back(p.red / 255.0f);
-            gpu_pixels.push_back(p.green / 255.0f);
-            gpu_pixels.push_back(p.blue / 255.0f);
-            gpu_pixels.push_back(p.alpha / 255.0f);
-        }
-    }
-
-    wgpu::TexelCopyTextureInfo texDst = {};
-    texDst.texture = inputTexture;
-    wgpu::TexelCopyBufferLayout texLayout = {};
-    texLayout.bytesPerRow = width * 16;
-    texLayout.rowsPerImage = height;
-    GPU::getClassInstance().get_queue().WriteTexture(
-        &texDst, gpu_pixels.data(), gpu_pixels.size() * 4, &texLayout, &texDesc.size
-    );
-
-    // 2. Create MinDist Buffer (Storage)
-    // Initialize with FLT_MAX so the first centroid overwrites everything
-    std::vector<float> initial_dists(num_pixels, std::numeric_limits<float>::max());
-
-    wgpu::BufferDescriptor distDesc = {};
-    distDesc.size = num_pixels * sizeof(float);
-    distDesc.usage =
-        wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopySrc | wgpu::BufferUsage::CopyDst;
-    wgpu::Buffer minDistBuffer = GPU::getClassInstance().get_device().CreateBuffer(&distDesc);
+    // 1. Storage: minimum distances (initialized by the first dist pass), tile sums, the
+    // random draws and the number of centroids chosen so far
+    const wgpu::BufferUsage storageUsage {wgpu::BufferUsage::Storage};
+    const wgpu::BufferUsage uploadUsage {wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst};
+    const uint64_t distSize {num_pixels * sizeof(float)};
+    const uint64_t tileSize {static_cast<uint64_t>(tilesX) * tilesY * sizeof(float)};
+    const uint64_t randomSize {randoms.size() * sizeof(float)};
+    wgpu::Buffer minDistBuffer = GPU::getClassInstance().acquireBuffer(distSize, storageUsage);
+    wgpu::Buffer tileSumBuffer = GPU::getClassInstance().acquireBuffer(tileSize, storageUsage);
+    wgpu::Buffer randomBuffer = GPU::getClassInstance().acquireBuffer(randomSize, uploadUsage);
+    wgpu::Buffer stateBuffer = GPU::getClassInstance().acquireBuffer(sizeof(uint32_t), uploadUsage);
     GPU::getClassInstance().get_queue().WriteBuffer(
-        minDistBuffer, 0, initial_dists.data(), distDesc.size
+        randomBuffer, 0, randoms.data(), randomSize
     );
-
-    // 3. Create Uniform Buffer (For passing new centroid color)
-
-    wgpu::BufferDescriptor uniDesc = {};
-    uniDesc.size = sizeof(CentroidParams);
-    uniDesc.usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst;
-    wgpu::Buffer paramBuffer = GPU::getClassInstance().get_device().CreateBuffer(&uniDesc);
-
-    // 4. Create Readback Buffer
-    wgpu::BufferDescriptor readDesc = {};
-    readDesc.size = num_pixels * sizeof(float);
-    readDesc.usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst;
-    wgpu::Buffer readBuffer = GPU::getClassInstance().get_device().CreateBuffer(&readDesc);
-
-    // 5. Compile Shader & Pipeline
-    wgpu::ComputePipeline pipeline =
-        GPU::getClassInstance().createPipeline("dist_shader", "updateDistShader");
-
-    // 6. Bind Group
-    wgpu::BindGroupEntry entries[3];
-    entries[0].binding = 0;
-    entries[0].textureView = inputTexture.CreateView();
-    entries[1].binding = 1;
-    entries[1].buffer = minDistBuffer;
-    entries[1].size = distDesc.size;
-    entries[2].binding = 2;
-    entries[2].buffer = paramBuffer;
-    entries[2].size = uniDesc.size;
-
-    wgpu::BindGroupDescriptor bgDesc = {};
-    bgDesc.layout = pipeline.GetBindGroupLayout(0);
-    bgDesc.entryCount = 3;
-    bgDesc.entries = entries;
-    wgpu::BindGroup bindGroup = GPU::getClassInstance().get_device().CreateBindGroup(&bgDesc);
+    const uint32_t chosen {1};
+    GPU::getClassInstance().get_queue().WriteBuffer(stateBuffer, 0, &chosen, sizeof(uint32_t));
+
+    // 2. Uniform: image and tile grid dimensions
+    const wgpu::BufferUsage uniformUsage {wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst};
+    wgpu::Buffer paramBuffer =
+        GPU::getClassInstance().acquireBuffer(sizeof(SeedParams), uniformUsage);
+    SeedParams params = {width, height, tilesX, tilesY};
+    GPU::getClassInstance().get_queue().WriteBuffer(paramBuffer, 0, &params, sizeof(SeedParams));
+
+    // 3. Bind Groups (pipelines compiled once, cached by the GPU singleton)
+    wgpu::BindGroupEntry distEntries[4];
+    distEntries[0].binding = 0;
+    distEntries[0].textureView = inputTexture.CreateView();
+    distEntries[1].binding = 1;
+    distEntries[1].buffer = minDistBuffer;
+    distEntries[1].size = distSize;
+    distEntries[2].binding = 2;
+    distEntries[2].textureView = centroidTexture.CreateView();
+    distEntries[3].binding = 3;
+    distEntries[3].buffer = stateBuffer;
+    distEntries[3].size = sizeof(uint32_t);
+
+    wgpu::BindGroupEntry sumEntries[3];
+    sumEntries[0].binding = 0;
+    sumEntries[0].buffer = minDistBuffer;
+    sumEntries[0].size = distSize;
+    sumEntries[1].binding = 1;
+    sumEntries[1].buffer = tileSumBuffer;
+    sumEntries[1].size = tileSize;
+    sumEntries[2].binding = 2;
+    sumEntries[2].buffer = paramBuffer;
+    sumEntries[2].size = sizeof(SeedParams);
+
+    wgpu::BindGroupEntry selectEntries[7];
+    selectEntries[0].binding = 0;
+    selectEntries[0].textureView = inputTexture.CreateView();
+    selectEntries[1].binding = 1;
+    selectEntries[1].buffer = minDistBuffer;
+    selectEntries[1].size = distSize;
+    selectEntries[2].binding = 2;
+    selectEntries[2].buffer = tileSumBuffer;
+    selectEntries[2].size = tileSize;
+    selectEntries[3].binding = 3;
+    selectEntries[3].buffer = randomBuffer;
+    selectEntries[3].size = randomSize;
+    selectEntries[4].binding = 4;
+    selectEntries[4].textureView = centroidTexture.CreateView();
+    selectEntries[5].binding = 5;
+    selectEntries[5].buffer = stateBuffer;
+    selectEntries[5].size = sizeof(uint32_t);
+    selectEntries[6].binding = 6;
+    selectEntries[6].buffer = paramBuffer;
+    selectEntries[6].size = sizeof(SeedParams);
+
+    const char* shaderIds[3] = {"dist_shader", "seed_sum_shader", "seed_select_shader"};
+    const wgpu::BindGroupEntry* entryLists[3] = {distEntries, sumEntries, selectEntries};
+    const size_t entryCounts[3] = {4, 3, 7};
+    wgpu::ComputePipeline pipelines[3];
+    wgpu::BindGroup bindGroups[3];
+    for (int p = 0; p < 3; ++p) {
+        pipelines[p] = GPU::getClassInstance().getPipeline(shaderIds[p]);
+        wgpu::BindGroupDescriptor bgDesc = {};
+        bgDesc.layout = GPU::getClassInstance().getBindGroupLayout(shaderIds[p]);
+        bgDesc.entryCount = entryCounts[p];
+        bgDesc.entries = entryLists[p];
+        bindGroups[p] = GPU::getClassInstance().get_device().CreateBindGroup(&bgDesc);
+    }
     // --- WEBGPU SETUP END ---
 
-    // RNG Setup
-    std::random_device rd;
-    std::mt19937 gen(rd());
-
     // --- Step 1: Choose the first centroid randomly ---
-    std::uniform_int_distribution<> dis(0, num_pixels - 1);
-    int first_index = dis(gen);
-    centroids.push_back(pixels[first_index]);
-
-    // --- Step 2 & 3: Repeat until we have k centroids ---
-    // static volatile bool done = false;
-    bool* done = new bool(false);
-
-    for (int i = 1; i < k; ++i) {
-        *done = false;
-        // A. Upload Current Centroid to GPU
-        PixelT c = centroids.back();
-        CentroidParams params;
-        if constexpr (std::is_same_v<PixelT, ImageLib::LABAPixel<float>>) {
-            params = CentroidParams {
-                c.l / 255.0f, c.a / 255.0f, c.b / 255.0f, 1.0f, static_cast<uint32_t>(width)};
-        } else {
-            params = CentroidParams {
-                c.red / 255.0f, c.green / 255.0f, c.blue / 255.0f, 1.0f,
-                static_cast<uint32_t>(width)};
-        }
-
-        GPU::getClassInstance().get_queue().WriteBuffer(
-            paramBuffer, 0, &params, sizeof(CentroidParams)
-        );
-
-        // B. Dispatch Shader (Updates min_dist buffer on GPU)
-        wgpu::CommandEncoder encoder = GPU::getClassInstance().get_device().CreateCommandEncoder();
-        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
-        pass.SetPipeline(pipeline);
-        pass.SetBindGroup(0, bindGroup);
-        pass.DispatchWorkgroups((width + 15) / 16, (height + 15) / 16, 1);
-        pass.End();
-
-        // C. Copy Result to ReadBuffer
-        encoder.CopyBufferToBuffer(minDistBuffer, 0, readBuffer, 0, readDesc.size);
-        wgpu::CommandBuffer commands = encoder.Finish();
-        GPU::getClassInstance().get_queue().Submit(1, &commands);
-
-        // D. Map and Read
-
-        readBuffer.MapAsync(
-            wgpu::MapMode::Read, 0, readDesc.size, wgpu::CallbackMode::AllowProcessEvents,
-            [](wgpu::MapAsyncStatus status, wgpu::StringView msg, void* userdata) {
-                bool* flag = static_cast<bool*>(userdata);
-                bool success = false;
-                if (status == wgpu::MapAsyncStatus::Success) {
-                    // std::cout << "Map success: " << msg.data << std::endl;
-                    success = true;
-                } else {
-                    // Handle error
-                    // std::cerr << "Map failed: " << msg.data << std::endl;
-                    success = false;
-                }
-                *flag = true;
-            },
-            (void*)done
-        );
-
-        // E. Wait for GPU
-        while (!*done) {
-            GPU::getClassInstance().get_instance().ProcessEvents();
-#if defined(__EMSCRIPTEN__)
-            emscripten_sleep(10);
-#endif
-        }
-
-        const float* dists = (const float*)readBuffer.GetConstMappedRange();
-        // --- CPU SIDE: Selection Logic ---
-        double sum_dist_sq = 0.0;
-
-        // 1. Sum (We have to iterate anyway for roulette, so sum here)
-        // Note: dists[] contains the SQUARED distance because shader calculated distSq
-        for (size_t j = 0; j < num_pixels; ++j) {
-            sum_dist_sq += dists[j];
-        }
-
-        // 2. Select
-        std::uniform_real_distribution<> dist_selector(0.0, sum_dist_sq);
-        double random_value = dist_selector(gen);
-        double current_sum = 0.0;
-        int selected_index = -1;
-
-        for (size_t j = 0; j < num_pixels; ++j) {
-            current_sum += dists[j];
-            if (current_sum >= random_value) {
-                selected_index = j;
-                break;
-            }
+    wgpu::CommandEncoder encoder = GPU::getClassInstance().get_device().CreateCommandEncoder();
+    const wgpu::Extent3D texel {1, 1, 1};
+    wgpu::TexelCopyTextureInfo src = {};
+    src.texture = inputTexture;
+    src.origin = {
+        static_cast<uint32_t>(first_index % width), static_cast<uint32_t>(first_index / width),
+        0};
+    wgpu::TexelCopyTextureInfo dst = {};
+    dst.texture = centroidTexture;
+    encoder.CopyTextureToTexture(&src, &dst, &texel);
+
+    // --- Step 2 & 3: Repeat until we have k centroids, all on the device ---
+    const uint32_t workgroups[3][2] = {{tilesX, tilesY}, {tilesX, tilesY}, {1, 1}};
+    for (size_t round = 0; round < num_rounds; ++round) {
+        for (int p = 0; p < 3; ++p) {
+            wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+            pass.SetPipeline(pipelines[p]);
+            pass.SetBindGroup(0, bindGroups[p]);
+            pass.DispatchWorkgroups(workgroups[p][0], workgroups[p][1], 1);
+            pass.End();
         }
-
-        if (selected_index == -1)
-            selected_index = num_pixels - 1;
-
-        // Add new centroid
-        centroids.push_back(pixels[selected_index]);
-        readBuffer.Unmap();
-#if defined(__EMSCRIPTEN__)
-        emscripten_sleep(10);
-#endif
     }
+    wgpu::CommandBuffer commands = encoder.Finish();
+    GPU::getClassInstance().get_queue().Submit(1, &commands);
 
-    std::copy(centroids.begin(), centroids.end(), out_centroids.begin());
-
-    // explicit clean up
-    if (inputTexture)
-        inputTexture.Destroy();
-    readBuffer.Destroy();
-    minDistBuffer.Destroy();
-    paramBuffer.Destroy();
-    delete done;
-
-#if defined(__EMSCRIPTEN__)
-    emscripten_sleep(50);
-#endif
+    // queue order keeps the recycled buffers safe for whoever acquires them next
+    GPU::getClassInstance().releaseBuffer(minDistBuffer, distSize, storageUsage);
+    GPU::getClassInstance().releaseBuffer(tileSumBuffer, tileSize, storageUsage);
+    GPU::getClassInstance().releaseBuffer(randomBuffer, randomSize, uploadUsage);
+    GPU::getClassInstance().releaseBuffer(stateBuffer, sizeof(uint32_t), uploadUsage);
+    GPU::getClassInstance().releaseBuffer(paramBuffer, sizeof(SeedParams), uniformUsage);
 }
 
 void setup(
-    ImageLib::Image<ImageLib::RGBAPixel<float>>& pixels,
-    ImageLib::Image<ImageLib::LABAPixel<float>>& lab,
-    ImageLib::Image<ImageLib::RGBAPixel<float>>& centroids,
-    ImageLib::Image<ImageLib::LABAPixel<float>>& centroids_lab, const int32_t width,
-    const int32_t height, const int32_t k, wgpu::Texture& inputTexture, wgpu::Texture& labelTexture,
-    wgpu::Texture& centroidTexture, wgpu::TextureDescriptor& labelDesc,
-    wgpu::TextureDescriptor& centroidDesc, wgpu::ComputePipeline& pipeline1,
-    wgpu::ComputePipeline& pipeline2, wgpu::BindGroup& bindGroup1, wgpu::BindGroup& bindGroup2,
-    const uint8_t color_space
+    const wgpu::Texture& inputTexture, const int32_t width, const int32_t height, const int32_t k,
+    wgpu::Texture& labelTexture, wgpu::Texture& centroidTexture,
+    wgpu::TextureDescriptor& labelDesc, wgpu::TextureDescriptor& centroidDesc,
+    wgpu::Buffer& paramBuffer, wgpu::Buffer& partialsBuffer, wgpu::Buffer& prevLabelsBuffer,
+    wgpu::Buffer& changedBuffer, wgpu::ComputePipeline& pipeline1,
+    wgpu::ComputePipeline& pipeline2, wgpu::BindGroup& bindGroup1, wgpu::BindGroup& bindGroup2
 ) {
-    int bytesPerPixel {16};
-    const int32_t num_pixels {pixels.getSize()};
-
-    wgpu::TextureDescriptor texDesc = {};
-    texDesc.size = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
-    texDesc.format = wgpu::TextureFormat::RGBA32Float;
-    texDesc.usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::CopyDst;
-    texDesc.label = "inputTexture";
-    inputTexture = GPU::getClassInstance().get_device().CreateTexture(&texDesc);
-
-    wgpu::TexelCopyTextureInfo dst = {};
-    dst.texture = inputTexture;
-    wgpu::TexelCopyBufferLayout layout = {};
-    layout.offset = 0;
-    layout.bytesPerRow = width * bytesPerPixel; // Tightly packed for upload
-    layout.rowsPerImage = height;
-
-    std::vector<float> pixels_;
-    for (int i = 0; i < num_pixels; i++) {
-        switch (color_space) {
-        case COLOR_SPACE_OPTION_RGB: {
-            auto p = pixels[i];
-            pixels_.push_back(p.red / 255.0f);
-            pixels_.push_back(p.green / 255.0f);
-            pixels_.push_back(p.blue / 255.0f);
-            pixels_.push_back(p.alpha / 255.0f);
-            break;
-        }
-        case COLOR_SPACE_OPTION_CIELAB: {
-            auto p = lab[i];
-            pixels_.push_back(p.l / 255.0f);
-            pixels_.push_back(p.a / 255.0f);
-            pixels_.push_back(p.b / 255.0f);
-            pixels_.push_back(p.alpha / 255.0f);
-            break;
-        }
-        }
-    }
+    const int32_t num_pixels {width * height};
 
-    GPU::getClassInstance().get_queue().WriteTexture(
-        &dst, pixels_.data(), pixels_.size() * sizeof(float), &layout, &texDesc.size
-    );
-
-    // centroids
+    // centroids (filled on the device by kMeansPlusPlusInitGpu)
     centroidDesc.size = {static_cast<uint32_t>(k), 1, 1};
     centroidDesc.format = wgpu::TextureFormat::RGBA32Float;
     centroidDesc.usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::StorageBinding |
                          wgpu::TextureUsage::CopyDst | wgpu::TextureUsage::CopySrc;
     centroidDesc.label = "centroidTexture";
-    centroidTexture = GPU::getClassInstance().get_device().CreateTexture(&centroidDesc);
-
-    wgpu::TexelCopyTextureInfo cdst = {};
-    cdst.texture = centroidTexture;
-    wgpu::TexelCopyBufferLayout clayout = {};
-    clayout.offset = 0;
-    clayout.bytesPerRow = k * bytesPerPixel; // Tightly packed for upload
-    clayout.rowsPerImage = 1;
-
-    std::vector<float> centroids_; // rgba
-    switch (color_space) {
-    case COLOR_SPACE_OPTION_RGB: {
-        for (int i = 0; i < k; i++) {
-            auto p = centroids[i];
-            centroids_.push_back(p.red / 255.0f);
-            centroids_.push_back(p.green / 255.0f);
-            centroids_.push_back(p.blue / 255.0f);
-            centroids_.push_back(p.alpha / 255.0f);
-        }
-        break;
-    }
-    case COLOR_SPACE_OPTION_CIELAB: {
-        for (int i = 0; i < k; i++) {
-            auto p = centroids_lab[i];
-            centroids_.push_back(p.l / 255.0f);
-            centroids_.push_back(p.a / 255.0f);
-            centroids_.push_back(p.b / 255.0f);
-            centroids_.push_back(p.alpha / 255.0f);
-        }
-        break;
-    }
-    }
-
-    GPU::getClassInstance().get_queue().WriteTexture(
-        &cdst, centroids_.data(), centroids_.size() * sizeof(float), &clayout, &centroidDesc.size
-    );
+    centroidTexture = GPU::getClassInstance().acquireTexture(centroidDesc);
 
     // labels
     labelDesc.size = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
@@ -401,35 +250,42 @@ void setup(
     labelDesc.usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::StorageBinding |
                       wgpu::TextureUsage::CopyDst | wgpu::TextureUsage::CopySrc;
     labelDesc.label = "labelTexture";
-    labelTexture = GPU::getClassInstance().get_device().CreateTexture(&labelDesc);
+    labelTexture = GPU::getClassInstance().acquireTexture(labelDesc);
 
     // params
-    Params params = {static_cast<uint32_t>(num_pixels), static_cast<uint32_t>(k)};
-    wgpu::BufferDescriptor bufDesc = {};
-    bufDesc.size = sizeof(Params);
-    bufDesc.usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst;
-    wgpu::Buffer paramBuffer = GPU::getClassInstance().get_device().CreateBuffer(&bufDesc);
+    const uint32_t num_groups {assign_groups(width, height)};
+    Params params = {static_cast<uint32_t>(num_pixels), static_cast<uint32_t>(k), num_groups, 0};
+    paramBuffer = GPU::getClassInstance().acquireBuffer(
+        sizeof(Params), wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst
+    );
     GPU::getClassInstance().get_queue().WriteBuffer(paramBuffer, 0, &params, sizeof(Params));
 
-    // centroid accumulator
-    std::vector<ClusterAccumulator> reset_centroids(k, {0, 0, 0, 0});
-    wgpu::BufferDescriptor accDesc = {};
-    accDesc.size = sizeof(ClusterAccumulator) * k;
-    accDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
-    wgpu::Buffer accBuffer = GPU::getClassInstance().get_device().CreateBuffer(&accDesc);
-    GPU::getClassInstance().get_queue().WriteBuffer(
-        accBuffer, 0, reset_centroids.data(), accDesc.size
-    );
+    // per-workgroup partial centroid sums (vec4<f32> per workgroup and cluster); fully
+    // rewritten by every assign/update pass, so never cleared
+    const uint64_t partialsSize {static_cast<uint64_t>(num_groups) * k * 4 * sizeof(float)};
+    partialsBuffer =
+        GPU::getClassInstance().acquireBuffer(partialsSize, wgpu::BufferUsage::Storage);
 
-    // shaders
-    pipeline1 =
-        GPU::getClassInstance().createPipeline("assign_update_shader", "assignUpdateShader");
-    pipeline2 = GPU::getClassInstance().createPipeline("resolve_shader", "resolveShader");
+    // convergence detection: previous labels (cleared to "none") and the changed counter
+    prevLabelsBuffer = GPU::getClassInstance().acquireBuffer(
+        sizeof(uint32_t) * num_pixels, wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst
+    );
+    const wgpu::BufferUsage changedUsage {
+        wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopySrc | wgpu::BufferUsage::CopyDst};
+    changedBuffer = GPU::getClassInstance().acquireBuffer(sizeof(uint32_t), changedUsage);
+    wgpu::CommandEncoder clearEncoder = GPU::getClassInstance().get_device().CreateCommandEncoder();
+    clearEncoder.ClearBuffer(prevLabelsBuffer, 0, sizeof(uint32_t) * num_pixels);
+    wgpu::CommandBuffer clearCommands = clearEncoder.Finish();
+    GPU::getClassInstance().get_queue().Submit(1, &clearCommands);
+
+    // shaders (compiled once, cached by the GPU singleton)
+    pipeline1 = GPU::getClassInstance().getPipeline("assign_update_shader");
+    pipeline2 = GPU::getClassInstance().getPipeline("resolve_shader");
 
     // binding groups
     wgpu::BindGroupDescriptor bindGroupDesc1 = {};
-    bindGroupDesc1.layout = pipeline1.GetBindGroupLayout(0);
-    wgpu::BindGroupEntry entries1[5]; // 4
+    bindGroupDesc1.layout = GPU::getClassInstance().getBindGroupLayout("assign_update_shader");
+    wgpu::BindGroupEntry entries1[7];
     // Entry 0: Input Texture View
     entries1[0].binding = 0;
     entries1[0].textureView = inputTexture.CreateView();
@@ -445,65 +301,49 @@ void setup(
     entries1[3].size = sizeof(Params);
 
     entries1[4].binding = 4;
-    entries1[4].buffer = accBuffer;
-    entries1[4].size = sizeof(ClusterAccumulator) * k;
+    entries1[4].buffer = partialsBuffer;
+    entries1[4].size = partialsSize;
 
-    bindGroupDesc1.entryCount = 5; // 4;
+    entries1[5].binding = 5;
+    entries1[5].buffer = prevLabelsBuffer;
+    entries1[5].size = sizeof(uint32_t) * num_pixels;
+
+    entries1[6].binding = 6;
+    entries1[6].buffer = changedBuffer;
+    entries1[6].size = sizeof(uint32_t);
+
+    bindGroupDesc1.entryCount = 7;
     bindGroupDesc1.entries = entries1;
     bindGroup1 = GPU::getClassInstance().get_device().CreateBindGroup(&bindGroupDesc1);
 
     wgpu::BindGroupDescriptor bindGroupDesc2 = {};
-    bindGroupDesc2.layout = pipeline2.GetBindGroupLayout(0);
-    wgpu::BindGroupEntry entries2[2];
+    bindGroupDesc2.layout = GPU::getClassInstance().getBindGroupLayout("resolve_shader");
+    wgpu::BindGroupEntry entries2[3];
     entries2[0].binding = 0;
-    entries2[0].buffer = accBuffer;
-    entries2[0].size = accDesc.size;
+    entries2[0].buffer = partialsBuffer;
+    entries2[0].size = partialsSize;
     entries2[1].binding = 1;
     entries2[1].textureView = centroidTexture.CreateView();
-    bindGroupDesc2.entryCount = 2;
+    entries2[2].binding = 2;
+    entries2[2].buffer = paramBuffer;
+    entries2[2].size = sizeof(Params);
+    bindGroupDesc2.entryCount = 3;
     bindGroupDesc2.entries = entries2;
     bindGroup2 = GPU::getClassInstance().get_device().CreateBindGroup(&bindGroupDesc2);
 }
 
-void kmeans_gpu(
-    const uint8_t* data, uint8_t* out_data, int32_t* out_labels, const int32_t width,
-    const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space
-) {
-    ImageLib::Image<ImageLib::RGBAPixel<float>> pixels;
-    pixels.loadFromBuffer(data, width, height, ImageLib::RGBA_CONVERTER<float>);
-    const int32_t num_pixels {pixels.getSize()};
-
-    // width = k, height = 1
-    // k centroids, initialized to rgba(0,0,0,255)
-    // Init of each pixel is from default in Image constructor
-    ImageLib::Image<ImageLib::RGBAPixel<float>> centroids {k, 1};
-    ImageLib::Image<ImageLib::LABAPixel<float>> centroids_lab {k, 1};
-    std::vector<int32_t> labels(num_pixels, -1);
-
-    ImageLib::Image<ImageLib::LABAPixel<float>> lab(pixels.getWidth(), pixels.getHeight());
-
-    if (color_space == COLOR_SPACE_OPTION_CIELAB) {
-        for (int i {0}; i < pixels.getSize(); ++i) {
-            rgb_to_lab<float, float>(pixels[i], lab[i]);
-        }
-    }
-
-    std::cout << "starting" << std::endl;
-    // Step 2: Initialize centroids
-
-    switch (color_space) {
-    case COLOR_SPACE_OPTION_RGB: {
-        kMeansPlusPlusInitGpu<ImageLib::RGBAPixel<float>>(pixels, centroids, k, color_space);
-        break;
-    }
-    case COLOR_SPACE_OPTION_CIELAB: {
-        kMeansPlusPlusInitGpu<ImageLib::LABAPixel<float>>(lab, centroids_lab, k, color_space);
-        break;
-    }
-    }
-    std::cout << "kmeans++ init done" << std::endl;
-    // Step 3: Run k-means iterations
+// Seeding, iterations and readback on a device-resident RGBA32Float input. The labels
+// and the k centroids (4 floats each, on the input's scale) are the only data read back.
+// The shaders hold at most KMEANS_GPU_MAX_K clusters per workgroup
+static void check_gpu_k(const int32_t k) {
+    if (k < 1 || k > KMEANS_GPU_MAX_K)
+        throw std::invalid_argument("kmeans_gpu: k must be between 1 and 64");
+}
 
+static void kmeans_on_device(
+    const wgpu::Texture& inputTexture, const int32_t width, const int32_t height,
+    const int32_t k, const int32_t max_iter, int32_t* out_labels, std::vector<float>& out_centroids
+) {
     int bytesPerPixel {16}; // float pixels
 
     // shaders - 2 pipelines:
@@ -513,21 +353,33 @@ void kmeans_gpu(
     wgpu::ComputePipeline pipeline2;
     wgpu::BindGroup bindGroup1;
     wgpu::BindGroup bindGroup2;
-    wgpu::Texture inputTexture;
     wgpu::Texture labelTexture;
     wgpu::Texture centroidTexture;
     wgpu::TextureDescriptor labelDesc = {};
     wgpu::TextureDescriptor centroidDesc = {};
+    wgpu::Buffer paramBuffer;
+    wgpu::Buffer partialsBuffer;
+    wgpu::Buffer prevLabelsBuffer;
+    wgpu::Buffer changedBuffer;
 
     // setup all textures and buffers needed for the kmeans loop on gpu
     setup(
-        pixels, lab, centroids, centroids_lab, width, height, k, inputTexture, labelTexture,
-        centroidTexture, labelDesc, centroidDesc, pipeline1, pipeline2, bindGroup1, bindGroup2,
-        color_space
+        inputTexture, width, height, k, labelTexture, centroidTexture, labelDesc, centroidDesc,
+        paramBuffer, partialsBuffer, prevLabelsBuffer, changedBuffer, pipeline1, pipeline2,
+        bindGroup1, bindGroup2
     );
 
-    uint32_t wgX = (width + 15) / 16;
-    uint32_t wgY = (height + 15) / 16;
+    // Step 2: Initialize centroids
+    kMeansPlusPlusInitGpu(
+        inputTexture, static_cast<uint32_t>(width), static_cast<uint32_t>(height), k,
+        centroidTexture
+    );
+    std::cout << "kmeans++ init done" << std::endl;
+
+    // Step 3: Run k-means iterations
+    // assign/update: a 1D grid of workgroups striding over the 16x16 tiles;
+    // resolve: one workgroup per cluster
+    const uint32_t num_groups {assign_groups(width, height)};
 
     // Label Readback RGBA32Uint is 16 bytes/ pixel
     uint32_t bytesPerRowLabels =
@@ -536,35 +388,92 @@ void kmeans_gpu(
     readLabelsDesc.size = bytesPerRowLabels * height;
     readLabelsDesc.usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst;
     wgpu::Buffer readLabelsBuffer =
-        GPU::getClassInstance().get_device().CreateBuffer(&readLabelsDesc);
+        GPU::getClassInstance().acquireBuffer(readLabelsDesc.size, readLabelsDesc.usage);
 
     // Centroid Readback
     uint32_t bytesPerRowCentroids =
-        GPU::getAlignedBytesPerRow(width, static_cast<uint32_t>(bytesPerPixel));
+        GPU::getAlignedBytesPerRow(k, static_cast<uint32_t>(bytesPerPixel));
     wgpu::BufferDescriptor readCentroidsDesc = {};
     readCentroidsDesc.size = bytesPerRowCentroids; // Height is 1
     readCentroidsDesc.usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst;
     wgpu::Buffer readCentroidsBuffer =
-        GPU::getClassInstance().get_device().CreateBuffer(&readCentroidsDesc);
+        GPU::getClassInstance().acquireBuffer(readCentroidsDesc.size, readCentroidsDesc.usage);
+
+    // Changed-counter readback, double-buffered so one batch can be in flight while the
+    // previous batch's count is mapped
+    const wgpu::BufferUsage readChangedUsage {
+        wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst};
+    wgpu::Buffer readChanged[2] = {
+        GPU::getClassInstance().acquireBuffer(sizeof(uint32_t), readChangedUsage),
+        GPU::getClassInstance().acquireBuffer(sizeof(uint32_t), readChangedUsage)};
+    wgpu::Future changedFuture[2];
+    bool changedMapped[2] = {false, false};
+    bool changedPending[2] = {false, false};
+
+    // A count that cannot be read is treated as "still changing"
+    auto wait_changed = [&](const int slot) {
+        GPU::getClassInstance().wait(changedFuture[slot]);
+        changedPending[slot] = false;
+        if (!changedMapped[slot])
+            return UINT32_MAX;
+        uint32_t count = 0;
+        std::memcpy(
+            &count, readChanged[slot].GetConstMappedRange(0, sizeof(uint32_t)), sizeof(uint32_t)
+        );
+        readChanged[slot].Unmap();
+        return count;
+    };
 
-    // This is the actual KMeans loop
+    // This is the actual KMeans loop. Iterations are submitted in batches; the last
+    // iteration of each batch counts changed labels, and the loop stops once a count
+    // comes back as zero (at most one extra batch runs, and it changes nothing).
     std::cout << "start iterations" << std::endl;
-    wgpu::CommandEncoder encoder = GPU::getClassInstance().get_device().CreateCommandEncoder();
-    for (int32_t iter {0}; iter < max_iter; ++iter) {
-        wgpu::ComputePassEncoder pass1 = encoder.BeginComputePass();
-        pass1.SetPipeline(pipeline1);
-        pass1.SetBindGroup(0, bindGroup1);
-        pass1.DispatchWorkgroups(wgX, wgY);
-        pass1.End();
-
-        wgpu::ComputePassEncoder pass2 = encoder.BeginComputePass();
-        pass2.SetPipeline(pipeline2);
-        pass2.SetBindGroup(0, bindGroup2);
-        pass2.DispatchWorkgroups((k + 255) / 256, 1);
-        pass2.End();
+    bool converged {false};
+    int slot {0};
+    for (int32_t iter {0}; iter < max_iter && !converged;) {
+        const int32_t batch {std::min(KMEANS_GPU_CHECK_INTERVAL, max_iter - iter)};
+        wgpu::CommandEncoder encoder = GPU::getClassInstance().get_device().CreateCommandEncoder();
+        for (int32_t i {0}; i < batch; ++i) {
+            if (i == batch - 1)
+                encoder.ClearBuffer(changedBuffer, 0, sizeof(uint32_t));
+
+            wgpu::ComputePassEncoder pass1 = encoder.BeginComputePass();
+            pass1.SetPipeline(pipeline1);
+            pass1.SetBindGroup(0, bindGroup1);
+            pass1.DispatchWorkgroups(num_groups, 1);
+            pass1.End();
+
+            wgpu::ComputePassEncoder pass2 = encoder.BeginComputePass();
+            pass2.SetPipeline(pipeline2);
+            pass2.SetBindGroup(0, bindGroup2);
+            pass2.DispatchWorkgroups(k, 1);
+            pass2.End();
+        }
+        iter += batch;
+        encoder.CopyBufferToBuffer(changedBuffer, 0, readChanged[slot], 0, sizeof(uint32_t));
+        wgpu::CommandBuffer commands = encoder.Finish();
+        GPU::getClassInstance().get_queue().Submit(1, &commands);
+
+        changedPending[slot] = true;
+        changedFuture[slot] = readChanged[slot].MapAsync(
+            wgpu::MapMode::Read, 0, sizeof(uint32_t), wgpu::CallbackMode::WaitAnyOnly,
+            [&changedMapped, slot](wgpu::MapAsyncStatus status, wgpu::StringView) {
+                changedMapped[slot] = status == wgpu::MapAsyncStatus::Success;
+            }
+        );
+
+        // read the previous batch's count while this one runs
+        slot = 1 - slot;
+        if (changedPending[slot])
+            converged = wait_changed(slot) == 0;
+    }
+    for (int i = 0; i < 2; ++i) {
+        if (changedPending[i])
+            wait_changed(i);
     }
 
     // 3. Readback (After Loop Finishes)
+    wgpu::CommandEncoder encoder = GPU::getClassInstance().get_device().CreateCommandEncoder();
 
     // Copy Labels
     wgpu::TexelCopyTextureInfo srcLabels = {};
@@ -588,81 +497,154 @@ void kmeans_gpu(
     GPU::getClassInstance().get_queue().Submit(1, &commands);
     std::cout << "done iterations" << std::endl;
 
-    // 4. Map Async & Wait
-    bool* done1 = new bool(false);
-    bool* done2 = new bool(false);
-
-    // Map Labels
-    readLabelsBuffer.MapAsync(
-        wgpu::MapMode::Read, 0, readLabelsDesc.size, wgpu::CallbackMode::AllowProcessEvents,
-        [](wgpu::MapAsyncStatus status, wgpu::StringView msg, void* userdata) {
-            bool* flag = static_cast<bool*>(userdata);
-            bool success = false;
-            if (status == wgpu::MapAsyncStatus::Success) {
-                // std::cout << "Map success" << std::endl;
-                success = true;
-            }
-            *flag = true;
-        },
-        (void*)done1
+    // 4. Map both readbacks and wait for them together (GPU::wait does not spin)
+    bool labelsMapped {false};
+    bool centroidsMapped {false};
+    wgpu::Future labelsFuture = readLabelsBuffer.MapAsync(
+        wgpu::MapMode::Read, 0, readLabelsDesc.size, wgpu::CallbackMode::WaitAnyOnly,
+        [&labelsMapped](wgpu::MapAsyncStatus status, wgpu::StringView) {
+            labelsMapped = status == wgpu::MapAsyncStatus::Success;
+        }
+    );
+    wgpu::Future centroidsFuture = readCentroidsBuffer.MapAsync(
+        wgpu::MapMode::Read, 0, readCentroidsDesc.size, wgpu::CallbackMode::WaitAnyOnly,
+        [&centroidsMapped](wgpu::MapAsyncStatus status, wgpu::StringView) {
+            centroidsMapped = status == wgpu::MapAsyncStatus::Success;
+        }
     );
 
     std::cout << "read out" << std::endl;
-
-    while (!*done1) {
-        GPU::getClassInstance().get_instance().ProcessEvents();
-#if defined(__EMSCRIPTEN__)
-        emscripten_sleep(10);
-#endif
+    GPU::getClassInstance().wait(labelsFuture);
+    GPU::getClassInstance().wait(centroidsFuture);
+
+    if (labelsMapped) {
+        std::cout << "mapping labels" << std::endl;
+        const uint8_t* mappedData =
+            (const uint8_t*)readLabelsBuffer.GetConstMappedRange(0, readLabelsDesc.size);
+        // Copy row by row to remove padding and put data into 'out_labels'
+        for (size_t y = 0; y < height; ++y) {
+            const uint8_t* rowPtr = mappedData + (y * bytesPerRowLabels);
+            for (size_t x = 0; x < width; ++x) {
+                const uint8_t* pixelPtr = rowPtr + (x * bytesPerPixel);
+                uint32_t r = 0;
+                std::memcpy(&r, pixelPtr, sizeof(uint32_t));
+
+                size_t dstIndex = y * width + x;
+                out_labels[dstIndex] = static_cast<int32_t>(r);
+            }
+        }
+        readLabelsBuffer.Unmap();
     }
 
-    std::cout << "mapping labels" << std::endl;
-    const uint8_t* mappedData = (const uint8_t*)readLabelsBuffer.GetConstMappedRange();
-    // ... Copy data to your C++ vector ...
-    // Copy row by row to remove padding and put data into 'result'
-    for (size_t y = 0; y < height; ++y) {
-        const uint8_t* rowPtr = mappedData + (y * bytesPerRowLabels);
-        for (size_t x = 0; x < width; ++x) {
-            const uint8_t* pixelPtr = rowPtr + (x * bytesPerPixel);
-            uint32_t r = 0;
-            std::memcpy(&r, pixelPtr, sizeof(uint32_t));
-
-            size_t dstIndex = y * width + x;
-            labels[dstIndex] = static_cast<int32_t>(r);
-        }
+    if (centroidsMapped) {
+        std::cout << "mapping centroids" << std::endl;
+        const float* mappedDataFloat =
+            (const float*)readCentroidsBuffer.GetConstMappedRange(0, readCentroidsDesc.size);
+        out_centroids.assign(mappedDataFloat, mappedDataFloat + static_cast<size_t>(k) * 4);
+        readCentroidsBuffer.Unmap();
     }
 
-    readLabelsBuffer.Unmap();
-
-    // Map Centroids
-    readCentroidsBuffer.MapAsync(
-        wgpu::MapMode::Read, 0, readCentroidsDesc.size, wgpu::CallbackMode::AllowProcessEvents,
-        [](wgpu::MapAsyncStatus status, wgpu::StringView msg, void* userdata) {
-            bool* flag = static_cast<bool*>(userdata);
-            bool success = false;
-            if (status == wgpu::MapAsyncStatus::Success) {
-                // std::cout << "Map success" << std::endl;
-                success = true;
-            }
-            *flag = true; // Signal completion
-        },
-        (void*)done2
+    // hand everything back to the GPU pool for the next call
+    GPU::getClassInstance().releaseTexture(labelTexture, labelDesc);
+    GPU::getClassInstance().releaseTexture(centroidTexture, centroidDesc);
+    GPU::getClassInstance().releaseBuffer(
+        paramBuffer, sizeof(Params), wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst
+    );
+    GPU::getClassInstance().releaseBuffer(
+        partialsBuffer, static_cast<uint64_t>(num_groups) * k * 4 * sizeof(float),
+        wgpu::BufferUsage::Storage
+    );
+    GPU::getClassInstance().releaseBuffer(
+        readLabelsBuffer, readLabelsDesc.size, readLabelsDesc.usage
     );
+    GPU::getClassInstance().releaseBuffer(
+        readCentroidsBuffer, readCentroidsDesc.size, readCentroidsDesc.usage
+    );
+    GPU::getClassInstance().releaseBuffer(
+        prevLabelsBuffer, sizeof(uint32_t) * width * height,
+        wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst
+    );
+    GPU::getClassInstance().releaseBuffer(
+        changedBuffer, sizeof(uint32_t),
+        wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopySrc | wgpu::BufferUsage::CopyDst
+    );
+    for (int i = 0; i < 2; ++i) {
+        GPU::getClassInstance().releaseBuffer(readChanged[i], sizeof(uint32_t), readChangedUsage);
+    }
+    if (!labelsMapped || !centroidsMapped)
+        throw std::runtime_error("kmeans_gpu: could not read the results back from the GPU");
+}
 
-    while (!*done2) {
-        GPU::getClassInstance().get_instance().ProcessEvents();
-#if defined(__EMSCRIPTEN__)
-        emscripten_sleep(10);
-#endif
+void kmeans_gpu(
+    const uint8_t* data, uint8_t* out_data, int32_t* out_labels, const int32_t width,
+    const int32_t height, const int32_t k, const int32_t max_iter, const uint8_t color_space
+) {
+    check_gpu_k(k);
+    // one stage on the device at a time (see GPU::lock_device)
+    auto device_lock {GPU::getClassInstance().lock_device()};
+
+    ImageLib::Image<ImageLib::RGBAPixel<float>> pixels;
+    pixels.loadFromBuffer(data, width, height, ImageLib::RGBA_CONVERTER<float>);
+    const int32_t num_pixels {pixels.getSize()};
+
+    // width = k, height = 1
+    // k centroids, initialized to rgba(0,0,0,255)
+    // Init of each pixel is from default in Image constructor
+    ImageLib::Image<ImageLib::RGBAPixel<float>> centroids {k, 1};
+
+    std::cout << "starting" << std::endl;
+    // Step 1: Upload the pixels to cluster, scaled to 0-1 (CIELAB divided by 255)
+    std::vector<float> pixels_;
+    pixels_.reserve(static_cast<size_t>(num_pixels) * 4);
+    for (int i = 0; i < num_pixels; i++) {
+        switch (color_space) {
+        case COLOR_SPACE_OPTION_RGB: {
+            auto p = pixels[i];
+            pixels_.push_back(p.red / 255.0f);
+            pixels_.push_back(p.green / 255.0f);
+            pixels_.push_back(p.blue / 255.0f);
+            pixels_.push_back(p.alpha / 255.0f);
+            break;
+        }
+        case COLOR_SPACE_OPTION_CIELAB: {
+            ImageLib::LABAPixel<float> p;
+            rgb_to_lab<float, float>(pixels[i], p);
+            pixels_.push_back(p.l / 255.0f);
+            pixels_.push_back(p.a / 255.0f);
+            pixels_.push_back(p.b / 255.0f);
+            pixels_.push_back(p.alpha / 255.0f);
+            break;
+        }
+        }
     }
 
-    std::cout << "mapping centroids" << std::endl;
-    const float* mappedDataFloat = (const float*)readCentroidsBuffer.GetConstMappedRange();
-    // ... Copy data to your C++ vector ...
+    int bytesPerPixel {16};
+    wgpu::TextureDescriptor texDesc = {};
+    texDesc.size = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+    texDesc.format = wgpu::TextureFormat::RGBA32Float;
+    texDesc.usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::CopyDst |
+                    wgpu::TextureUsage::CopySrc;
+    texDesc.label = "inputTexture";
+    wgpu::Texture inputTexture = GPU::getClassInstance().acquireTexture(texDesc);
+
+    wgpu::TexelCopyTextureInfo dst = {};
+    dst.texture = inputTexture;
+    wgpu::TexelCopyBufferLayout layout = {};
+    layout.offset = 0;
+    layout.bytesPerRow = width * bytesPerPixel; // Tightly packed for upload
+    layout.rowsPerImage = height;
+    GPU::getClassInstance().get_queue().WriteTexture(
+        &dst, pixels_.data(), pixels_.size() * sizeof(float), &layout, &texDesc.size
+    );
+
+    // Step 2 & 3: seed, iterate and read back on the device
+    std::vector<float> centroid_values;
+    kmeans_on_device(inputTexture, width, height, k, max_iter, out_labels, centroid_values);
+    GPU::getClassInstance().releaseTexture(inputTexture, texDesc);
 
     for (int i = 0; i < k; i++) {
         // if CIELAB color space these represent l, a, b, alpha
-        const float* centroidPtr = mappedDataFloat + (i * 4);
+        const float* centroidPtr = centroid_values.data() + (i * 4);
 
         float r = *(centroidPtr);
         float g = *(centroidPtr + 1);
@@ -674,47 +656,39 @@ void kmeans_gpu(
             break;
         }
         case COLOR_SPACE_OPTION_CIELAB: {
-            centroids_lab[i] =
-                ImageLib::LABAPixel<float>(r * 255.f, g * 255.f, b * 255.f, a * 255.f);
+            // Write the final centroid values to each pixel in the cluster
+            lab_to_rgb<float, float>(
+                ImageLib::LABAPixel<float>(r * 255.f, g * 255.f, b * 255.f, a * 255.f),
+                centroids[i]
+            );
             break;
         }
         }
     }
 
-    readCentroidsBuffer.Unmap();
-
-    // Write the final centroid values to each pixel in the cluster
-    if (color_space == COLOR_SPACE_OPTION_CIELAB) {
-        for (int32_t i {0}; i < k; ++i) {
-            lab_to_rgb<float, float>(centroids_lab[i], centroids[i]);
-        }
-    }
-
-    for (int32_t i = 0; i < num_pixels; ++i) {
-        const int32_t cluster = labels[i];
+    // out_data is optional (labels-only callers pass nullptr)
+    for (int32_t i = 0; out_data && i < num_pixels; ++i) {
+        const int32_t cluster = out_labels[i];
         out_data[i * 4 + 0] = static_cast<uint8_t>(centroids[cluster].red);
         out_data[i * 4 + 1] = static_cast<uint8_t>(centroids[cluster].green);
         out_data[i * 4 + 2] = static_cast<uint8_t>(centroids[cluster].blue);
         out_data[i * 4 + 3] = 255;
     }
+#if defined(__EMSCRIPTEN__)
+    emscripten_sleep(50);
+#endif
+}
+
+void kmeans_gpu_resident(
+    const wgpu::Texture& input, const int32_t width, const int32_t height, int32_t* out_labels,
+    const int32_t k, const int32_t max_iter
+) {
+    check_gpu_k(k);
+    // one stage on the device at a time (see GPU::lock_device)
+    auto device_lock {GPU::getClassInstance().lock_device()};
 
-    // Write labels to out_labels
-    std::cout << "copying labels out" << std::endl;
-    std::memcpy(out_labels, labels.data(), labels.size() * sizeof(int32_t));
-
-    if (inputTexture)
-        inputTexture.Destroy();
-    if (labelTexture)
-        labelTexture.Destroy();
-    if (centroidTexture)
-        centroidTexture.Destroy();
-    readLabelsBuffer.Destroy();
-    readCentroidsBuffer.Destroy();
-    delete done1;
-    delete done2;
-
-    labels.clear();
-    labels.shrink_to_fit();
+    std::vector<float> centroid_values;
+    kmeans_on_device(input, width, height, k, max_iter, out_labels, centroid_values);
 #if defined(__EMSCRIPTEN__)
     emscripten_sleep(50);
 #endif
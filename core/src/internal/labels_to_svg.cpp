@@ -1,8 +1,13 @@
 #include "img2num.h"
 #include "internal/bezier.h"
 #include "internal/contours.h"
+#include "internal/deflate.h"
 #include "internal/graph.h"
+#include "internal/pixel_format.h"
+#include "internal/vectorization.h"
+#include "internal/workspace.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
@@ -13,17 +18,21 @@
 #include <limits>
 #include <map>
 #include <memory>
+#include <ostream>
 #include <queue>
 #include <random>
 #include <set>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 /* Flood fill */
 int flood_fill(
-    std::vector<int32_t>& label_array, std::vector<int32_t>& region_array,
-    const uint8_t* color_array, int x, int y, int target_value, int label_value, size_t width,
-    size_t height, std::unique_ptr<std::vector<RGBXY>>& out_pixels
+    const int32_t* label_array, std::vector<int32_t>& region_array,
+    const img2num::ImageView& color_image, int x, int y, int target_value, int label_value,
+    size_t width, size_t height, std::unique_ptr<std::vector<RGBXY>>& out_pixels
 ) {
     std::queue<XY> queue;
     auto index = [width](int x, int y) {
@@ -33,9 +42,9 @@ int flood_fill(
     int count = 0;
     int dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
 
-    RGBXY pix = RGBXY {
-        color_array[4 * size_t(index(x, y))], color_array[4 * size_t(index(x, y)) + 1],
-        color_array[4 * size_t(index(x, y)) + 2], x, y};
+    uint8_t r {0}, g {0}, b {0};
+    img2num::pixel_rgb(color_image, x, y, r, g, b);
+    RGBXY pix = RGBXY {r, g, b, x, y};
 
     queue.push({x, y});
 
@@ -55,10 +64,8 @@ int flood_fill(
             if ((x1 >= 0) && (x1 < int(width)) && (y1 >= 0) && (y1 < int(height)) &&
                 (label_array[size_t(index(x1, y1))] == target_value) &&
                 (region_array[size_t(index(x1, y1))] == -1)) {
-                RGBXY pix1 = RGBXY {
-                    color_array[4 * size_t(index(x1, y1))],
-                    color_array[4 * size_t(index(x1, y1)) + 1],
-                    color_array[4 * size_t(index(x1, y1)) + 2], x1, y1};
+                img2num::pixel_rgb(color_image, x1, y1, r, g, b);
+                RGBXY pix1 = RGBXY {r, g, b, x1, y1};
                 region_array[size_t(index(x1, y1))] = label_value;
                 out_pixels->push_back(pix1);
                 count++;
@@ -72,14 +79,14 @@ int flood_fill(
 }
 
 void region_labeling(
-    const uint8_t* data, std::vector<int32_t>& labels, std::vector<int32_t>& regions, int width,
+    const img2num::ImageView& image, const int32_t* labels, std::vector<int32_t>& regions, int width,
     int height, std::vector<Node_ptr>& nodes
 ) {
     auto index = [width](int x, int y) {
         return y * width + x;
     };
 
-    regions.resize(static_cast<size_t>(height) * static_cast<size_t>(width), -1);
+    regions.assign(static_cast<size_t>(height) * static_cast<size_t>(width), -1);
     int r_lbl = -1;
 
     for (int i = 0; i < width; i++) {
@@ -93,7 +100,7 @@ void region_labeling(
                 // std::vector<RGBXY> pixels;
                 std::unique_ptr<std::vector<RGBXY>> p_ptr = std::make_unique<std::vector<RGBXY>>();
                 int counts =
-                    flood_fill(labels, regions, data, i, j, label, r_lbl, width, height, p_ptr);
+                    flood_fill(labels, regions, image, i, j, label, r_lbl, width, height, p_ptr);
                 int num_pixels = p_ptr->size();
 
                 // num_pixels == counts always
@@ -169,100 +176,636 @@ std::string contourToSVGCurve(const std::vector<QuadBezier>& curves) {
     return path.str();
 }
 
-std::string contoursResultToSVG(const ColoredContours& result, const int width, const int height) {
-    std::ostringstream svg;
+/*
+Compact encoding helpers.
+Coordinates are snapped to a grid of `grid` pixels and handled as integer grid
+units, so relative offsets never accumulate rounding drift.
+*/
+static constexpr int SVG_ENCODING_STANDARD {0};
+static constexpr int SVG_ENCODING_COMPACT {1};
+static constexpr int MAX_GRID_DECIMALS {4};
+
+struct GridXY {
+    int64_t x, y;
+};
+
+inline GridXY snap(const Point& p, double grid) {
+    return {std::llround(p.x / grid), std::llround(p.y / grid)};
+}
+
+// Shortest decimal spelling of `units * grid` ("0.5" -> ".5", "-0.5" -> "-.5")
+std::string compactNumber(int64_t units, double grid, int decimals) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(decimals) << static_cast<double>(units) * grid;
+    std::string s = oss.str();
+    if (s.find('.') != std::string::npos) {
+        while (s.back() == '0')
+            s.pop_back();
+        if (s.back() == '.')
+            s.pop_back();
+    }
+    if (s == "-0")
+        return "0";
+    if (s.rfind("0.", 0) == 0)
+        s.erase(0, 1);
+    else if (s.rfind("-0.", 0) == 0)
+        s.erase(1, 1);
+    return s;
+}
+
+// Writes path data, dropping command letters and separators wherever the SVG
+// path grammar allows it.
+class CompactPathWriter {
+  public:
+    CompactPathWriter(double grid)
+        : m_grid(grid)
+        , m_decimals(0) {
+        // smallest number of decimals that represents every multiple of grid
+        while (m_decimals < MAX_GRID_DECIMALS) {
+            double scaled = grid * std::pow(10.0, m_decimals);
+            if (std::abs(scaled - std::round(scaled)) < 1e-9)
+                break;
+            ++m_decimals;
+        }
+    }
+
+    void command(char cmd) {
+        if (cmd != m_last_cmd) {
+            m_out.push_back(cmd);
+            m_last_had_dot = false;
+            m_empty = true;
+        }
+        // coordinates following a moveto are implicit linetos
+        m_last_cmd = cmd == 'm' ? 'l' : cmd;
+    }
+
+    void number(int64_t units) {
+        std::string s = compactNumber(units, m_grid, m_decimals);
+        bool needs_sep = !m_empty && s[0] != '-' && !(s[0] == '.' && m_last_had_dot);
+        if (needs_sep)
+            m_out.push_back(' ');
+        m_out += s;
+        m_last_had_dot = s.find('.') != std::string::npos;
+        m_empty = false;
+    }
+
+    void close() {
+        m_out.push_back('z');
+        m_last_cmd = 'z';
+        m_last_had_dot = false;
+        m_empty = true;
+    }
+
+    const std::string& str() const {
+        return m_out;
+    }
+
+  private:
+    double m_grid;
+    int m_decimals;
+    std::string m_out;
+    char m_last_cmd {0};
+    bool m_last_had_dot {false};
+    bool m_empty {true};
+};
+
+// A quad is drawn as a line when its control point is within one grid unit of
+// the chord, which keeps the curve within half a unit of the straight segment.
+inline bool is_degenerate_quad(const GridXY& p0, const GridXY& p1, const GridXY& p2) {
+    const double cx = static_cast<double>(p2.x - p0.x);
+    const double cy = static_cast<double>(p2.y - p0.y);
+    const double vx = static_cast<double>(p1.x - p0.x);
+    const double vy = static_cast<double>(p1.y - p0.y);
+    const double len_sq = cx * cx + cy * cy;
+    if (len_sq == 0.0)
+        return vx == 0.0 && vy == 0.0;
+    const double cross = cx * vy - cy * vx;
+    const double dot = cx * vx + cy * vy;
+    return cross * cross <= len_sq && dot >= 0.0 && dot <= len_sq;
+}
+
+// All loops of one region as a single path (holes are cut by fill-rule evenodd)
+std::string regionToCompactPath(const std::vector<std::vector<QuadBezier>>& loops, double grid) {
+    CompactPathWriter path(grid);
+    GridXY subpath_start {0, 0}; // a leading relative moveto is absolute
+
+    for (const auto& curves : loops) {
+        if (curves.empty())
+            continue;
+
+        const GridXY start = snap(curves.front().p0, grid);
+        path.command('m');
+        path.number(start.x - subpath_start.x);
+        path.number(start.y - subpath_start.y);
+        subpath_start = start;
+
+        GridXY cur = start;
+        for (size_t i = 0; i < curves.size(); ++i) {
+            const GridXY c = snap(curves[i].p1, grid);
+            const GridXY end = snap(curves[i].p2, grid);
+            const int64_t dx = end.x - cur.x;
+            const int64_t dy = end.y - cur.y;
+
+            if (is_degenerate_quad(cur, c, end)) {
+                if (dx == 0 && dy == 0)
+                    continue;
+                // closing line is implied by 'z'
+                if (i + 1 == curves.size() && end.x == start.x && end.y == start.y)
+                    break;
+                if (dy == 0) {
+                    path.command('h');
+                    path.number(dx);
+                } else if (dx == 0) {
+                    path.command('v');
+                    path.number(dy);
+                } else {
+                    path.command('l');
+                    path.number(dx);
+                    path.number(dy);
+                }
+            } else {
+                path.command('q');
+                path.number(c.x - cur.x);
+                path.number(c.y - cur.y);
+                path.number(dx);
+                path.number(dy);
+            }
+            cur = end;
+        }
+        path.close();
+    }
+
+    return path.str();
+}
+
+std::string compactColor(const ImageLib::RGBAPixel<uint8_t>& px) {
+    const int rgb[3] {px.red, px.green, px.blue};
+    // #RRGGBB -> #RGB when every channel is a doubled hex digit
+    const bool shorthand = rgb[0] % 17 == 0 && rgb[1] % 17 == 0 && rgb[2] % 17 == 0;
+
+    std::ostringstream oss;
+    oss << "#" << std::hex << std::uppercase;
+    for (int ch : rgb) {
+        if (shorthand)
+            oss << ch / 17;
+        else
+            oss << std::setw(2) << std::setfill('0') << ch;
+    }
+    return oss.str();
+}
+
+void validateSvgConfig(const img2num::ImageToSvgConfig::SvgConfig& svg_config) {
+    if (svg_config.encoding != SVG_ENCODING_STANDARD &&
+        svg_config.encoding != SVG_ENCODING_COMPACT)
+        throw std::invalid_argument("labels_to_svg: unknown svg encoding");
+    if (svg_config.encoding == SVG_ENCODING_COMPACT && !(svg_config.grid > 0.0))
+        throw std::invalid_argument("labels_to_svg: svg grid must be positive");
+}
+
+/*
+Flatten surviving graph nodes into the contiguous VectorizationResult arrays.
+Regions keep graph order; adjacency is remapped from node ids to region indices.
+*/
+img2num::VectorizationResult graphToVectorization(
+    Graph& G, const int width, const int height, std::vector<int32_t>& region_labels,
+    const bool with_labels
+) {
+    img2num::VectorizationResult result;
+    result.width = width;
+    result.height = height;
+
+    // region_labels already holds -1 outside surviving nodes (see compute_contours);
+    // node ids are rewritten to region indices in place
+    std::unordered_map<int32_t, int32_t> region_index;
+    for (const Node_ptr& n : G.get_nodes()) {
+        if (n->area() == 0)
+            continue;
+        const int32_t r {static_cast<int32_t>(region_index.size())};
+        region_index[n->id()] = r;
+        for (const RGBXY& p : n->get_pixels())
+            region_labels[static_cast<size_t>(p.position.y) * width + p.position.x] = r;
+    }
+    if (with_labels)
+        result.labels = region_labels;
+
+    const size_t num_regions {region_index.size()};
+    result.colors.reserve(3 * num_regions);
+    result.areas.reserve(num_regions);
+    result.region_loop_offsets.reserve(num_regions + 1);
+    result.adjacency_offsets.reserve(num_regions + 1);
+    result.region_loop_offsets.push_back(0);
+    result.loop_curve_offsets.push_back(0);
+    result.adjacency_offsets.push_back(0);
+
+    for (const Node_ptr& n : G.get_nodes()) {
+        if (n->area() == 0)
+            continue;
+
+        const ImageLib::RGBPixel<uint8_t> c {n->color()};
+        result.colors.insert(result.colors.end(), {c.red, c.green, c.blue});
+        result.areas.push_back(static_cast<int32_t>(n->area()));
+
+        for (const std::vector<QuadBezier>& loop : n->get_contours().curves) {
+            for (const QuadBezier& q : loop)
+                result.curves.insert(
+                    result.curves.end(), {q.p0.x, q.p0.y, q.p1.x, q.p1.y, q.p2.x, q.p2.y}
+                );
+            result.loop_curve_offsets.push_back(static_cast<int32_t>(result.curves.size() / 6));
+        }
+        result.region_loop_offsets.push_back(
+            static_cast<int32_t>(result.loop_curve_offsets.size() - 1)
+        );
+
+        for (const Node_ptr& neighbor : n->edges()) {
+            auto it = region_index.find(neighbor->id());
+            if (neighbor->area() == 0 || it == region_index.end())
+                continue;
+            result.adjacency.push_back(it->second);
+        }
+        std::sort(result.adjacency.begin() + result.adjacency_offsets.back(), result.adjacency.end());
+        result.adjacency_offsets.push_back(static_cast<int32_t>(result.adjacency.size()));
+    }
+
+    return result;
+}
+
+ImageLib::RGBAPixel<uint8_t> regionColor(const img2num::VectorizationResult& result, size_t r) {
+    return {result.colors[3 * r], result.colors[3 * r + 1], result.colors[3 * r + 2], 255};
+}
+
+std::vector<QuadBezier> loopCurves(const img2num::VectorizationResult& result, int32_t loop) {
+    std::vector<QuadBezier> curves;
+    curves.reserve(result.loop_curve_offsets[loop + 1] - result.loop_curve_offsets[loop]);
+    for (int32_t i = result.loop_curve_offsets[loop]; i < result.loop_curve_offsets[loop + 1];
+         ++i) {
+        const float* f {&result.curves[6 * static_cast<size_t>(i)]};
+        curves.push_back({{f[0], f[1]}, {f[2], f[3]}, {f[4], f[5]}});
+    }
+    return curves;
+}
+
+std::string hexColor(const ImageLib::RGBAPixel<uint8_t>& px) {
+    std::ostringstream oss;
+    oss << "#" << std::hex << std::uppercase << std::setw(2) << std::setfill('0')
+        << static_cast<int>(px.red) << std::setw(2) << std::setfill('0')
+        << static_cast<int>(px.green) << std::setw(2) << std::setfill('0')
+        << static_cast<int>(px.blue);
+    return oss.str();
+}
+
+// One absolute path per loop, written as it is generated
+void writeStandardSVG(std::ostream& svg, const img2num::VectorizationResult& result) {
     svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" fill-rule=\"evenodd\" "
            "width=\""
-        << width << "\" height=\"" << height << "\">\n";
+        << result.width << "\" height=\"" << result.height << "\">\n";
+
+    for (size_t r = 0; r < result.num_regions(); ++r) {
+        const std::string fill {hexColor(regionColor(result, r))};
+        for (int32_t l = result.region_loop_offsets[r]; l < result.region_loop_offsets[r + 1];
+             ++l) {
+            std::string pathData = contourToSVGCurve(loopCurves(result, l));
+
+            // You can optionally style holes differently or rely on fill-rule
+            svg << "  <path d=\"" << pathData << "\" fill=\"" << fill << "\" />\n";
+        }
+    }
+
+    svg << "</svg>\n";
+}
 
-    for (size_t i = 0; i < result.curves.size(); ++i) {
-        std::string pathData = contourToSVGCurve(result.curves[i]);
+// One relative path per region, regions of the same color grouped under <g fill>
+void writeCompactSVG(
+    std::ostream& svg, const img2num::VectorizationResult& result, double grid
+) {
+    // group regions by color, keeping first-appearance order
+    std::vector<std::string> color_order;
+    std::map<std::string, std::vector<size_t>> regions_by_color;
+
+    for (size_t r = 0; r < result.num_regions(); ++r) {
+        const int32_t first_curve {result.loop_curve_offsets[result.region_loop_offsets[r]]};
+        const int32_t end_curve {result.loop_curve_offsets[result.region_loop_offsets[r + 1]]};
+        if (first_curve == end_curve)
+            continue; // no geometry, would produce an empty path
+        std::string fill = compactColor(regionColor(result, r));
+        auto& regions = regions_by_color[fill];
+        if (regions.empty())
+            color_order.push_back(fill);
+        regions.push_back(r);
+    }
 
-        const auto& px = result.colors[i];
-        std::ostringstream oss;
-        oss << "#" << std::hex << std::uppercase << std::setw(2) << std::setfill('0')
-            << static_cast<int>(px.red) << std::setw(2) << std::setfill('0')
-            << static_cast<int>(px.green) << std::setw(2) << std::setfill('0')
-            << static_cast<int>(px.blue);
+    auto region_path = [&](size_t r) {
+        std::vector<std::vector<QuadBezier>> loops;
+        for (int32_t l = result.region_loop_offsets[r]; l < result.region_loop_offsets[r + 1];
+             ++l)
+            loops.push_back(loopCurves(result, l));
+        return regionToCompactPath(loops, grid);
+    };
 
-        // You can optionally style holes differently or rely on fill-rule
-        svg << "  <path d=\"" << pathData << "\" fill=\"" << oss.str() << "\" />\n";
+    svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" fill-rule=\"evenodd\" width=\""
+        << result.width << "\" height=\"" << result.height << "\">";
+
+    for (const std::string& fill : color_order) {
+        const auto& regions = regions_by_color[fill];
+        if (regions.size() == 1) {
+            svg << "<path fill=\"" << fill << "\" d=\"" << region_path(regions.front()) << "\"/>";
+            continue;
+        }
+        svg << "<g fill=\"" << fill << "\">";
+        for (size_t r : regions)
+            svg << "<path d=\"" << region_path(r) << "\"/>";
+        svg << "</g>";
     }
 
     svg << "</svg>\n";
-    return svg.str();
 }
 
-namespace img2num {
+void writeSVG(
+    std::ostream& svg, const img2num::VectorizationResult& result,
+    const img2num::ImageToSvgConfig::SvgConfig& svg_config
+) {
+    if (svg_config.encoding == SVG_ENCODING_COMPACT)
+        writeCompactSVG(svg, result, svg_config.grid);
+    else
+        writeStandardSVG(svg, result);
+}
+
 /*
-data: uint8_t* -> output image from K-Means (or similar) in RGBA repeating
-format ([r,g,b,a, r,g,b,a, ...]) labels: int32_t* -> output of labelled regions
-from K-Means, should be 1/4 the size of data since data is RGBA labels : width *
-height : number of pixels in image = 1 : 1 : 1
+Steps 1. - 4. of the pipeline. `region_labels` receives the per-pixel region id
+raster; it is the only full-size label raster the pipeline owns and is handed on
+to Graph::compute_contours and graphToVectorization rather than rebuilt.
 */
-std::string labels_to_svg(
-    const uint8_t* data, const int32_t* labels, const int width, const int height,
-    const int min_area, const int min_thickness = 0
+std::unique_ptr<Graph> build_region_graph(
+    const img2num::ImageView& image, const int32_t* labels, const int min_area,
+    const int min_thickness, std::vector<int32_t>& region_labels, const uint8_t seam_sides = 0
 ) {
-    const int32_t num_pixels {width * height};
-    std::vector<int32_t> labels_vector {labels, labels + num_pixels};
-    std::vector<int32_t> region_labels;
+    const int width {image.width};
+    const int height {image.height};
 
     // 1. enumerate regions and convert to Nodes
     std::vector<Node_ptr> nodes;
-    region_labeling(data, labels_vector, region_labels, width, height, nodes);
+    region_labeling(image, labels, region_labels, width, height, nodes);
+
+    // regions cut by a tile seam are only pieces; keep them out of small-region merging
+    std::vector<uint8_t> pinned;
+    if (seam_sides) {
+        pinned.assign(nodes.size(), 0);
+        const size_t w {static_cast<size_t>(width)};
+        for (size_t y = 0; y < static_cast<size_t>(height); ++y) {
+            if (seam_sides & img2num::SEAM_LEFT)
+                pinned[region_labels[y * w]] = 1;
+            if (seam_sides & img2num::SEAM_RIGHT)
+                pinned[region_labels[y * w + w - 1]] = 1;
+        }
+        for (size_t x = 0; x < w; ++x) {
+            if (seam_sides & img2num::SEAM_TOP)
+                pinned[region_labels[x]] = 1;
+            if (seam_sides & img2num::SEAM_BOTTOM)
+                pinned[region_labels[(static_cast<size_t>(height) - 1) * w + x]] = 1;
+        }
+    }
 
     // 2. initialize Graph from all Nodes
     std::unique_ptr<std::vector<Node_ptr>> node_ptr =
         std::make_unique<std::vector<Node_ptr>>(std::move(nodes));
-    Graph G(node_ptr, width, height);
+    std::unique_ptr<Graph> G {std::make_unique<Graph>(node_ptr, width, height)};
 
     // 3. Discover node adjacencies - add edges to Graph
-    G.discover_edges(region_labels, width, height);
+    G->discover_edges(region_labels, width, height);
 
     // 4. Merge small area nodes until all nodes are minArea or larger
-    G.merge_small_area_nodes(min_area, min_thickness);
+    G->merge_small_area_nodes(min_area, min_thickness, pinned);
 
-    // 5. recolor image on new regions
-    ImageLib::Image<ImageLib::RGBAPixel<uint8_t>> results {width, height};
-    for (auto& n : G.get_nodes()) {
+    return G;
+}
+
+/*
+Shared-arc (TopoJSON-style) document.
+Each fitted arc is stored once as a flat list of points alternating
+anchor/control/anchor ([p0, c1, p1, c2, p2, ...]), quantized to `grid` and
+delta-encoded after the first point. Regions list their loops as signed arc
+indices, where ~i (-i - 1) walks arc i backwards.
+*/
+std::string topologyToJSON(const Graph& G, const int width, const int height, double grid) {
+    const SharedTopology& topo {G.get_topology()};
+
+    // only arcs referenced by a surviving region are written, densely renumbered
+    std::vector<int32_t> remap(topo.arcs.size(), -1);
+    std::vector<int32_t> order;
+    for (const Node_ptr& n : G.get_nodes()) {
         if (n->area() == 0)
             continue;
+        auto it = topo.loops.find(n->id());
+        if (it == topo.loops.end())
+            continue;
+        for (const auto& loop : it->second)
+            for (int32_t ref : loop) {
+                const int32_t arc {ref >= 0 ? ref : ~ref};
+                if (remap[arc] < 0) {
+                    remap[arc] = static_cast<int32_t>(order.size());
+                    order.push_back(arc);
+                }
+            }
+    }
 
-        auto [r, g, b] = n->color();
-        for (auto& [_, p] : n->get_pixels()) {
-            results(p.x, p.y) = {r, g, b};
+    std::ostringstream json;
+    json << "{\"type\":\"Img2NumTopology\",\"width\":" << width << ",\"height\":" << height
+         << ",\"transform\":{\"scale\":[" << grid << "," << grid
+         << "],\"translate\":[0,0]},\"arcs\":[";
+
+    for (size_t a = 0; a < order.size(); ++a) {
+        const std::vector<QuadBezier>& arc {topo.arcs[order[a]]};
+        json << (a ? ",[" : "[");
+        GridXY prev {0, 0};
+        auto write_point = [&](const Point& p, bool first) {
+            const GridXY q {snap(p, grid)};
+            json << (first ? "[" : ",[") << q.x - prev.x << "," << q.y - prev.y << "]";
+            prev = q;
+        };
+        write_point(arc.front().p0, true);
+        for (const QuadBezier& q : arc) {
+            write_point(q.p1, false);
+            write_point(q.p2, false);
         }
+        json << "]";
     }
 
-    // 6. Contours
-    // graph will manage computing contours
-    G.compute_contours();
-
-    // accumulate all contours for svg export
-    ColoredContours all_contours;
-    for (auto& n : G.get_nodes()) {
+    json << "],\"regions\":[";
+    bool first_region {true};
+    for (const Node_ptr& n : G.get_nodes()) {
         if (n->area() == 0)
             continue;
-        ColoredContours node_contours = n->get_contours();
-        for (auto& c : node_contours.contours) {
-            all_contours.contours.push_back(c);
-        }
-        for (auto& c : node_contours.hierarchy) {
-            all_contours.hierarchy.push_back(c);
-        }
-        for (bool b : node_contours.is_hole) {
-            all_contours.is_hole.push_back(b);
-        }
-        for (auto& c : node_contours.colors) {
-            all_contours.colors.push_back(c);
-        }
-        for (auto& c : node_contours.curves) {
-            all_contours.curves.push_back(c);
+        auto it = topo.loops.find(n->id());
+        if (it == topo.loops.end() || it->second.empty())
+            continue;
+
+        const ImageLib::RGBPixel<uint8_t> c {n->color()};
+        json << (first_region ? "" : ",") << "{\"fill\":\""
+             << compactColor({c.red, c.green, c.blue, 255}) << "\",\"area\":" << n->area()
+             << ",\"loops\":[";
+        first_region = false;
+        for (size_t l = 0; l < it->second.size(); ++l) {
+            json << (l ? ",[" : "[");
+            const std::vector<int32_t>& loop {it->second[l]};
+            for (size_t i = 0; i < loop.size(); ++i) {
+                const int32_t ref {loop[i]};
+                const int32_t arc {remap[ref >= 0 ? ref : ~ref]};
+                json << (i ? "," : "") << (ref >= 0 ? arc : ~arc);
+            }
+            json << "]";
         }
+        json << "]}";
     }
 
-    // 7. Return SVG
-    return contoursResultToSVG(all_contours, width, height);
+    json << "]}\n";
+    return json.str();
+}
+
+// `offsets` must start at 0, never decrease and end at `total`
+static bool valid_offsets(const std::vector<int32_t>& offsets, const size_t total) {
+    if (offsets.empty() || offsets.front() != 0 ||
+        static_cast<size_t>(offsets.back()) != total)
+        return false;
+    return std::is_sorted(offsets.begin(), offsets.end());
+}
+
+namespace img2num {
+/*
+data: uint8_t* -> output image from K-Means (or similar) in RGBA repeating
+format ([r,g,b,a, r,g,b,a, ...]) labels: int32_t* -> output of labelled regions
+from K-Means, should be 1/4 the size of data since data is RGBA labels : width *
+height : number of pixels in image = 1 : 1 : 1
+*/
+std::string labels_to_svg(
+    const uint8_t* data, const int32_t* labels, const int width, const int height,
+    const int min_area, const int min_thickness = 0
+) {
+    return labels_to_svg(
+        data, labels, width, height, min_area, min_thickness, ImageToSvgConfig::SvgConfig {}
+    );
+}
+
+std::string labels_to_svg(
+    const uint8_t* data, const int32_t* labels, const int width, const int height,
+    const int min_area, const int min_thickness, const ImageToSvgConfig::SvgConfig& svg_config
+) {
+    validateSvgConfig(svg_config);
+    return vectorization_to_svg(
+        labels_to_vectorization(data, labels, width, height, min_area, min_thickness), svg_config
+    );
+}
+
+VectorizationResult labels_to_vectorization(
+    const uint8_t* data, const int32_t* labels, const int width, const int height,
+    const int min_area, const int min_thickness
+) {
+    Workspace workspace;
+    return labels_to_vectorization(
+        ImageView {data, width, height}, labels, min_area, min_thickness, workspace, true
+    );
+}
+
+VectorizationResult labels_to_vectorization(
+    const ImageView& image, const int32_t* labels, const int min_area, const int min_thickness,
+    Workspace& workspace, const bool with_labels, const uint8_t seam_sides
+) {
+    const int width {image.width};
+    const int height {image.height};
+
+    // 1. - 4. regions, adjacency and small-region merging
+    std::vector<int32_t>& region_labels {workspace.region_labels};
+    std::unique_ptr<Graph> graph {build_region_graph(
+        image, labels, min_area, min_thickness, region_labels, seam_sides
+    )};
+    Graph& G {*graph};
+
+    // 5. Contours
+    // graph will manage computing contours
+    G.compute_contours(region_labels);
+
+    // 6. Flatten regions
+    return graphToVectorization(G, width, height, region_labels, with_labels);
+}
+
+void validate_vectorization(const VectorizationResult& result, const char* caller) {
+    auto fail = [caller](const char* what) {
+        throw std::invalid_argument(std::string(caller) + ": " + what);
+    };
+    const size_t num_regions {result.num_regions()};
+    if (result.width < 0 || result.height < 0)
+        fail("width and height must not be negative");
+    if (result.colors.size() != 3 * num_regions)
+        fail("colors must hold 3 bytes per region");
+    if (result.region_loop_offsets.size() != num_regions + 1 ||
+        result.adjacency_offsets.size() != num_regions + 1)
+        fail("region offsets must have num_regions() + 1 entries");
+    if (result.curves.size() % 6 != 0)
+        fail("curves must hold 6 floats per curve");
+    if (!valid_offsets(result.region_loop_offsets, result.num_loops()))
+        fail("region_loop_offsets out of range");
+    if (!valid_offsets(result.loop_curve_offsets, result.num_curves()))
+        fail("loop_curve_offsets out of range");
+    if (!valid_offsets(result.adjacency_offsets, result.adjacency.size()))
+        fail("adjacency_offsets out of range");
+    for (const int32_t neighbor : result.adjacency) {
+        if (neighbor < 0 || static_cast<size_t>(neighbor) >= num_regions)
+            fail("adjacency names a region that does not exist");
+    }
+    const size_t num_pixels {
+        static_cast<size_t>(result.width) * static_cast<size_t>(result.height)};
+    if (!result.labels.empty() && result.labels.size() != num_pixels)
+        fail("labels must be empty or hold width * height entries");
+}
+
+std::string vectorization_to_svg(
+    const VectorizationResult& result, const ImageToSvgConfig::SvgConfig& svg_config
+) {
+    validateSvgConfig(svg_config);
+    validate_vectorization(result, "vectorization_to_svg");
+
+    std::ostringstream svg;
+    writeSVG(svg, result, svg_config);
+    return svg.str();
+}
+
+std::vector<uint8_t> vectorization_to_svgz(
+    const VectorizationResult& result, const ImageToSvgConfig::SvgConfig& svg_config
+) {
+    validateSvgConfig(svg_config);
+    validate_vectorization(result, "vectorization_to_svgz");
+
+    // the serializer streams straight into the encoder; only compressed bytes accumulate
+    std::vector<uint8_t> svgz;
+    GzipEncoder encoder(svgz);
+    GzipStreamBuf buffer(encoder);
+    std::ostream svg(&buffer);
+    writeSVG(svg, result, svg_config);
+    svg.flush();
+    encoder.finish();
+    return svgz;
+}
+
+std::string labels_to_arcs(
+    const uint8_t* data, const int32_t* labels, const int width, const int height,
+    const int min_area, const int min_thickness, const double grid
+) {
+    Workspace workspace;
+    return labels_to_arcs(
+        ImageView {data, width, height}, labels, min_area, min_thickness, grid, workspace
+    );
+}
+
+std::string labels_to_arcs(
+    const ImageView& image, const int32_t* labels, const int min_area, const int min_thickness,
+    const double grid, Workspace& workspace
+) {
+    if (!(grid > 0.0))
+        throw std::invalid_argument("labels_to_arcs: grid must be positive");
+
+    std::vector<int32_t>& region_labels {workspace.region_labels};
+    std::unique_ptr<Graph> G {
+        build_region_graph(image, labels, min_area, min_thickness, region_labels)};
+    G->compute_contours(region_labels);
+
+    return topologyToJSON(*G, image.width, image.height, grid);
 }
 } // namespace img2num
@@ -0,0 +1,78 @@
+#include "internal/pixel_format.h"
+
+#include "img2num.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// One loop per format keeps the per-pixel work free of format dispatch
+template <size_t BYTES, size_t R, size_t G, size_t B, bool ALPHA>
+void convert_row(const uint8_t* in, const size_t width, uint8_t* out) {
+    for (size_t x = 0; x < width; ++x, in += BYTES, out += 4) {
+        out[0] = in[R];
+        out[1] = in[G];
+        out[2] = in[B];
+        out[3] = ALPHA ? in[3] : 255;
+    }
+}
+
+void gray_row(const uint8_t* in, const size_t width, uint8_t* out) {
+    for (size_t x = 0; x < width; ++x, out += 4) {
+        out[0] = out[1] = out[2] = in[x];
+        out[3] = 255;
+    }
+}
+} // namespace
+
+namespace img2num {
+bool is_packed_rgba(const ImageView& image) {
+    return image.format == PixelFormat::RGBA8 &&
+           row_stride(image) == static_cast<size_t>(image.width) * 4;
+}
+
+void validate_image_view(const ImageView& image, const char* caller) {
+    const std::string name {caller};
+    if (!image.data)
+        throw std::invalid_argument(name + ": image data is null");
+    if (image.width <= 0 || image.height <= 0)
+        throw std::invalid_argument(name + ": width and height must be positive");
+    if (bytes_per_pixel(image.format) == 0)
+        throw std::invalid_argument(name + ": unknown pixel format");
+    if (row_stride(image) < static_cast<size_t>(image.width) * bytes_per_pixel(image.format))
+        throw std::invalid_argument(name + ": stride is shorter than one row");
+}
+
+void load_rgba_row(const ImageView& image, const int y, uint8_t* out) {
+    const uint8_t* in {image.data + static_cast<size_t>(y) * row_stride(image)};
+    const size_t width {static_cast<size_t>(image.width)};
+    switch (image.format) {
+    case PixelFormat::RGBA8:
+        std::memcpy(out, in, width * 4);
+        break;
+    case PixelFormat::BGRA8:
+        convert_row<4, 2, 1, 0, true>(in, width, out);
+        break;
+    case PixelFormat::RGB8:
+        convert_row<3, 0, 1, 2, false>(in, width, out);
+        break;
+    case PixelFormat::BGR8:
+        convert_row<3, 2, 1, 0, false>(in, width, out);
+        break;
+    case PixelFormat::GRAY8:
+        gray_row(in, width, out);
+        break;
+    }
+}
+
+void load_rgba(const ImageView& image, std::vector<uint8_t>& out) {
+    const size_t row_bytes {static_cast<size_t>(image.width) * 4};
+    out.resize(row_bytes * static_cast<size_t>(image.height));
+    for (int y = 0; y < image.height; ++y)
+        load_rgba_row(image, y, out.data() + static_cast<size_t>(y) * row_bytes);
+}
+} // namespace img2num
@@ -0,0 +1,195 @@
+#include "internal/resample.h"
+
+#include "img2num.h"
+#include "internal/row_source.h"
+#include "internal/tiling.h"
+#include "internal/workspace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+// Largest size within `max_pixels` with the aspect ratio of width x height
+void budget_size(
+    const int width, const int height, const double max_pixels, int& out_width, int& out_height
+) {
+    const double scale {std::sqrt(max_pixels / (static_cast<double>(width) * height))};
+    out_width = std::max(1, static_cast<int>(width * scale));
+    out_height = std::max(1, static_cast<int>(height * scale));
+}
+
+/*
+Area-averaging downscale to out_width x out_height (neither larger than the source),
+reading each source row once. Positions are measured in integer units on both grids: a
+source column spans out_width units and an output column width units (rows likewise), so
+every overlap is an exact integer and each output pixel is the exactly rounded average of
+the source area it covers. A source pixel overlaps at most two output pixels per axis.
+*/
+void area_downscale(
+    img2num::RowSource& source, const int out_width, const int out_height,
+    std::vector<uint8_t>& out
+) {
+    const int width {source.width()};
+    const int height {source.height()};
+    const size_t out_row_values {static_cast<size_t>(out_width) * 4};
+    out.resize(out_row_values * out_height);
+
+    // first output column each source column falls in, and the units it covers there
+    std::vector<int> first_column(width);
+    std::vector<uint32_t> first_share(width);
+    for (int x = 0; x < width; ++x) {
+        const int64_t left {static_cast<int64_t>(x) * out_width};
+        const int64_t ox {left / width};
+        first_column[x] = static_cast<int>(ox);
+        first_share[x] = static_cast<uint32_t>(std::min(left + out_width, (ox + 1) * width) - left);
+    }
+
+    std::vector<uint8_t> row(static_cast<size_t>(width) * 4);
+    std::vector<uint64_t> columns(out_row_values); // one source row, summed per output column
+    std::vector<uint64_t> current(out_row_values, 0);
+    std::vector<uint64_t> next(out_row_values, 0);
+    const uint64_t total {static_cast<uint64_t>(width) * height}; // units of one output pixel
+
+    int oy {0};
+    for (int y = 0; y < height; ++y) {
+        source.read_rows(y, 1, row.data());
+        std::fill(columns.begin(), columns.end(), 0);
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* px {&row[static_cast<size_t>(x) * 4]};
+            uint64_t* sum {&columns[static_cast<size_t>(first_column[x]) * 4]};
+            const uint32_t share {first_share[x]};
+            const uint32_t rest {static_cast<uint32_t>(out_width) - share};
+            for (int c = 0; c < 4; ++c)
+                sum[c] += static_cast<uint64_t>(px[c]) * share;
+            if (rest > 0) {
+                for (int c = 0; c < 4; ++c)
+                    sum[4 + c] += static_cast<uint64_t>(px[c]) * rest;
+            }
+        }
+
+        const int64_t top {static_cast<int64_t>(y) * out_height};
+        const int64_t boundary {static_cast<int64_t>(oy + 1) * height};
+        const uint64_t share {static_cast<uint64_t>(std::min(top + out_height, boundary) - top)};
+        const uint64_t rest {static_cast<uint64_t>(out_height) - share};
+        for (size_t i = 0; i < out_row_values; ++i) {
+            current[i] += columns[i] * share;
+            next[i] += columns[i] * rest;
+        }
+
+        // output row oy is complete once a source row reaches its bottom edge
+        if (top + out_height >= boundary) {
+            uint8_t* out_row {out.data() + static_cast<size_t>(oy) * out_row_values};
+            for (size_t i = 0; i < out_row_values; ++i)
+                out_row[i] = static_cast<uint8_t>((current[i] + total / 2) / total);
+            current.swap(next);
+            std::fill(next.begin(), next.end(), 0);
+            ++oy;
+        }
+    }
+}
+
+// Scales a positive pixel measure, keeping it at least 1 so the filter stays enabled
+int scale_measure(const int value, const double factor) {
+    if (value <= 0)
+        return value;
+    return std::max(1, static_cast<int>(std::lround(value * factor)));
+}
+
+// `config` for the downscaled image; `area_scale` is the ratio of the pixel counts
+img2num::ImageToSvgConfig
+resampled_config(const img2num::ImageToSvgConfig& config, const double area_scale) {
+    const double scale {std::sqrt(area_scale)};
+    img2num::ImageToSvgConfig scaled {config};
+    scaled.resample.max_megapixels = 0.0;
+    scaled.min_cluster_area = scale_measure(config.min_cluster_area, area_scale);
+    scaled.min_thickness = scale_measure(config.min_thickness, scale);
+    scaled.bilateral_filter.sigma_spatial = config.bilateral_filter.sigma_spatial * scale;
+    return scaled;
+}
+
+// Nearest-neighbour upsample of a region raster, sampling at output pixel centers
+void upsample_labels(
+    const std::vector<int32_t>& labels, const int width, const int height, const int out_width,
+    const int out_height, std::vector<int32_t>& out
+) {
+    std::vector<int> source_column(out_width);
+    for (int x = 0; x < out_width; ++x) {
+        source_column[x] = static_cast<int>(
+            (2 * static_cast<int64_t>(x) + 1) * width / (2 * static_cast<int64_t>(out_width))
+        );
+    }
+
+    out.resize(static_cast<size_t>(out_width) * out_height);
+    for (int y = 0; y < out_height; ++y) {
+        const int sy {static_cast<int>(
+            (2 * static_cast<int64_t>(y) + 1) * height / (2 * static_cast<int64_t>(out_height))
+        )};
+        const int32_t* row {&labels[static_cast<size_t>(sy) * width]};
+        int32_t* out_row {&out[static_cast<size_t>(y) * out_width]};
+        for (int x = 0; x < out_width; ++x)
+            out_row[x] = row[source_column[x]];
+    }
+}
+} // namespace
+
+namespace img2num {
+bool uses_resampling(const int width, const int height, const ImageToSvgConfig& config) {
+    const double max_pixels {config.resample.max_megapixels * 1e6};
+    return max_pixels > 0.0 && static_cast<double>(width) * height > max_pixels;
+}
+
+VectorizationResult resampled_vectorization(
+    RowSource& source, const ImageToSvgConfig& config, const bool use_gpu, Workspace& workspace,
+    const bool with_labels
+) {
+    if (!(config.resample.max_megapixels > 0.0))
+        throw std::invalid_argument("resampled_vectorization: max_megapixels must be positive");
+
+    const int width {source.width()};
+    const int height {source.height()};
+    int small_width {0};
+    int small_height {0};
+    budget_size(width, height, config.resample.max_megapixels * 1e6, small_width, small_height);
+    area_downscale(source, small_width, small_height, workspace.resampled);
+
+    const double area_scale {
+        static_cast<double>(small_width) * small_height / (static_cast<double>(width) * height)};
+    const ImageToSvgConfig scaled {resampled_config(config, area_scale)};
+    const ImageView image {workspace.resampled.data(), small_width, small_height};
+
+    VectorizationResult result;
+    if (uses_tiling(small_width, small_height, scaled)) {
+        MemoryRowSource small {image};
+        result = tiled_vectorization(small, scaled, use_gpu, workspace);
+    } else {
+        cluster_labels(image, scaled, use_gpu, workspace);
+        result = labels_to_vectorization(
+            image, workspace.labels.data(), scaled.min_cluster_area, scaled.min_thickness,
+            workspace, with_labels
+        );
+    }
+
+    // back to the original size
+    const float scale_x {static_cast<float>(width) / small_width};
+    const float scale_y {static_cast<float>(height) / small_height};
+    for (size_t i = 0; i + 1 < result.curves.size(); i += 2) {
+        result.curves[i] *= scale_x;
+        result.curves[i + 1] *= scale_y;
+    }
+    for (int32_t& area : result.areas)
+        area = static_cast<int32_t>(std::llround(area / area_scale));
+    if (!result.labels.empty()) {
+        std::vector<int32_t> labels;
+        upsample_labels(result.labels, small_width, small_height, width, height, labels);
+        result.labels = std::move(labels);
+    }
+    result.width = width;
+    result.height = height;
+    return result;
+}
+} // namespace img2num
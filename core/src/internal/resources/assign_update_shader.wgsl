@@ -5,93 +5,131 @@
 struct Params {
     numPoints : u32,
     numCentroids : u32,
-};
-
-struct ClusterAccumulator {
-    sumR: atomic<i32>, // Atomic Integer R
-    sumG: atomic<i32>, // Atomic Integer G
-    sumB: atomic<i32>, // Atomic Integer B
-    count: atomic<u32> // Atomic Counter
+    numGroups : u32, // workgroups dispatched (1D); each loops over several 16x16 tiles
+    _pad : u32,
 };
 
 @group(0) @binding(3) var<uniform> params : Params;
-@group(0) @binding(4) var<storage, read_write> accumulators: array<ClusterAccumulator>;
+
+// Level one of the centroid reduction: one partial sum per (workgroup, cluster), laid
+// out as partials[group * numCentroids + cluster] = (sumR, sumG, sumB, count). Every
+// workgroup writes all of its slots, so the buffer needs no reset between iterations.
+@group(0) @binding(4) var<storage, read_write> partials: array<vec4<f32>>;
+
+// Convergence detection: each pixel's label from the previous iteration (stored as
+// label + 1, so a cleared buffer means "none yet") and the number of pixels whose
+// label changed in this iteration. The host clears `changed` before the iterations it
+// samples and reads it back every few iterations.
+@group(0) @binding(5) var<storage, read_write> prevLabels: array<u32>;
+@group(0) @binding(6) var<storage, read_write> changed: atomic<u32>;
 
 // --- WORKGROUP SHARED MEMORY ---
-// Must have a fixed compile-time size. Set this to your maximum expected K (e.g., 32 or 64).
-const MAX_K: u32 = 64u; 
+// Must have a fixed compile-time size. Keep in sync with KMEANS_GPU_MAX_K (kmeans_gpu.h),
+// which keeps larger k off the GPU.
+const MAX_K: u32 = 64u;
+// Fixed-point scale of the shared tile sums: channels lie in [-1, 1], so a 256-pixel
+// tile stays below 2^24 in magnitude and fits an i32 with room to spare
+const FIXED_SCALE: f32 = 65536.0;
 var<workgroup> local_sumR: array<atomic<i32>, MAX_K>;
 var<workgroup> local_sumG: array<atomic<i32>, MAX_K>;
 var<workgroup> local_sumB: array<atomic<i32>, MAX_K>;
 var<workgroup> local_count: array<atomic<u32>, MAX_K>;
+var<workgroup> local_changed: atomic<u32>;
 
 @compute @workgroup_size(16, 16)
 fn main(
-    @builtin(global_invocation_id) global_id : vec3<u32>,
+    @builtin(workgroup_id) group_id : vec3<u32>,
+    @builtin(local_invocation_id) local_id : vec3<u32>,
     @builtin(local_invocation_index) local_idx : u32 // A flat ID from 0 to 255 for this block
 ) {
     let dims = textureDimensions(inputTex);
-    let x = global_id.x;
-    let y = global_id.y;
+    let tilesX = (dims.x + 15u) / 16u;
+    let numTiles = tilesX * ((dims.y + 15u) / 16u);
 
-    let is_valid = x < dims.x && y < dims.y;
+    // Running float sums of cluster `local_idx` over this workgroup's tiles. Each tile's
+    // integer sum is exact, and few enough tiles fold into one workgroup that the float
+    // sum keeps full precision.
+    var running = vec4<f32>(0.0);
 
-    // 1. INITIALIZE LOCAL MEMORY
-    // We let the first K threads in the block zero out the shared memory
-    if (local_idx < params.numCentroids) {
-        atomicStore(&local_sumR[local_idx], 0i);
-        atomicStore(&local_sumG[local_idx], 0i);
-        atomicStore(&local_sumB[local_idx], 0i);
-        atomicStore(&local_count[local_idx], 0u);
+    if (local_idx == 0u) {
+        atomicStore(&local_changed, 0u);
     }
 
-    // Wait for all 256 threads to reach this point (ensures memory is zeroed)
-    workgroupBarrier();
+    // Grid-stride loop: the trip count depends only on the workgroup id, so every
+    // thread reaches the barriers below
+    for (var tile = group_id.x; tile < numTiles; tile += params.numGroups) {
+        // 1. INITIALIZE LOCAL MEMORY
+        // The first K threads zero the slot they fold below, so no barrier is needed
+        // between the fold and the next zeroing
+        if (local_idx < params.numCentroids) {
+            atomicStore(&local_sumR[local_idx], 0i);
+            atomicStore(&local_sumG[local_idx], 0i);
+            atomicStore(&local_sumB[local_idx], 0i);
+            atomicStore(&local_count[local_idx], 0u);
+        }
+
+        // Wait for all 256 threads to reach this point (ensures memory is zeroed)
+        workgroupBarrier();
 
-    if (is_valid) {
-        let centerVal = textureLoad(inputTex, vec2<i32>(i32(x), i32(y)), 0);
+        let x = (tile % tilesX) * 16u + local_id.x;
+        let y = (tile / tilesX) * 16u + local_id.y;
+        if (x < dims.x && y < dims.y) {
+            let centerVal = textureLoad(inputTex, vec2<i32>(i32(x), i32(y)), 0);
 
-        var minDistSq = 1e+38; // Max f32
-        var bestClusterIndex: u32 = 0u;
+            var minDistSq = 1e+38; // Max f32
+            var bestClusterIndex: u32 = 0u;
 
-        for (var i = 0u; i < params.numCentroids; i = i + 1u) {        
-            // Euclidean distance squared (avoids expensive sqrt)
-            let c = textureLoad(centroids, vec2<i32>(i32(i), 0));
-            let diff = centerVal.rgb - c.rgb;
-            let distSq = dot(diff, diff);
+            for (var i = 0u; i < params.numCentroids; i = i + 1u) {
+                // Euclidean distance squared (avoids expensive sqrt)
+                let c = textureLoad(centroids, vec2<i32>(i32(i), 0));
+                let diff = centerVal.rgb - c.rgb;
+                let distSq = dot(diff, diff);
 
-            if (distSq < minDistSq) {
-                minDistSq = distSq;
-                bestClusterIndex = i;
+                if (distSq < minDistSq) {
+                    minDistSq = distSq;
+                    bestClusterIndex = i;
+                }
             }
+
+            textureStore(
+                clusters, vec2<i32>(i32(x), i32(y)), vec4<u32>(bestClusterIndex, 0u, 0u, 0u)
+            );
+            let pixelIndex = y * dims.x + x;
+            if (prevLabels[pixelIndex] != bestClusterIndex + 1u) {
+                prevLabels[pixelIndex] = bestClusterIndex + 1u;
+                atomicAdd(&local_changed, 1u);
+            }
+
+            // 2. ATOMIC ADD TO *LOCAL* MEMORY (Extremely fast, no global lock)
+            atomicAdd(&local_sumR[bestClusterIndex], i32(round(centerVal.r * FIXED_SCALE)));
+            atomicAdd(&local_sumG[bestClusterIndex], i32(round(centerVal.g * FIXED_SCALE)));
+            atomicAdd(&local_sumB[bestClusterIndex], i32(round(centerVal.b * FIXED_SCALE)));
+            atomicAdd(&local_count[bestClusterIndex], 1u);
         }
 
-        textureStore(clusters, vec2<i32>(i32(x), i32(y)), vec4<u32>(bestClusterIndex, 0u, 0u, 0u));
-        // 3. ATOMIC ADD TO *LOCAL* MEMORY (Extremely fast, no global lock)
-        atomicAdd(&local_sumR[bestClusterIndex], i32(centerVal.r * 1000.0));
-        atomicAdd(&local_sumG[bestClusterIndex], i32(centerVal.g * 1000.0));
-        atomicAdd(&local_sumB[bestClusterIndex], i32(centerVal.b * 1000.0));
-        atomicAdd(&local_count[bestClusterIndex], 1u);
+        // 3. WAIT FOR ALL THREADS TO FINISH THEIR MATH
+        workgroupBarrier();
+
+        // 4. FOLD THE TILE INTO THE RUNNING SUMS
+        if (local_idx < params.numCentroids) {
+            running += vec4<f32>(
+                f32(atomicLoad(&local_sumR[local_idx])) / FIXED_SCALE,
+                f32(atomicLoad(&local_sumG[local_idx])) / FIXED_SCALE,
+                f32(atomicLoad(&local_sumB[local_idx])) / FIXED_SCALE,
+                f32(atomicLoad(&local_count[local_idx]))
+            );
+        }
     }
 
-    // 4. WAIT FOR ALL THREADS TO FINISH THEIR MATH
-    workgroupBarrier();
-    
-    // 5. FLUSH LOCAL TO GLOBAL
-    // Now, the first K threads take the block's total and add it to the global buffer.
+    // 5. WRITE THIS WORKGROUP'S PARTIALS
+    // No global atomics on the sums: resolve_shader reduces the partials per cluster
     if (local_idx < params.numCentroids) {
-        // We only hit the global atomics ONCE per workgroup per centroid!
-        let r_sum = atomicLoad(&local_sumR[local_idx]);
-        let g_sum = atomicLoad(&local_sumG[local_idx]);
-        let b_sum = atomicLoad(&local_sumB[local_idx]);
-        let c_sum = atomicLoad(&local_count[local_idx]);
-
-        // Only add if this block actually found pixels for this cluster
-        if (c_sum > 0u) {
-            atomicAdd(&accumulators[local_idx].sumR, r_sum);
-            atomicAdd(&accumulators[local_idx].sumG, g_sum);
-            atomicAdd(&accumulators[local_idx].sumB, b_sum);
-            atomicAdd(&accumulators[local_idx].count, c_sum);
+        partials[group_id.x * params.numCentroids + local_idx] = running;
+    }
+    if (local_idx == 0u) {
+        let changed_sum = atomicLoad(&local_changed);
+        if (changed_sum > 0u) {
+            atomicAdd(&changed, changed_sum);
         }
     }
-}
\ No newline at end of file
+}
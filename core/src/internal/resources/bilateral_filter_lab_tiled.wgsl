@@ -0,0 +1,82 @@
+// bilateral_filter_lab for kernel radii up to MAX_TILED_RADIUS, staged like
+// bilateral_filter_rgb_tiled. Staged texels are packed as four f16 values (8 bytes)
+// so the tile still fits in 16 KiB; L*a*b* is rounded to at most 1/16 of a unit,
+// far below any useful sigmaRange. The center pixel is read at full precision.
+@group(0) @binding(0) var inputTex : texture_2d<f32>;
+@group(0) @binding(1) var outputTex : texture_storage_2d<rgba32float, write>;
+
+struct Params {
+    sigmaSpatial : f32,
+    sigmaRange : f32,
+    radius : i32, // ceil(3 * sigmaSpatial), capped as on the CPU
+    _pad : f32,
+};
+@group(0) @binding(2) var<uniform> params : Params;
+// 1D spatial Gaussian, spatialWeights[r + radius] = exp(-r^2 / (2 sigmaSpatial^2))
+@group(0) @binding(3) var<storage, read> spatialWeights : array<f32>;
+
+const BLOCK : i32 = 16;
+const MAX_TILED_RADIUS : i32 = 14; // keeps the tile within 16 KiB of workgroup memory
+const MAX_TILE : i32 = BLOCK + 2 * MAX_TILED_RADIUS;
+
+var<workgroup> tileTexels : array<vec2<u32>, MAX_TILE * MAX_TILE>;
+var<workgroup> tileWeights : array<f32, 2 * MAX_TILED_RADIUS + 1>;
+
+@compute @workgroup_size(16, 16)
+fn main(
+    @builtin(global_invocation_id) global_id : vec3<u32>,
+    @builtin(workgroup_id) group_id : vec3<u32>,
+    @builtin(local_invocation_index) local_index : u32
+) {
+    let dims = vec2<i32>(textureDimensions(inputTex));
+    let radius = params.radius;
+    let tileSide = BLOCK + 2 * radius;
+    let origin = vec2<i32>(group_id.xy) * BLOCK - vec2<i32>(radius);
+
+    // Stage the tile; texels outside the image are clamped to the edge
+    for (var i = i32(local_index); i < tileSide * tileSide; i += BLOCK * BLOCK) {
+        let offset = vec2<i32>(i % tileSide, i / tileSide);
+        let coords = clamp(origin + offset, vec2<i32>(0), dims - 1);
+        let val = textureLoad(inputTex, coords, 0);
+        tileTexels[i] = vec2<u32>(pack2x16float(val.xy), pack2x16float(val.zw));
+    }
+    for (var i = i32(local_index); i <= 2 * radius; i += BLOCK * BLOCK) {
+        tileWeights[i] = spatialWeights[i];
+    }
+    workgroupBarrier();
+
+    let x = i32(global_id.x);
+    let y = i32(global_id.y);
+    if (x >= dims.x || y >= dims.y) {
+        return;
+    }
+
+    let tilePos = vec2<i32>(x, y) - origin;
+    let centerVal = textureLoad(inputTex, vec2<i32>(x, y), 0);
+    var numerator = vec3<f32>(0.0);
+    var denominator = 0.0;
+
+    for (var i = -radius; i <= radius; i++) {
+        for (var j = -radius; j <= radius; j++) {
+            // the staged halo repeats the edge outside the image, as on the CPU
+            let index = (tilePos.y + j) * tileSide + tilePos.x + i;
+            let packed = tileTexels[index];
+            let neighborVal = vec4<f32>(unpack2x16float(packed.x), unpack2x16float(packed.y));
+
+            // Spatial weight (the 2D Gaussian is separable)
+            let wS = tileWeights[i + radius] * tileWeights[j + radius];
+
+            // Range weight (L*a*b* distance)
+            let diff = centerVal.rgb - neighborVal.rgb;
+            let rangeSq = dot(diff, diff);
+            let wR = exp(-rangeSq / (2.0 * params.sigmaRange * params.sigmaRange));
+
+            let w = wS * wR;
+            numerator += neighborVal.rgb * w;
+            denominator += w;
+        }
+    }
+
+    // alpha is kept, as on the CPU
+    textureStore(outputTex, vec2<i32>(x, y), vec4<f32>(numerator / denominator, centerVal.a));
+}
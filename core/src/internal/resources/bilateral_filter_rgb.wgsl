@@ -4,8 +4,12 @@
 struct Params {
     sigmaSpatial : f32,
     sigmaRange : f32,
+    radius : i32, // ceil(3 * sigmaSpatial), capped as on the CPU
+    _pad : f32,
 };
 @group(0) @binding(2) var<uniform> params : Params;
+// 1D spatial Gaussian, spatialWeights[r + radius] = exp(-r^2 / (2 sigmaSpatial^2))
+@group(0) @binding(3) var<storage, read> spatialWeights : array<f32>;
 
 @compute @workgroup_size(16, 16)
 fn main(@builtin(global_invocation_id) global_id : vec3<u32>) {
@@ -18,35 +22,34 @@ fn main(@builtin(global_invocation_id) global_id : vec3<u32>) {
     }
 
     let centerVal = textureLoad(inputTex, vec2<i32>(i32(x), i32(y)), 0);
-    var numerator = vec4<f32>(0.0);
+    var numerator = vec3<f32>(0.0);
     var denominator = 0.0;
     
-    // Kernel radius
-    let radius = i32(3.0 * params.sigmaSpatial); 
+    let radius = params.radius;
+    let lastTexel = vec2<i32>(dims) - 1;
 
     for (var i = -radius; i <= radius; i++) {
         for (var j = -radius; j <= radius; j++) {
-            let nx = i32(x) + i;
-            let ny = i32(y) + j;
-
-            if (nx >= 0 && ny >= 0 && nx < i32(dims.x) && ny < i32(dims.y)) {
-                let neighborVal = textureLoad(inputTex, vec2<i32>(nx, ny), 0);
-                
-                // Spatial weight
-                let distSq = f32(i*i + j*j);
-                let wS = exp(-distSq / (2.0 * params.sigmaSpatial * params.sigmaSpatial));
-
-                // Range weight (using RGB distance)
-                let diff = centerVal.rgb - neighborVal.rgb;
-                let rangeSq = dot(diff, diff);
-                let wR = exp(-rangeSq / (2.0 * params.sigmaRange * params.sigmaRange));
-
-                let w = wS * wR;
-                numerator += neighborVal * w;
-                denominator += w;
-            }
+            // Neighbours outside the image repeat the edge, as on the CPU
+            let neighbor = clamp(vec2<i32>(i32(x) + i, i32(y) + j), vec2<i32>(0), lastTexel);
+            let neighborVal = textureLoad(inputTex, neighbor, 0);
+
+            // Spatial weight (the 2D Gaussian is separable)
+            let wS = spatialWeights[i + radius] * spatialWeights[j + radius];
+
+            // Range weight (RGB distance on the 0-255 scale sigmaRange is given in)
+            let diff = (centerVal.rgb - neighborVal.rgb) * 255.0;
+            let rangeSq = dot(diff, diff);
+            let wR = exp(-rangeSq / (2.0 * params.sigmaRange * params.sigmaRange));
+
+            let w = wS * wR;
+            numerator += neighborVal.rgb * w;
+            denominator += w;
         }
     }
 
-    textureStore(outputTex, vec2<i32>(i32(x), i32(y)), numerator / denominator);
+    // alpha is kept, as on the CPU
+    textureStore(
+        outputTex, vec2<i32>(i32(x), i32(y)), vec4<f32>(numerator / denominator, centerVal.a)
+    );
 }
\ No newline at end of file
@@ -3,44 +3,36 @@
 // It matches the std::vector<double> min_dist_sq structure perfectly.
 @group(0) @binding(1) var<storage, read_write> minDistances : array<f32>;
 
-struct Params {
-    r: f32, g: f32, b: f32, a: f32,
-    width: u32,
+// Centroids chosen so far (see seed_select_shader.wgsl); the newest is at count - 1
+@group(0) @binding(2) var centroids : texture_storage_2d<rgba32float, read>;
+
+struct SeedState {
+    count : u32,
 };
-@group(0) @binding(2) var<uniform> params : Params;
+@group(0) @binding(3) var<storage, read> seedState : SeedState;
 
 @compute @workgroup_size(16, 16)
 fn main(@builtin(global_invocation_id) global_id : vec3<u32>) {
-    // let index = global_id.x;
-    let width = params.width;
-    
-    // Map 1D Global ID to 2D Texture Coordinates
-    // let y = index / width;
-    // let x = index % width;
-
     let x = global_id.x;
     let y = global_id.y;
 
-    let index = params.width * y + x;
-    
     let dims = textureDimensions(inputTex);
     if (x >= dims.x || y >= dims.y) { return; }
 
-    // 1. Load Pixel
+    let index = dims.x * y + x;
+
+    // 1. Load Pixel and the NEW centroid
     let currentVal = textureLoad(inputTex, vec2<i32>(i32(x), i32(y)), 0);
-    
-    // 2. Calculate Squared Euclidean Distance to the NEW centroid (passed in params)
-    // Note: Assuming texture is 0.0-1.0. If you need 0-255, multiply diff by 255.0.
-    let dr = currentVal.r - params.r;
-    let dg = currentVal.g - params.g;
-    let db = currentVal.b - params.b;
-    
-    let distSq = dr*dr + dg*dg + db*db;
-    
+    let centroid = textureLoad(centroids, vec2<i32>(i32(seedState.count) - 1, 0));
+
+    // 2. Calculate Squared Euclidean Distance to the NEW centroid
+    let diff = currentVal.rgb - centroid.rgb;
+    let distSq = dot(diff, diff);
+
     // 3. Update the Running Minimum
     // We strictly reduce the value. K-Means++ wants min(d(x, c1), d(x, c2)...)
-    let oldMin = minDistances[index];
-    if (distSq < oldMin) {
+    // The first centroid initializes the buffer, so it needs no upload.
+    if (seedState.count == 1u || distSq < minDistances[index]) {
         minDistances[index] = distSq;
     }
-}
\ No newline at end of file
+}
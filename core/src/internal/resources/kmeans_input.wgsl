@@ -0,0 +1,25 @@
+// Converts a filtered image into the layout the k-means shaders cluster on:
+// rgba32float with the colour channels multiplied by params.scale (1.0 for
+// normalized RGB, 1/255 for CIELAB) and alpha kept as is.
+@group(0) @binding(0) var inputTex : texture_2d<f32>;
+@group(0) @binding(1) var outputTex : texture_storage_2d<rgba32float, write>;
+
+struct Params {
+    scale : f32,
+    _pad0 : f32,
+    _pad1 : f32,
+    _pad2 : f32,
+};
+@group(0) @binding(2) var<uniform> params : Params;
+
+@compute @workgroup_size(16, 16)
+fn main(@builtin(global_invocation_id) global_id : vec3<u32>) {
+    let dims = textureDimensions(inputTex);
+    if (global_id.x >= dims.x || global_id.y >= dims.y) {
+        return;
+    }
+
+    let coords = vec2<i32>(global_id.xy);
+    let val = textureLoad(inputTex, coords, 0);
+    textureStore(outputTex, coords, vec4<f32>(val.rgb * params.scale, val.a));
+}
@@ -1,41 +1,48 @@
-struct ClusterAccumulator {
-    sumR: atomic<i32>,
-    sumG: atomic<i32>,
-    sumB: atomic<i32>,
-    count: atomic<u32>
+// Level two of the centroid reduction: one workgroup per cluster sums that cluster's
+// partials from every assign/update workgroup (in float, so large images cannot
+// overflow) and writes the new centroid.
+struct Params {
+    numPoints : u32,
+    numCentroids : u32,
+    numGroups : u32,
+    _pad : u32,
 };
 
-@group(0) @binding(0) var<storage, read_write> accumulators: array<ClusterAccumulator>;
+@group(0) @binding(0) var<storage, read> partials: array<vec4<f32>>;
 @group(0) @binding(1) var centroids : texture_storage_2d<rgba32float, write>;
+@group(0) @binding(2) var<uniform> params : Params;
+
+var<workgroup> sums: array<vec4<f32>, 256>;
 
 @compute @workgroup_size(256)
-fn main(@builtin(global_invocation_id) global_id : vec3<u32>) {
-    let i = global_id.x;
-    if (i >= arrayLength(&accumulators)) { return; }
+fn main(
+    @builtin(workgroup_id) group_id : vec3<u32>,
+    @builtin(local_invocation_index) local_idx : u32
+) {
+    let cluster = group_id.x;
 
-    // 1. Load the count ONCE
-    let count = atomicLoad(&accumulators[i].count);
-    
-    // Avoid division by zero for empty clusters
-    if (count > 0u) {
-        let fCount = f32(count);
-        
-        // 2. Load the sums ONCE
-        let sumR = atomicLoad(&accumulators[i].sumR);
-        let sumG = atomicLoad(&accumulators[i].sumG);
-        let sumB = atomicLoad(&accumulators[i].sumB);
+    // 1. Each thread sums a strided share of the workgroups
+    var sum = vec4<f32>(0.0);
+    for (var g = local_idx; g < params.numGroups; g += 256u) {
+        sum += partials[g * params.numCentroids + cluster];
+    }
+    sums[local_idx] = sum;
+    workgroupBarrier();
 
-        // 3. Do the math
-        let r = (f32(sumR) / 1000.0) / fCount;
-        let g = (f32(sumG) / 1000.0) / fCount;
-        let b = (f32(sumB) / 1000.0) / fCount;
-        
-        textureStore(centroids, vec2<i32>(i32(i), 0), vec4<f32>(r, g, b, 1.0));
+    // 2. Tree reduction in shared memory
+    for (var stride = 128u; stride > 0u; stride = stride / 2u) {
+        if (local_idx < stride) {
+            sums[local_idx] = sums[local_idx] + sums[local_idx + stride];
+        }
+        workgroupBarrier();
     }
 
-    // 4. Reset for the NEXT iteration
-    atomicStore(&accumulators[i].sumR, 0i);
-    atomicStore(&accumulators[i].sumG, 0i);
-    atomicStore(&accumulators[i].sumB, 0i);
-    atomicStore(&accumulators[i].count, 0u);
-}
\ No newline at end of file
+    // 3. Do the math; empty clusters keep their previous centroid
+    if (local_idx == 0u) {
+        let total = sums[0];
+        if (total.w > 0.0) {
+            let centroid = vec4<f32>(total.rgb / total.w, 1.0);
+            textureStore(centroids, vec2<i32>(i32(cluster), 0), centroid);
+        }
+    }
+}
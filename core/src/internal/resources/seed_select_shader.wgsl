@@ -0,0 +1,115 @@
+// Draws the next k-means++ centroid: a pixel chosen with probability proportional to
+// its weight in minDistances, using this round's host-generated random number in
+// [0, 1). Runs as a single workgroup: each thread sums a run of tiles, then thread 0
+// walks down from runs to tiles to pixels. The chosen pixel is stored as centroid
+// seedState.count, and the count advances for the next round.
+@group(0) @binding(0) var inputTex : texture_2d<f32>;
+@group(0) @binding(1) var<storage, read> minDistances : array<f32>;
+@group(0) @binding(2) var<storage, read> tileSums : array<f32>;
+@group(0) @binding(3) var<storage, read> randoms : array<f32>;
+@group(0) @binding(4) var centroids : texture_storage_2d<rgba32float, write>;
+
+struct SeedState {
+    count : u32,
+};
+@group(0) @binding(5) var<storage, read_write> seedState : SeedState;
+
+struct Params {
+    width : u32,
+    height : u32,
+    tilesX : u32,
+    tilesY : u32,
+};
+@group(0) @binding(6) var<uniform> params : Params;
+
+var<workgroup> runSums : array<f32, 256>;
+
+@compute @workgroup_size(256)
+fn main(@builtin(local_invocation_index) local_idx : u32) {
+    let numTiles = params.tilesX * params.tilesY;
+    let runLength = (numTiles + 255u) / 256u;
+    let runStart = min(local_idx * runLength, numTiles);
+    let runEnd = min(runStart + runLength, numTiles);
+
+    var sum = 0.0;
+    for (var t = runStart; t < runEnd; t++) {
+        sum += tileSums[t];
+    }
+    runSums[local_idx] = sum;
+    workgroupBarrier();
+
+    if (local_idx != 0u) {
+        return;
+    }
+
+    var total = 0.0;
+    for (var r = 0u; r < 256u; r++) {
+        total += runSums[r];
+    }
+
+    let slot = seedState.count;
+    let u = randoms[slot - 1u];
+    let numPixels = params.width * params.height;
+    var chosen = min(u32(u * f32(numPixels)), numPixels - 1u);
+
+    // With every weight zero (each pixel coincides with a centroid) the uniform draw above
+    // stands. Otherwise subtract weights level by level. Rounding can leave the remainder
+    // past the end of a level; the last item with a positive weight is taken then, so a
+    // pixel of weight zero (an existing centroid) is never chosen.
+    if (total > 0.0) {
+        var remaining = u * total;
+
+        var run = 0u;
+        var found = false;
+        for (var r = 0u; r < 256u; r++) {
+            if (runSums[r] > 0.0) {
+                run = r;
+                if (remaining < runSums[r]) {
+                    found = true;
+                    break;
+                }
+                remaining -= runSums[r];
+            }
+        }
+        if (!found) {
+            remaining = runSums[run];
+        }
+
+        var tile = run * runLength;
+        found = false;
+        for (var t = run * runLength; t < min(run * runLength + runLength, numTiles); t++) {
+            if (tileSums[t] > 0.0) {
+                tile = t;
+                if (remaining < tileSums[t]) {
+                    found = true;
+                    break;
+                }
+                remaining -= tileSums[t];
+            }
+        }
+        if (!found) {
+            remaining = tileSums[tile];
+        }
+
+        let x0 = (tile % params.tilesX) * 16u;
+        let y0 = (tile / params.tilesX) * 16u;
+        found = false;
+        for (var y = y0; y < min(y0 + 16u, params.height) && !found; y++) {
+            for (var x = x0; x < min(x0 + 16u, params.width); x++) {
+                let w = minDistances[params.width * y + x];
+                if (w > 0.0) {
+                    chosen = params.width * y + x;
+                    if (remaining < w) {
+                        found = true;
+                        break;
+                    }
+                    remaining -= w;
+                }
+            }
+        }
+    }
+
+    let coords = vec2<i32>(i32(chosen % params.width), i32(chosen / params.width));
+    textureStore(centroids, vec2<i32>(i32(slot), 0), textureLoad(inputTex, coords, 0));
+    seedState.count = slot + 1u;
+}
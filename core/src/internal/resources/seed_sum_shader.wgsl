@@ -0,0 +1,40 @@
+// Sums the k-means++ weights (minDistances) of each 16x16 tile of the image into
+// tileSums, indexed row-major over the dispatch grid, for seed_select_shader.
+@group(0) @binding(0) var<storage, read> minDistances : array<f32>;
+@group(0) @binding(1) var<storage, read_write> tileSums : array<f32>;
+
+struct Params {
+    width : u32,
+    height : u32,
+    tilesX : u32,
+    tilesY : u32,
+};
+@group(0) @binding(2) var<uniform> params : Params;
+
+var<workgroup> partialSums : array<f32, 256>;
+
+@compute @workgroup_size(16, 16)
+fn main(
+    @builtin(global_invocation_id) global_id : vec3<u32>,
+    @builtin(workgroup_id) group_id : vec3<u32>,
+    @builtin(local_invocation_index) local_idx : u32
+) {
+    var value = 0.0;
+    if (global_id.x < params.width && global_id.y < params.height) {
+        value = minDistances[params.width * global_id.y + global_id.x];
+    }
+    partialSums[local_idx] = value;
+    workgroupBarrier();
+
+    // Tree reduction in shared memory
+    for (var stride = 128u; stride > 0u; stride = stride / 2u) {
+        if (local_idx < stride) {
+            partialSums[local_idx] = partialSums[local_idx] + partialSums[local_idx + stride];
+        }
+        workgroupBarrier();
+    }
+
+    if (local_idx == 0u) {
+        tileSums[group_id.y * params.tilesX + group_id.x] = partialSums[0];
+    }
+}
@@ -0,0 +1,211 @@
+#include "internal/row_source.h"
+
+#include "img2num.h"
+#include "internal/pixel_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define IMG2NUM_HAS_MMAP
+#endif
+
+namespace {
+size_t row_bytes(const img2num::RowSource& source) {
+    return static_cast<size_t>(source.width()) * 4;
+}
+
+void check_dimensions(const int width, const int height) {
+    if (width <= 0 || height <= 0)
+        throw std::invalid_argument("RowSource: width and height must be positive");
+}
+
+#ifdef IMG2NUM_HAS_MMAP
+/*
+Read-only mapping of the file. Pages behind the last row read are released after
+every read, so resident memory stays near one band of rows even though the whole
+file is mapped.
+*/
+class MappedFileRowSource final : public img2num::RowSource {
+  public:
+    MappedFileRowSource(const std::string& path, const int width, const int height, size_t offset)
+        : m_width {width}, m_height {height}, m_offset {offset} {
+        check_dimensions(width, height);
+        const int fd {::open(path.c_str(), O_RDONLY)};
+        if (fd < 0)
+            throw std::invalid_argument("map_rgba_file: cannot open " + path);
+
+        struct stat st;
+        const size_t needed {offset + static_cast<size_t>(width) * height * 4};
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < needed) {
+            ::close(fd);
+            throw std::invalid_argument("map_rgba_file: file is smaller than width * height * 4");
+        }
+
+        m_size = static_cast<size_t>(st.st_size);
+        void* map {::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+        ::close(fd);
+        if (map == MAP_FAILED)
+            throw std::invalid_argument("map_rgba_file: cannot map " + path);
+        m_map = static_cast<uint8_t*>(map);
+        ::madvise(m_map, m_size, MADV_SEQUENTIAL);
+    }
+
+    ~MappedFileRowSource() override {
+        ::munmap(m_map, m_size);
+    }
+
+    MappedFileRowSource(const MappedFileRowSource&) = delete;
+    MappedFileRowSource& operator=(const MappedFileRowSource&) = delete;
+
+    int width() const override {
+        return m_width;
+    }
+    int height() const override {
+        return m_height;
+    }
+
+    void read_rows(int y, int count, uint8_t* out) override {
+        img2num::check_row_range(*this, y, count);
+        const size_t begin {m_offset + static_cast<size_t>(y) * row_bytes(*this)};
+        const size_t size {static_cast<size_t>(count) * row_bytes(*this)};
+        std::memcpy(out, m_map + begin, size);
+
+        // the mapping is file-backed and read-only, so dropped pages fault back in if a
+        // later pass needs them
+        const size_t page {static_cast<size_t>(::sysconf(_SC_PAGESIZE))};
+        const size_t release {(begin / page) * page};
+        if (release > 0)
+            ::madvise(m_map, release, MADV_DONTNEED);
+    }
+
+  private:
+    int m_width;
+    int m_height;
+    size_t m_offset;
+    uint8_t* m_map {nullptr};
+    size_t m_size {0};
+};
+#else
+// No mmap on this platform: seek and read the requested rows instead
+class MappedFileRowSource final : public img2num::RowSource {
+  public:
+    MappedFileRowSource(const std::string& path, const int width, const int height, size_t offset)
+        : m_file {path, std::ios::binary}, m_width {width}, m_height {height}, m_offset {offset} {
+        check_dimensions(width, height);
+        if (!m_file)
+            throw std::invalid_argument("map_rgba_file: cannot open " + path);
+        m_file.seekg(0, std::ios::end);
+        const size_t needed {offset + static_cast<size_t>(width) * height * 4};
+        if (static_cast<size_t>(m_file.tellg()) < needed)
+            throw std::invalid_argument("map_rgba_file: file is smaller than width * height * 4");
+    }
+
+    int width() const override {
+        return m_width;
+    }
+    int height() const override {
+        return m_height;
+    }
+
+    void read_rows(int y, int count, uint8_t* out) override {
+        img2num::check_row_range(*this, y, count);
+        m_file.seekg(
+            static_cast<std::streamoff>(m_offset + static_cast<size_t>(y) * row_bytes(*this))
+        );
+        m_file.read(
+            reinterpret_cast<char*>(out),
+            static_cast<std::streamsize>(static_cast<size_t>(count) * row_bytes(*this))
+        );
+        if (!m_file)
+            throw std::invalid_argument("map_rgba_file: read failed");
+    }
+
+  private:
+    std::ifstream m_file;
+    int m_width;
+    int m_height;
+    size_t m_offset;
+};
+#endif
+
+class CallbackRowSource final : public img2num::RowSource {
+  public:
+    CallbackRowSource(
+        const int width, const int height, std::function<void(int y, uint8_t* row)> read_row
+    )
+        : m_width {width}, m_height {height}, m_read_row {std::move(read_row)} {
+        check_dimensions(width, height);
+        if (!m_read_row)
+            throw std::invalid_argument("callback_row_source: read_row is empty");
+    }
+
+    int width() const override {
+        return m_width;
+    }
+    int height() const override {
+        return m_height;
+    }
+
+    void read_rows(int y, int count, uint8_t* out) override {
+        img2num::check_row_range(*this, y, count);
+        for (int i = 0; i < count; ++i)
+            m_read_row(y + i, out + static_cast<size_t>(i) * row_bytes(*this));
+    }
+
+  private:
+    int m_width;
+    int m_height;
+    std::function<void(int y, uint8_t* row)> m_read_row;
+};
+} // namespace
+
+namespace img2num {
+MemoryRowSource::MemoryRowSource(const uint8_t* data, const int width, const int height)
+    : m_image {data, width, height} {
+}
+
+MemoryRowSource::MemoryRowSource(const ImageView& image)
+    : m_image {image} {
+}
+
+void MemoryRowSource::read_rows(int y, int count, uint8_t* out) {
+    check_row_range(*this, y, count);
+    if (is_packed_rgba(m_image)) {
+        std::memcpy(
+            out, m_image.data + static_cast<size_t>(y) * row_bytes(*this),
+            static_cast<size_t>(count) * row_bytes(*this)
+        );
+        return;
+    }
+    for (int i = 0; i < count; ++i)
+        load_rgba_row(m_image, y + i, out + static_cast<size_t>(i) * row_bytes(*this));
+}
+
+void check_row_range(const RowSource& source, const int y, const int count) {
+    if (y < 0 || count < 0 || y > source.height() - count)
+        throw std::invalid_argument("RowSource: rows out of range");
+}
+
+std::unique_ptr<RowSource>
+map_rgba_file(const std::string& path, const int width, const int height, size_t offset) {
+    return std::make_unique<MappedFileRowSource>(path, width, height, offset);
+}
+
+std::unique_ptr<RowSource> callback_row_source(
+    const int width, const int height, std::function<void(int y, uint8_t* row)> read_row
+) {
+    return std::make_unique<CallbackRowSource>(width, height, std::move(read_row));
+}
+} // namespace img2num
@@ -57,8 +57,7 @@ void reverse_curve(std::vector<QuadBezier>& c) {
         std::swap(q.p0, q.p2);
 }
 
-std::unordered_map<int32_t, std::vector<std::vector<QuadBezier>>>
-build_shared_loops(const std::vector<int32_t>& labels, int w, int h, float eps) {
+SharedTopology build_shared_topology(const std::vector<int32_t>& labels, int w, int h, float eps) {
     const int W1 = w + 1; // corner grid width
     auto L = [&](int x, int y) -> int32_t {
         if (x < 0 || x >= w || y < 0 || y >= h)
@@ -94,8 +93,12 @@ build_shared_loops(const std::vector<int32_t>& labels, int w, int h, float eps)
 
     // A corner is a junction wherever its crack degree != 2: degree 3/4 are branch
     // points (incl. diagonal pixel touches), degree 1 is a dangling end. Degree-2
-    // corners are interior to a single two-region edge.
+    // corners are interior to a single two-region edge. The four frame corners are
+    // junctions too, so every edge along the frame is one straight side (tiling
+    // relies on this to splice pieces along its seams).
     auto is_junction = [&](int idx) {
+        if (idx == cidx(0, 0) || idx == cidx(w, 0) || idx == cidx(0, h) || idx == cidx(w, h))
+            return adj.count(idx) > 0;
         auto it = adj.find(idx);
         return it == adj.end() ? false : it->second.size() != 2;
     };
@@ -221,7 +224,7 @@ build_shared_loops(const std::vector<int32_t>& labels, int w, int h, float eps)
     };
 
     // --- 4. Assemble each region's loops from canonical shared curves ---------
-    std::unordered_map<int32_t, std::vector<std::vector<QuadBezier>>> result;
+    SharedTopology result;
     for (auto& rkv : region_dir) {
         int32_t r = rkv.first;
         if (r == OUTSIDE)
@@ -273,7 +276,7 @@ build_shared_loops(const std::vector<int32_t>& labels, int w, int h, float eps)
             }
         }
 
-        std::vector<std::vector<QuadBezier>>& out_loops = result[r];
+        std::vector<std::vector<int32_t>>& out_loops = result.loops[r];
         for (auto& loop : loops) {
             int m = static_cast<int>(loop.size());
             if (m < 2)
@@ -288,7 +291,8 @@ build_shared_loops(const std::vector<int32_t>& labels, int w, int h, float eps)
             if (js > 0)
                 std::rotate(loop.begin(), loop.begin() + js, loop.end());
 
-            std::vector<QuadBezier> curve;
+            std::vector<int32_t> refs;
+            size_t num_curves = 0;
             int i = 0;
             while (i < m) {
                 int from = loop[i];
@@ -298,25 +302,23 @@ build_shared_loops(const std::vector<int32_t>& labels, int w, int h, float eps)
                     ++i;
                     continue;
                 }
-                const Edge& e = edges[eit->second];
-                std::vector<QuadBezier> seg = e.curve;
+                const int32_t id = eit->second;
+                const Edge& e = edges[id];
                 if (e.closed) {
                     int mm = static_cast<int>(e.path.size());
                     int p = 0;
                     while (p < mm && e.path[p] != from)
                         ++p;
                     bool fwd = (p < mm) && (e.path[(p + 1) % mm] == to);
-                    if (!fwd)
-                        reverse_curve(seg);
-                    for (const QuadBezier& q : seg)
-                        curve.push_back(q);
+                    if (!e.curve.empty())
+                        refs.push_back(fwd ? id : ~id);
+                    num_curves += e.curve.size();
                     i = m;
                 } else {
                     bool fwd = (from == e.a);
-                    if (!fwd)
-                        reverse_curve(seg);
-                    for (const QuadBezier& q : seg)
-                        curve.push_back(q);
+                    if (!e.curve.empty())
+                        refs.push_back(fwd ? id : ~id);
+                    num_curves += e.curve.size();
                     int other = fwd ? e.b : e.a;
                     int j = i + 1;
                     while (j < m && loop[j] != other)
@@ -324,10 +326,39 @@ build_shared_loops(const std::vector<int32_t>& labels, int w, int h, float eps)
                     i = j;
                 }
             }
-            if (curve.size() >= 2)
-                out_loops.push_back(std::move(curve));
+            if (num_curves >= 2)
+                out_loops.push_back(std::move(refs));
         }
     }
 
+    result.arcs.reserve(edges.size());
+    for (Edge& e : edges)
+        result.arcs.push_back(std::move(e.curve));
+
+    return result;
+}
+
+std::vector<QuadBezier> expand_loop(const SharedTopology& topo, const std::vector<int32_t>& loop) {
+    std::vector<QuadBezier> curve;
+    for (int32_t ref : loop) {
+        const bool fwd = ref >= 0;
+        std::vector<QuadBezier> seg = topo.arcs[fwd ? ref : ~ref];
+        if (!fwd)
+            reverse_curve(seg);
+        curve.insert(curve.end(), seg.begin(), seg.end());
+    }
+    return curve;
+}
+
+std::unordered_map<int32_t, std::vector<std::vector<QuadBezier>>>
+build_shared_loops(const std::vector<int32_t>& labels, int w, int h, float eps) {
+    const SharedTopology topo = build_shared_topology(labels, w, h, eps);
+
+    std::unordered_map<int32_t, std::vector<std::vector<QuadBezier>>> result;
+    for (const auto& [r, loops] : topo.loops) {
+        std::vector<std::vector<QuadBezier>>& out_loops = result[r];
+        for (const std::vector<int32_t>& loop : loops)
+            out_loops.push_back(expand_loop(topo, loop));
+    }
     return result;
 }
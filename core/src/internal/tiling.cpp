@@ -0,0 +1,798 @@
+#include "internal/tiling.h"
+
+#include "img2num.h"
+#include "internal/bilateral_filter_gpu.h"
+#include "internal/cielab.h"
+#include "internal/cielab_pipeline.h"
+#include "internal/execution.h"
+#include "internal/row_source.h"
+#include "internal/workspace.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+static constexpr uint8_t COLOR_SPACE_OPTION_CIELAB {0};
+static constexpr uint8_t COLOR_SPACE_OPTION_RGB {1};
+
+namespace {
+// Copy the [x0, x1) x [y0, y1) window of an RGBA image into a contiguous buffer
+void copy_window(
+    const uint8_t* data, const int width, const int x0, const int y0, const int x1, const int y1,
+    std::vector<uint8_t>& out
+) {
+    const size_t row_bytes {static_cast<size_t>(x1 - x0) * 4};
+    out.resize(row_bytes * static_cast<size_t>(y1 - y0));
+    for (int y = y0; y < y1; ++y) {
+        std::copy_n(
+            data + (static_cast<size_t>(y) * width + x0) * 4, row_bytes,
+            out.data() + static_cast<size_t>(y - y0) * row_bytes
+        );
+    }
+}
+
+// Box-downscale by an integer factor (edge blocks average fewer pixels), reading the
+// source one row at a time
+void downscale(
+    img2num::RowSource& source, const int factor, int& out_width, int& out_height,
+    std::vector<uint8_t>& out
+) {
+    const int width {source.width()};
+    const int height {source.height()};
+    out_width = (width + factor - 1) / factor;
+    out_height = (height + factor - 1) / factor;
+    out.resize(static_cast<size_t>(out_width) * out_height * 4);
+
+    std::vector<uint8_t> row(static_cast<size_t>(width) * 4);
+    std::vector<uint32_t> sums(static_cast<size_t>(out_width) * 4);
+    std::vector<uint32_t> counts(out_width);
+    for (int oy = 0; oy < out_height; ++oy) {
+        std::fill(sums.begin(), sums.end(), 0);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (int y = oy * factor; y < std::min(height, (oy + 1) * factor); ++y) {
+            source.read_rows(y, 1, row.data());
+            for (int x = 0; x < width; ++x) {
+                const int ox {x / factor};
+                for (int c = 0; c < 4; ++c)
+                    sums[static_cast<size_t>(ox) * 4 + c] += row[static_cast<size_t>(x) * 4 + c];
+                ++counts[ox];
+            }
+        }
+        uint8_t* out_row {out.data() + static_cast<size_t>(oy) * out_width * 4};
+        for (int ox = 0; ox < out_width; ++ox) {
+            for (int c = 0; c < 4; ++c) {
+                out_row[static_cast<size_t>(ox) * 4 + c] = static_cast<uint8_t>(
+                    (sums[static_cast<size_t>(ox) * 4 + c] + counts[ox] / 2) / counts[ox]
+                );
+            }
+        }
+    }
+}
+
+/*
+Rows [y0, y1) of the source, kept across tile rows: moving down keeps the rows the
+two bands share (the filter halo) and reads only the new ones, so every source row
+is read once and in order.
+*/
+class RowBand {
+  public:
+    explicit RowBand(img2num::RowSource& source)
+        : m_source {source}, m_row_bytes {static_cast<size_t>(source.width()) * 4} {
+    }
+
+    void advance(const int y0, const int y1) {
+        const int keep {std::max(0, m_y1 - std::max(y0, m_y0))};
+        if (keep > 0) {
+            std::memmove(
+                m_rows.data(), m_rows.data() + static_cast<size_t>(y0 - m_y0) * m_row_bytes,
+                static_cast<size_t>(keep) * m_row_bytes
+            );
+        }
+        m_rows.resize(static_cast<size_t>(y1 - y0) * m_row_bytes);
+        m_source.read_rows(
+            y0 + keep, y1 - y0 - keep, m_rows.data() + static_cast<size_t>(keep) * m_row_bytes
+        );
+        m_y0 = y0;
+        m_y1 = y1;
+    }
+
+    // Pixel (0, y0) of the band
+    const uint8_t* data() const {
+        return m_rows.data();
+    }
+    int y0() const {
+        return m_y0;
+    }
+
+  private:
+    img2num::RowSource& m_source;
+    size_t m_row_bytes;
+    std::vector<uint8_t> m_rows;
+    int m_y0 {0};
+    int m_y1 {0};
+};
+
+/*
+Bilateral-filter an RGBA block and write 3 floats per pixel in the space k-means
+clusters in (L, a, b or R, G, B). `block` is filtered in place unless the fused
+CIELAB path is taken, which filters straight into workspace.lab.
+*/
+void filtered_features(
+    std::vector<uint8_t>& block, const int width, const int height, const double sigma_spatial,
+    const img2num::ImageToSvgConfig& config, const bool gpu_available,
+    img2num::Workspace& workspace, std::vector<float>& features
+) {
+    const size_t num_pixels {static_cast<size_t>(width) * static_cast<size_t>(height)};
+    features.resize(num_pixels * 3);
+    const bool cielab {config.color_space == COLOR_SPACE_OPTION_CIELAB};
+    const bool use_gpu {img2num::bilateral_filter_on_gpu(
+        config.execution, gpu_available, static_cast<int64_t>(num_pixels)
+    )};
+
+    if (cielab && !use_gpu) {
+        img2num::MemoryRowSource source {block.data(), width, height};
+        bilateral_filter_lab_cpu(
+            source, sigma_spatial, config.bilateral_filter.sigma_range, workspace.lab,
+            workspace.bilateral
+        );
+        for (size_t i = 0; i < num_pixels; ++i) {
+            const ImageLib::LABAPixel<float>& p {workspace.lab[static_cast<int>(i)]};
+            features[i * 3] = p.l;
+            features[i * 3 + 1] = p.a;
+            features[i * 3 + 2] = p.b;
+        }
+        return;
+    }
+
+    if (use_gpu) {
+        bilateral_filter_gpu(
+            block.data(), width, height, sigma_spatial, config.bilateral_filter.sigma_range,
+            config.color_space
+        );
+    } else {
+        bilateral_filter_cpu(
+            block.data(), width, height, sigma_spatial, config.bilateral_filter.sigma_range,
+            config.color_space, workspace.bilateral
+        );
+    }
+    for (size_t i = 0; i < num_pixels; ++i) {
+        const uint8_t* p {&block[i * 4]};
+        if (cielab) {
+            rgb_to_lab<uint8_t, float>(
+                p[0], p[1], p[2], features[i * 3], features[i * 3 + 1], features[i * 3 + 2]
+            );
+        } else {
+            features[i * 3] = p[0];
+            features[i * 3 + 1] = p[1];
+            features[i * 3 + 2] = p[2];
+        }
+    }
+}
+
+// K-means centroids shared by every tile; clusters left empty are never assigned
+class Palette {
+  public:
+    // Learn the palette from a downscaled copy of the image
+    Palette(
+        img2num::RowSource& source, const img2num::ImageToSvgConfig& config, const bool use_gpu,
+        img2num::Workspace& workspace
+    ) {
+        const double num_pixels {
+            static_cast<double>(source.width()) * static_cast<double>(source.height())};
+        const int factor {std::max(
+            1, static_cast<int>(std::ceil(std::sqrt(num_pixels / config.tiling.palette_samples)))
+        )};
+
+        int sample_width, sample_height;
+        std::vector<uint8_t> sample;
+        downscale(source, factor, sample_width, sample_height, sample);
+
+        std::vector<float> features;
+        filtered_features(
+            sample, sample_width, sample_height, config.bilateral_filter.sigma_spatial / factor,
+            config, use_gpu, workspace, features
+        );
+
+        const size_t sample_pixels {
+            static_cast<size_t>(sample_width) * static_cast<size_t>(sample_height)};
+        std::vector<int32_t>& labels {workspace.labels};
+        labels.resize(sample_pixels);
+        if (config.color_space == COLOR_SPACE_OPTION_CIELAB) {
+            LabImage& lab {workspace.lab};
+            lab.resize(sample_width, sample_height);
+            for (size_t i = 0; i < sample_pixels; ++i)
+                lab[static_cast<int>(i)] = {
+                    features[i * 3], features[i * 3 + 1], features[i * 3 + 2], 255.0f};
+            kmeans_lab_cpu(
+                lab, labels.data(), config.kmeans.k, config.kmeans.max_iter, nullptr,
+                &workspace.kmeans
+            );
+        } else {
+            kmeans_cpu(
+                sample.data(), nullptr, labels.data(), sample_width, sample_height,
+                config.kmeans.k, config.kmeans.max_iter, COLOR_SPACE_OPTION_RGB,
+                workspace.kmeans
+            );
+        }
+
+        // centroid = mean feature of its members (what k-means converges to)
+        std::vector<double> sums(static_cast<size_t>(config.kmeans.k) * 3, 0.0);
+        std::vector<size_t> counts(config.kmeans.k, 0);
+        for (size_t i = 0; i < sample_pixels; ++i) {
+            const size_t c {static_cast<size_t>(labels[i])};
+            for (size_t j = 0; j < 3; ++j)
+                sums[c * 3 + j] += features[i * 3 + j];
+            ++counts[c];
+        }
+        for (int32_t c = 0; c < config.kmeans.k; ++c) {
+            if (counts[c] == 0)
+                continue;
+            m_ids.push_back(c);
+            for (size_t j = 0; j < 3; ++j)
+                m_centroids.push_back(static_cast<float>(sums[c * 3 + j] / counts[c]));
+        }
+    }
+
+    int32_t nearest(const float* f) const {
+        int32_t best {0};
+        float best_dist {std::numeric_limits<float>::max()};
+        for (size_t c = 0; c < m_ids.size(); ++c) {
+            const float d0 {f[0] - m_centroids[c * 3]};
+            const float d1 {f[1] - m_centroids[c * 3 + 1]};
+            const float d2 {f[2] - m_centroids[c * 3 + 2]};
+            const float dist {d0 * d0 + d1 * d1 + d2 * d2};
+            if (dist < best_dist) {
+                best_dist = dist;
+                best = m_ids[c];
+            }
+        }
+        return best;
+    }
+
+  private:
+    std::vector<int32_t> m_ids;
+    std::vector<float> m_centroids;
+};
+
+// Union-find over region pieces (one per region per tile)
+class PieceSets {
+  public:
+    int32_t add() {
+        m_parent.push_back(static_cast<int32_t>(m_parent.size()));
+        return m_parent.back();
+    }
+    int32_t find(int32_t p) {
+        while (m_parent[p] != p) {
+            m_parent[p] = m_parent[m_parent[p]];
+            p = m_parent[p];
+        }
+        return p;
+    }
+    void unite(int32_t a, int32_t b) {
+        a = find(a);
+        b = find(b);
+        // the lower id wins so merged regions keep the position of their first piece
+        if (a != b)
+            m_parent[std::max(a, b)] = std::min(a, b);
+    }
+
+  private:
+    std::vector<int32_t> m_parent;
+};
+
+// Region piece and palette color of one pixel on a tile edge
+struct EdgePixel {
+    int32_t piece {-1};
+    int32_t color {-1};
+};
+
+/*
+Pixels on either side of a seam are the same region if they share a palette
+color; otherwise their regions are neighbours. Pairs already seen on the
+previous pixel are skipped, which removes most duplicates cheaply.
+*/
+void stitch(
+    PieceSets& sets, const EdgePixel& a, const EdgePixel& b,
+    std::vector<std::pair<int32_t, int32_t>>& neighbours
+) {
+    if (a.piece < 0 || b.piece < 0)
+        return;
+    if (a.color == b.color) {
+        sets.unite(a.piece, b.piece);
+    } else if (neighbours.empty() || neighbours.back() != std::make_pair(a.piece, b.piece)) {
+        neighbours.emplace_back(a.piece, b.piece);
+    }
+}
+
+// Append one tile's regions to `pieces`, moving its curves to image coordinates
+void append_tile(
+    img2num::VectorizationResult& pieces, const img2num::VectorizationResult& tile,
+    const int32_t first_piece, const float x0, const float y0
+) {
+    if (pieces.region_loop_offsets.empty()) {
+        pieces.region_loop_offsets.push_back(0);
+        pieces.loop_curve_offsets.push_back(0);
+        pieces.adjacency_offsets.push_back(0);
+    }
+    pieces.colors.insert(pieces.colors.end(), tile.colors.begin(), tile.colors.end());
+    pieces.areas.insert(pieces.areas.end(), tile.areas.begin(), tile.areas.end());
+
+    const int32_t loop_base {static_cast<int32_t>(pieces.num_loops())};
+    for (size_t r = 1; r < tile.region_loop_offsets.size(); ++r)
+        pieces.region_loop_offsets.push_back(loop_base + tile.region_loop_offsets[r]);
+
+    const int32_t curve_base {static_cast<int32_t>(pieces.num_curves())};
+    for (size_t l = 1; l < tile.loop_curve_offsets.size(); ++l)
+        pieces.loop_curve_offsets.push_back(curve_base + tile.loop_curve_offsets[l]);
+    for (size_t i = 0; i < tile.curves.size(); ++i)
+        pieces.curves.push_back(tile.curves[i] + (i % 2 == 0 ? x0 : y0));
+
+    const int32_t adjacency_base {static_cast<int32_t>(pieces.adjacency.size())};
+    for (size_t r = 1; r < tile.adjacency_offsets.size(); ++r)
+        pieces.adjacency_offsets.push_back(adjacency_base + tile.adjacency_offsets[r]);
+    for (int32_t n : tile.adjacency)
+        pieces.adjacency.push_back(first_piece + n);
+}
+
+/*
+Merge regions still smaller than `min_area` once stitched: pieces touching a seam are
+exempt from small-region merging inside their tile, so a speck cut by a seam only
+shows its size here. Neighbours are scored as in Graph::merge_small_area_nodes.
+*/
+void merge_small_regions(
+    const img2num::VectorizationResult& pieces, PieceSets& sets,
+    const std::vector<std::pair<int32_t, int32_t>>& neighbours, const int min_area
+) {
+    const size_t num_pieces {pieces.num_regions()};
+    std::vector<std::pair<int32_t, int32_t>> links {neighbours};
+    for (size_t p = 0; p < num_pieces; ++p) {
+        for (int32_t i = pieces.adjacency_offsets[p]; i < pieces.adjacency_offsets[p + 1]; ++i)
+            links.emplace_back(static_cast<int32_t>(p), pieces.adjacency[i]);
+    }
+
+    // area and area-weighted color sums, kept at each set's root
+    std::vector<int64_t> areas(num_pieces, 0);
+    std::vector<double> color_sums(num_pieces * 3, 0.0);
+    for (size_t p = 0; p < num_pieces; ++p) {
+        const size_t root {static_cast<size_t>(sets.find(static_cast<int32_t>(p)))};
+        areas[root] += pieces.areas[p];
+        for (size_t c = 0; c < 3; ++c)
+            color_sums[root * 3 + c] +=
+                static_cast<double>(pieces.colors[p * 3 + c]) * pieces.areas[p];
+    }
+    auto color = [&](const size_t root, const size_t c) {
+        return static_cast<float>(
+            std::lround(color_sums[root * 3 + c] / std::max<int64_t>(1, areas[root]))
+        );
+    };
+
+    bool merged_any {true};
+    while (merged_any) {
+        merged_any = false;
+
+        // neighbouring sets, grouped by set
+        std::vector<std::pair<int32_t, int32_t>> pairs;
+        for (const std::pair<int32_t, int32_t>& l : links) {
+            const int32_t a {sets.find(l.first)};
+            const int32_t b {sets.find(l.second)};
+            if (a != b) {
+                pairs.emplace_back(a, b);
+                pairs.emplace_back(b, a);
+            }
+        }
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+        for (size_t i = 0; i < pairs.size();) {
+            size_t end {i};
+            while (end < pairs.size() && pairs[end].first == pairs[i].first)
+                ++end;
+            const int32_t a {sets.find(pairs[i].first)};
+            if (areas[a] >= min_area) {
+                i = end;
+                continue;
+            }
+
+            int32_t best {-1};
+            float best_score {std::numeric_limits<float>::max()};
+            for (; i < end; ++i) {
+                const int32_t b {sets.find(pairs[i].second)};
+                if (b == a)
+                    continue;
+                float dist {0.0f};
+                for (size_t c = 0; c < 3; ++c)
+                    dist += (color(a, c) - color(b, c)) * (color(a, c) - color(b, c));
+                const float score {static_cast<float>(areas[b]) + 10.0f * std::sqrt(dist)};
+                if (score < best_score) {
+                    best_score = score;
+                    best = b;
+                }
+            }
+            if (best < 0)
+                continue;
+
+            sets.unite(a, best);
+            const int32_t root {sets.find(a)};
+            const int32_t other {root == a ? best : a};
+            areas[root] += areas[other];
+            for (size_t c = 0; c < 3; ++c)
+                color_sums[root * 3 + c] += color_sums[other * 3 + c];
+            merged_any = true;
+        }
+    }
+}
+
+// Seam line a straight curve lies on: axis 0 is the vertical line x = `line`, axis 1
+// the horizontal line y = `line`. Image frame sides are not seams.
+bool on_seam(
+    const float* curve, const int tile_size, const int width, const int height, int& axis,
+    int& line
+) {
+    // control points are fitted, so they may sit a rounding error off the line
+    constexpr float CONTROL_TOLERANCE {1e-3f};
+    const int sizes[2] {width, height};
+    for (axis = 0; axis < 2; ++axis) {
+        const float v {curve[axis]};
+        line = static_cast<int>(v);
+        if (static_cast<float>(line) == v && line > 0 && line < sizes[axis] &&
+            line % tile_size == 0 && curve[axis + 4] == v &&
+            std::abs(curve[axis + 2] - v) <= CONTROL_TOLERANCE)
+            return true;
+    }
+    return false;
+}
+
+/*
+Outline of one region from the loops of its stitched pieces. Tile contours pin
+their seam sides, so the boundary a piece draws along a seam is a straight run
+between pixel corners (the frame corners of a tile are contour junctions). Split
+into unit steps, the runs two pieces draw along the cracks they share cancel;
+curves shared by pieces merged as too small cancel against their exact reverse.
+What is left is chained back into closed loops, joining straight seam steps.
+*/
+void splice_region(
+    const img2num::VectorizationResult& pieces, const int32_t* region_pieces,
+    const size_t count, const int tile_size, img2num::VectorizationResult& result
+) {
+    using Curve = std::array<float, 6>;
+    std::vector<Curve> kept;
+    std::vector<std::array<int32_t, 4>> steps; // axis, line, position, direction
+    std::map<Curve, std::vector<size_t>> open; // uncancelled curves, by their points
+
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t p {region_pieces[i]};
+        for (int32_t c = pieces.loop_curve_offsets[pieces.region_loop_offsets[p]];
+             c < pieces.loop_curve_offsets[pieces.region_loop_offsets[p + 1]]; ++c) {
+            const float* q {&pieces.curves[6 * static_cast<size_t>(c)]};
+            int axis, line;
+            if (on_seam(q, tile_size, result.width, result.height, axis, line)) {
+                const int32_t from {static_cast<int32_t>(q[1 - axis])};
+                const int32_t to {static_cast<int32_t>(q[5 - axis])};
+                for (int32_t s = std::min(from, to); s < std::max(from, to); ++s)
+                    steps.push_back({axis, line, s, to > from ? 1 : -1});
+                continue;
+            }
+
+            const Curve curve {q[0], q[1], q[2], q[3], q[4], q[5]};
+            const Curve reverse {q[4], q[5], q[2], q[3], q[0], q[1]};
+            auto it {open.find(reverse)};
+            if (it != open.end() && !it->second.empty()) {
+                kept[it->second.back()][0] = std::numeric_limits<float>::quiet_NaN();
+                it->second.pop_back();
+                continue;
+            }
+            open[curve].push_back(kept.size());
+            kept.push_back(curve);
+        }
+    }
+    kept.erase(
+        std::remove_if(
+            kept.begin(), kept.end(), [](const Curve& q) { return std::isnan(q[0]); }
+        ),
+        kept.end()
+    );
+
+    // seam steps drawn by one piece only remain, as straight unit curves
+    std::sort(steps.begin(), steps.end());
+    const size_t first_step {kept.size()};
+    for (size_t i = 0; i < steps.size();) {
+        int32_t direction {0};
+        size_t end {i};
+        for (; end < steps.size() && steps[end][0] == steps[i][0] &&
+               steps[end][1] == steps[i][1] && steps[end][2] == steps[i][2];
+             ++end)
+            direction += steps[end][3];
+        if (direction != 0) {
+            const float line {static_cast<float>(steps[i][1])};
+            const float a {static_cast<float>(steps[i][2] + (direction < 0 ? 1 : 0))};
+            const float b {static_cast<float>(steps[i][2] + (direction < 0 ? 0 : 1))};
+            const float mid {0.5f * (a + b)};
+            kept.push_back(
+                steps[i][0] == 0 ? Curve {line, a, line, mid, line, b}
+                                 : Curve {a, line, mid, line, b, line}
+            );
+        }
+        i = end;
+    }
+
+    std::map<std::pair<float, float>, std::vector<size_t>> starts;
+    for (size_t i = kept.size(); i-- > 0;)
+        starts[{kept[i][0], kept[i][1]}].push_back(i);
+
+    // consecutive seam steps in the same direction become one straight curve
+    auto same_run = [&](const Curve& a, const Curve& b) {
+        return (a[0] == a[4] && b[0] == b[4] && (a[5] > a[1]) == (b[5] > b[1])) ||
+               (a[1] == a[5] && b[1] == b[5] && (a[4] > a[0]) == (b[4] > b[0]));
+    };
+    std::vector<uint8_t> used(kept.size(), 0);
+    std::vector<Curve> loop;
+    std::vector<uint8_t> straight;
+    for (size_t s = 0; s < kept.size(); ++s) {
+        if (used[s])
+            continue;
+        loop.clear();
+        straight.clear();
+        for (size_t c = s;;) {
+            used[c] = 1;
+            const bool step {c >= first_step};
+            if (step && !straight.empty() && straight.back() && same_run(loop.back(), kept[c])) {
+                Curve& run {loop.back()};
+                run[4] = kept[c][4];
+                run[5] = kept[c][5];
+                run[2] = 0.5f * (run[0] + run[4]);
+                run[3] = 0.5f * (run[1] + run[5]);
+            } else {
+                loop.push_back(kept[c]);
+                straight.push_back(step);
+            }
+            if (kept[c][4] == kept[s][0] && kept[c][5] == kept[s][1])
+                break;
+
+            std::vector<size_t>& next {starts[{kept[c][4], kept[c][5]}]};
+            while (!next.empty() && used[next.back()])
+                next.pop_back();
+            if (next.empty())
+                break;
+            c = next.back();
+        }
+        // a run may continue across the loop's start
+        if (loop.size() > 1 && straight.front() && straight.back() &&
+            same_run(loop.back(), loop.front())) {
+            loop.front()[0] = loop.back()[0];
+            loop.front()[1] = loop.back()[1];
+            loop.front()[2] = 0.5f * (loop.front()[0] + loop.front()[4]);
+            loop.front()[3] = 0.5f * (loop.front()[1] + loop.front()[5]);
+            loop.pop_back();
+        }
+
+        for (const Curve& q : loop)
+            result.curves.insert(result.curves.end(), q.begin(), q.end());
+        result.loop_curve_offsets.push_back(static_cast<int32_t>(result.num_curves()));
+    }
+}
+
+// Collapse stitched pieces into regions; regions take the order of their first piece
+img2num::VectorizationResult merge_pieces(
+    const img2num::VectorizationResult& pieces, PieceSets& sets,
+    std::vector<std::pair<int32_t, int32_t>>& neighbours, const int width, const int height,
+    const int tile_size
+) {
+    const size_t num_pieces {pieces.num_regions()};
+    std::vector<int32_t> region_of(num_pieces);
+    size_t num_regions {0};
+    for (size_t p = 0; p < num_pieces; ++p) {
+        const int32_t root {sets.find(static_cast<int32_t>(p))};
+        region_of[p] = root == static_cast<int32_t>(p) ? static_cast<int32_t>(num_regions++)
+                                                       : region_of[root];
+    }
+
+    img2num::VectorizationResult result;
+    result.width = width;
+    result.height = height;
+
+    // areas and area-weighted colors
+    result.areas.assign(num_regions, 0);
+    std::vector<double> color_sums(num_regions * 3, 0.0);
+    for (size_t p = 0; p < num_pieces; ++p) {
+        const int32_t r {region_of[p]};
+        result.areas[r] += pieces.areas[p];
+        for (size_t c = 0; c < 3; ++c)
+            color_sums[r * 3 + c] +=
+                static_cast<double>(pieces.colors[p * 3 + c]) * pieces.areas[p];
+    }
+    result.colors.resize(num_regions * 3);
+    for (size_t r = 0; r < num_regions; ++r) {
+        for (size_t c = 0; c < 3; ++c) {
+            const double area {std::max<double>(1.0, result.areas[r])};
+            result.colors[r * 3 + c] =
+                static_cast<uint8_t>(std::lround(color_sums[r * 3 + c] / area));
+        }
+    }
+
+    // loops grouped by region: a single piece keeps its own, stitched ones are spliced
+    std::vector<int32_t> piece_order(num_pieces);
+    std::iota(piece_order.begin(), piece_order.end(), 0);
+    std::stable_sort(piece_order.begin(), piece_order.end(), [&](int32_t a, int32_t b) {
+        return region_of[a] < region_of[b];
+    });
+    result.region_loop_offsets.push_back(0);
+    result.loop_curve_offsets.push_back(0);
+    result.curves.reserve(pieces.curves.size());
+    size_t next {0};
+    for (size_t r = 0; r < num_regions; ++r) {
+        const size_t first {next};
+        while (next < num_pieces && region_of[piece_order[next]] == static_cast<int32_t>(r))
+            ++next;
+        if (next - first > 1) {
+            splice_region(pieces, &piece_order[first], next - first, tile_size, result);
+        } else {
+            const int32_t p {piece_order[first]};
+            for (int32_t l = pieces.region_loop_offsets[p]; l < pieces.region_loop_offsets[p + 1];
+                 ++l) {
+                result.curves.insert(
+                    result.curves.end(),
+                    pieces.curves.begin() + 6 * static_cast<size_t>(pieces.loop_curve_offsets[l]),
+                    pieces.curves.begin() +
+                        6 * static_cast<size_t>(pieces.loop_curve_offsets[l + 1])
+                );
+                result.loop_curve_offsets.push_back(static_cast<int32_t>(result.num_curves()));
+            }
+        }
+        result.region_loop_offsets.push_back(static_cast<int32_t>(result.num_loops()));
+    }
+
+    // adjacency: within tiles plus across seams, deduplicated
+    std::vector<std::pair<int32_t, int32_t>> pairs;
+    for (size_t p = 0; p < num_pieces; ++p) {
+        for (int32_t i = pieces.adjacency_offsets[p]; i < pieces.adjacency_offsets[p + 1]; ++i)
+            pairs.emplace_back(region_of[p], region_of[pieces.adjacency[i]]);
+    }
+    for (const std::pair<int32_t, int32_t>& n : neighbours) {
+        pairs.emplace_back(region_of[n.first], region_of[n.second]);
+        pairs.emplace_back(region_of[n.second], region_of[n.first]);
+    }
+    neighbours.clear();
+    neighbours.shrink_to_fit();
+    pairs.erase(
+        std::remove_if(
+            pairs.begin(), pairs.end(),
+            [](const std::pair<int32_t, int32_t>& e) { return e.first == e.second; }
+        ),
+        pairs.end()
+    );
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    result.adjacency_offsets.assign(num_regions + 1, 0);
+    for (const std::pair<int32_t, int32_t>& e : pairs)
+        ++result.adjacency_offsets[e.first + 1];
+    std::partial_sum(
+        result.adjacency_offsets.begin(), result.adjacency_offsets.end(),
+        result.adjacency_offsets.begin()
+    );
+    result.adjacency.reserve(pairs.size());
+    for (const std::pair<int32_t, int32_t>& e : pairs)
+        result.adjacency.push_back(e.second);
+
+    return result;
+}
+} // namespace
+
+namespace img2num {
+bool uses_tiling(const int width, const int height, const ImageToSvgConfig& config) {
+    const int tile_size {config.tiling.tile_size};
+    return tile_size > 0 && (width > tile_size || height > tile_size);
+}
+
+VectorizationResult tiled_vectorization(
+    RowSource& source, const ImageToSvgConfig& config, const bool use_gpu, Workspace& workspace
+) {
+    if (config.tiling.tile_size <= 0)
+        throw std::invalid_argument("tiled_vectorization: tile_size must be positive");
+    if (config.tiling.palette_samples <= 0)
+        throw std::invalid_argument("tiled_vectorization: palette_samples must be positive");
+    if (config.kmeans.k <= 0)
+        throw std::invalid_argument("tiled_vectorization: k must be positive");
+
+    const int width {source.width()};
+    const int height {source.height()};
+    const Palette palette {source, config, use_gpu, workspace};
+
+    const int tile_size {config.tiling.tile_size};
+    // the CPU and GPU filters share this radius, so one halo covers either
+    const int halo {bilateral_kernel_radius(std::max(0.0, config.bilateral_filter.sigma_spatial))};
+
+    RowBand band {source};         // one row of tiles plus halos
+    std::vector<uint8_t> block;    // tile + halo, filtered in place
+    std::vector<float> features;   // filtered block in k-means space
+    std::vector<uint8_t> tile_rgba; // unfiltered tile core (region colors)
+
+    VectorizationResult pieces;
+    PieceSets sets;
+    std::vector<std::pair<int32_t, int32_t>> neighbours; // pieces adjacent across a seam
+
+    // bottom row of the previous tile row, and right column of the previous tile
+    std::vector<EdgePixel> above(width), below(width), left;
+
+    for (int y0 = 0; y0 < height; y0 += tile_size) {
+        const int y1 {std::min(height, y0 + tile_size)};
+        left.assign(y1 - y0, EdgePixel {});
+        band.advance(std::max(0, y0 - halo), std::min(height, y1 + halo));
+
+        for (int x0 = 0; x0 < width; x0 += tile_size) {
+            const int x1 {std::min(width, x0 + tile_size)};
+            const int tile_width {x1 - x0};
+            const int tile_height {y1 - y0};
+
+            // 1. filter the tile with its halo, assign palette colors to the core
+            const int hx0 {std::max(0, x0 - halo)};
+            const int hy0 {std::max(0, y0 - halo)};
+            const int hx1 {std::min(width, x1 + halo)};
+            const int hy1 {std::min(height, y1 + halo)};
+            copy_window(band.data(), width, hx0, hy0 - band.y0(), hx1, hy1 - band.y0(), block);
+            filtered_features(
+                block, hx1 - hx0, hy1 - hy0, config.bilateral_filter.sigma_spatial, config,
+                use_gpu, workspace, features
+            );
+
+            std::vector<int32_t>& labels {workspace.labels};
+            labels.resize(static_cast<size_t>(tile_width) * tile_height);
+            for (int y = y0; y < y1; ++y) {
+                const float* row {
+                    &features[(static_cast<size_t>(y - hy0) * (hx1 - hx0) + (x0 - hx0)) * 3]};
+                int32_t* out {&labels[static_cast<size_t>(y - y0) * tile_width]};
+                for (int x = 0; x < tile_width; ++x)
+                    out[x] = palette.nearest(row + static_cast<size_t>(x) * 3);
+            }
+
+            // 2. vectorize the core on its own; seams are pinned like the image frame
+            const uint8_t seams {static_cast<uint8_t>(
+                (x0 > 0 ? SEAM_LEFT : 0) | (y0 > 0 ? SEAM_TOP : 0) |
+                (x1 < width ? SEAM_RIGHT : 0) | (y1 < height ? SEAM_BOTTOM : 0)
+            )};
+            copy_window(band.data(), width, x0, y0 - band.y0(), x1, y1 - band.y0(), tile_rgba);
+            VectorizationResult tile {labels_to_vectorization(
+                ImageView {tile_rgba.data(), tile_width, tile_height}, labels.data(),
+                config.min_cluster_area, config.min_thickness, workspace, false, seams
+            )};
+            // region index per tile pixel, left in the workspace by labels_to_vectorization
+            const std::vector<int32_t>& regions {workspace.region_labels};
+
+            const int32_t first_piece {static_cast<int32_t>(pieces.num_regions())};
+            for (size_t r = 0; r < tile.num_regions(); ++r)
+                sets.add();
+            append_tile(pieces, tile, first_piece, static_cast<float>(x0), static_cast<float>(y0));
+
+            // 3. stitch with the tiles above and to the left, then record this tile's edges
+            auto edge_pixel = [&](int x, int y) {
+                const size_t i {static_cast<size_t>(y - y0) * tile_width + (x - x0)};
+                const int32_t region {regions[i]};
+                return region < 0 ? EdgePixel {} : EdgePixel {first_piece + region, labels[i]};
+            };
+            for (int y = y0; y < y1; ++y) {
+                if (x0 > 0)
+                    stitch(sets, left[y - y0], edge_pixel(x0, y), neighbours);
+                left[y - y0] = edge_pixel(x1 - 1, y);
+            }
+            for (int x = x0; x < x1; ++x) {
+                if (y0 > 0)
+                    stitch(sets, above[x], edge_pixel(x, y0), neighbours);
+                below[x] = edge_pixel(x, y1 - 1);
+            }
+        }
+        above.swap(below);
+    }
+
+    merge_small_regions(pieces, sets, neighbours, config.min_cluster_area);
+    return merge_pieces(pieces, sets, neighbours, width, height, tile_size);
+}
+} // namespace img2num
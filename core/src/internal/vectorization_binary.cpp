@@ -0,0 +1,292 @@
+#include "img2num.h"
+#include "internal/vectorization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/*
+Binary container layout (version 1, little-endian):
+
+    header      VectorizationBinaryHeader (104 bytes)
+    palette     uint8_t[4] RGBA         x num_colors
+    regions     VectorizationBinaryRegion x num_regions
+    loops       VectorizationBinaryLoop   x num_loops
+    curves      float32[6] or int16[6]  x num_curves
+    adj offsets uint32                  x num_regions + 1
+    adjacency   uint32                  x num_adjacency
+    labels      int32                   x width * height (optional)
+
+Every section starts on an 8-byte boundary so that a memory-mapped file can be
+used in place; the header records each section offset explicitly.
+*/
+
+static constexpr char BINARY_MAGIC[4] {'I', '2', 'N', 'V'};
+static constexpr uint16_t BINARY_VERSION {1};
+static constexpr uint16_t BINARY_FLAG_INT16_POINTS {1 << 0};
+static constexpr uint16_t BINARY_FLAG_LABELS {1 << 1};
+static constexpr uint8_t POINT_FORMAT_FLOAT32 {0};
+static constexpr uint8_t POINT_FORMAT_INT16 {1};
+static constexpr size_t SECTION_ALIGNMENT {8};
+
+enum Section {
+    SECTION_PALETTE = 0,
+    SECTION_REGIONS,
+    SECTION_LOOPS,
+    SECTION_CURVES,
+    SECTION_ADJACENCY_OFFSETS,
+    SECTION_ADJACENCY,
+    SECTION_LABELS,
+    SECTION_END
+};
+
+static_assert(sizeof(img2num::VectorizationBinaryHeader) == 104, "header layout changed");
+static_assert(sizeof(img2num::VectorizationBinaryRegion) == 16, "region layout changed");
+static_assert(sizeof(img2num::VectorizationBinaryLoop) == 8, "loop layout changed");
+static_assert(sizeof(float) == 4, "float32 required");
+
+static bool host_is_little_endian() {
+    const uint16_t probe {1};
+    uint8_t first_byte;
+    std::memcpy(&first_byte, &probe, 1);
+    return first_byte == 1;
+}
+
+// Appends values in little-endian byte order regardless of the host
+class LittleEndianWriter {
+  public:
+    explicit LittleEndianWriter(std::vector<uint8_t>& out)
+        : m_out(out) {
+    }
+
+    template <typename T> void put(T value) {
+        static_assert(std::is_arithmetic<T>::value, "arithmetic types only");
+        uint8_t bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        if (!host_is_little_endian()) {
+            for (size_t i = 0; i < sizeof(T) / 2; ++i)
+                std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+        }
+        m_out.insert(m_out.end(), bytes, bytes + sizeof(T));
+    }
+
+    void put_bytes(const char* bytes, size_t n) {
+        m_out.insert(m_out.end(), bytes, bytes + n);
+    }
+
+    void align() {
+        while (m_out.size() % SECTION_ALIGNMENT != 0)
+            m_out.push_back(0);
+    }
+
+    size_t size() const {
+        return m_out.size();
+    }
+
+  private:
+    std::vector<uint8_t>& m_out;
+};
+
+// Largest coordinate magnitude to store: the frame, or beyond it where quadratic control
+// points overshoot
+static double point_extent(const img2num::VectorizationResult& result) {
+    double extent {static_cast<double>(std::max(result.width, result.height))};
+    for (float v : result.curves)
+        extent = std::max(extent, std::fabs(static_cast<double>(v)));
+    return extent;
+}
+
+// Finest power-of-two step such that every coordinate up to `extent` fits in int16
+static double auto_int16_grid(const double extent) {
+    double grid {1.0 / 256.0};
+    while (extent / grid > 32767.0)
+        grid *= 2.0;
+    return grid;
+}
+
+namespace img2num {
+std::vector<uint8_t> vectorization_to_binary(
+    const VectorizationResult& result, const VectorizationBinaryConfig& config
+) {
+    if (config.point_format != POINT_FORMAT_FLOAT32 && config.point_format != POINT_FORMAT_INT16)
+        throw std::invalid_argument("vectorization_to_binary: unknown point format");
+    if (config.grid < 0.0)
+        throw std::invalid_argument("vectorization_to_binary: grid must not be negative");
+    validate_vectorization(result, "vectorization_to_binary");
+
+    const bool int16_points {config.point_format == POINT_FORMAT_INT16};
+    const double extent {int16_points ? point_extent(result) : 0.0};
+    const double grid {
+        !int16_points ? 1.0 : config.grid > 0.0 ? config.grid : auto_int16_grid(extent)};
+    if (int16_points && extent / grid > 32767.0)
+        throw std::invalid_argument("vectorization_to_binary: grid too fine for int16 points");
+
+    const size_t num_pixels {
+        static_cast<size_t>(result.width) * static_cast<size_t>(result.height)};
+    const bool include_labels {config.include_labels && result.labels.size() == num_pixels};
+
+    // deduplicate region colors, keeping first-appearance order
+    std::map<uint32_t, uint32_t> palette_index;
+    std::vector<uint32_t> palette;
+    std::vector<uint32_t> region_colors(result.num_regions());
+    for (size_t r = 0; r < result.num_regions(); ++r) {
+        const uint32_t rgba {
+            static_cast<uint32_t>(result.colors[3 * r]) |
+            static_cast<uint32_t>(result.colors[3 * r + 1]) << 8 |
+            static_cast<uint32_t>(result.colors[3 * r + 2]) << 16 | 0xFF000000u};
+        auto it = palette_index.find(rgba);
+        if (it == palette_index.end()) {
+            it = palette_index.emplace(rgba, static_cast<uint32_t>(palette.size())).first;
+            palette.push_back(rgba);
+        }
+        region_colors[r] = it->second;
+    }
+
+    std::vector<uint8_t> out;
+    LittleEndianWriter w(out);
+    uint64_t offsets[SECTION_END + 1] {};
+
+    // header (offsets are patched in once the sections are written)
+    w.put_bytes(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    w.put<uint16_t>(BINARY_VERSION);
+    w.put<uint16_t>(
+        (int16_points ? BINARY_FLAG_INT16_POINTS : 0) | (include_labels ? BINARY_FLAG_LABELS : 0)
+    );
+    w.put<uint32_t>(static_cast<uint32_t>(result.width));
+    w.put<uint32_t>(static_cast<uint32_t>(result.height));
+    w.put<uint32_t>(static_cast<uint32_t>(palette.size()));
+    w.put<uint32_t>(static_cast<uint32_t>(result.num_regions()));
+    w.put<uint32_t>(static_cast<uint32_t>(result.num_loops()));
+    w.put<uint32_t>(static_cast<uint32_t>(result.num_curves()));
+    w.put<uint32_t>(static_cast<uint32_t>(result.adjacency.size()));
+    w.put<float>(static_cast<float>(grid));
+    const size_t offsets_at {w.size()};
+    for (uint64_t offset : offsets)
+        w.put<uint64_t>(offset);
+
+    offsets[SECTION_PALETTE] = w.size();
+    for (uint32_t rgba : palette)
+        w.put<uint32_t>(rgba);
+    w.align();
+
+    offsets[SECTION_REGIONS] = w.size();
+    for (size_t r = 0; r < result.num_regions(); ++r) {
+        w.put<uint32_t>(region_colors[r]);
+        w.put<uint32_t>(static_cast<uint32_t>(result.areas[r]));
+        w.put<uint32_t>(static_cast<uint32_t>(result.region_loop_offsets[r]));
+        w.put<uint32_t>(
+            static_cast<uint32_t>(result.region_loop_offsets[r + 1] - result.region_loop_offsets[r])
+        );
+    }
+    w.align();
+
+    offsets[SECTION_LOOPS] = w.size();
+    for (size_t l = 0; l < result.num_loops(); ++l) {
+        w.put<uint32_t>(static_cast<uint32_t>(result.loop_curve_offsets[l]));
+        w.put<uint32_t>(
+            static_cast<uint32_t>(result.loop_curve_offsets[l + 1] - result.loop_curve_offsets[l])
+        );
+    }
+    w.align();
+
+    offsets[SECTION_CURVES] = w.size();
+    for (float v : result.curves) {
+        if (int16_points)
+            w.put<int16_t>(static_cast<int16_t>(std::lround(v / grid)));
+        else
+            w.put<float>(v);
+    }
+    w.align();
+
+    offsets[SECTION_ADJACENCY_OFFSETS] = w.size();
+    for (int32_t offset : result.adjacency_offsets)
+        w.put<uint32_t>(static_cast<uint32_t>(offset));
+    w.align();
+
+    offsets[SECTION_ADJACENCY] = w.size();
+    for (int32_t neighbor : result.adjacency)
+        w.put<uint32_t>(static_cast<uint32_t>(neighbor));
+    w.align();
+
+    offsets[SECTION_LABELS] = w.size();
+    if (include_labels) {
+        for (int32_t label : result.labels)
+            w.put<int32_t>(label);
+        w.align();
+    }
+
+    offsets[SECTION_END] = w.size();
+
+    // patch the section table
+    std::vector<uint8_t> table;
+    LittleEndianWriter tw(table);
+    for (uint64_t offset : offsets)
+        tw.put<uint64_t>(offset);
+    std::memcpy(out.data() + offsets_at, table.data(), table.size());
+
+    return out;
+}
+
+VectorizationBinaryView read_vectorization_binary(const uint8_t* data, size_t size) {
+    if (!host_is_little_endian())
+        throw std::runtime_error("read_vectorization_binary: big-endian hosts are not supported");
+    if (!data || size < sizeof(VectorizationBinaryHeader))
+        throw std::invalid_argument("read_vectorization_binary: buffer too small");
+    if (reinterpret_cast<uintptr_t>(data) % SECTION_ALIGNMENT != 0)
+        throw std::invalid_argument("read_vectorization_binary: buffer must be 8-byte aligned");
+
+    VectorizationBinaryView view;
+    view.header = reinterpret_cast<const VectorizationBinaryHeader*>(data);
+    const VectorizationBinaryHeader& h {*view.header};
+
+    if (std::memcmp(h.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+        throw std::invalid_argument("read_vectorization_binary: not an img2num container");
+    if (h.version != BINARY_VERSION)
+        throw std::invalid_argument("read_vectorization_binary: unsupported version");
+
+    const bool int16_points {(h.flags & BINARY_FLAG_INT16_POINTS) != 0};
+    const bool has_labels {(h.flags & BINARY_FLAG_LABELS) != 0};
+
+    // every section must be aligned, in order, inside the buffer and large enough
+    const uint64_t needed[SECTION_END] {
+        4ull * h.num_colors,
+        sizeof(VectorizationBinaryRegion) * static_cast<uint64_t>(h.num_regions),
+        sizeof(VectorizationBinaryLoop) * static_cast<uint64_t>(h.num_loops),
+        6ull * h.num_curves * (int16_points ? sizeof(int16_t) : sizeof(float)),
+        4ull * (static_cast<uint64_t>(h.num_regions) + 1),
+        4ull * h.num_adjacency,
+        has_labels ? 4ull * h.width * h.height : 0ull};
+    if (h.section_offsets[SECTION_END] > size ||
+        h.section_offsets[SECTION_PALETTE] < sizeof(VectorizationBinaryHeader))
+        throw std::invalid_argument("read_vectorization_binary: truncated container");
+    for (int s = 0; s < SECTION_END; ++s) {
+        if (h.section_offsets[s] % SECTION_ALIGNMENT != 0 ||
+            h.section_offsets[s + 1] < h.section_offsets[s] ||
+            h.section_offsets[s + 1] - h.section_offsets[s] < needed[s])
+            throw std::invalid_argument("read_vectorization_binary: corrupt section table");
+    }
+
+    auto section = [&](int s) {
+        return data + h.section_offsets[s];
+    };
+    view.palette = section(SECTION_PALETTE);
+    view.regions = reinterpret_cast<const VectorizationBinaryRegion*>(section(SECTION_REGIONS));
+    view.loops = reinterpret_cast<const VectorizationBinaryLoop*>(section(SECTION_LOOPS));
+    if (int16_points)
+        view.curves_i16 = reinterpret_cast<const int16_t*>(section(SECTION_CURVES));
+    else
+        view.curves_f32 = reinterpret_cast<const float*>(section(SECTION_CURVES));
+    view.adjacency_offsets =
+        reinterpret_cast<const uint32_t*>(section(SECTION_ADJACENCY_OFFSETS));
+    view.adjacency = reinterpret_cast<const uint32_t*>(section(SECTION_ADJACENCY));
+    if (has_labels)
+        view.labels = reinterpret_cast<const int32_t*>(section(SECTION_LABELS));
+
+    return view;
+}
+} // namespace img2num
@@ -0,0 +1,252 @@
+// GPU/CPU parity check: runs the WebGPU stages and their CPU counterparts on fixed inputs
+// and fails when they disagree. Built with -DIMG2NUM_BUILD_GPU_CHECK=ON; on a machine
+// without a GPU run it with IMG2NUM_WEBGPU_FALLBACK=1 (Dawn's SwiftShader adapter).
+//
+// Covers the tiled and untiled bilateral filter (RGB and CIELAB), k-means with device
+// k-means++ seeding, the two-level reduction and the convergence counter (k = 1 and
+// k > 1, including images with more tiles than KMEANS_GPU_MAX_GROUPS), the resident
+// filter -> k-means hand-off, and the buffer pool (every case runs twice).
+
+#include "img2num.h"
+#include "internal/bilateral_filter_gpu.h"
+#include "internal/cielab_pipeline.h"
+#include "internal/execution.h"
+#include "internal/gpu.h"
+#include "internal/kmeans_gpu.h"
+#include "internal/workspace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static constexpr uint8_t COLOR_SPACE_OPTION_CIELAB {0};
+static constexpr uint8_t COLOR_SPACE_OPTION_RGB {1};
+
+// Largest per-channel difference allowed between the GPU and CPU results. The GPU works
+// in f32 and the CPU in double, so rounding to 8 bits may land one step apart.
+static constexpr int FILTER_TOLERANCE {2};
+static constexpr int CENTROID_TOLERANCE {2};
+
+static int failures {0};
+
+static void report(const std::string& name, const bool ok, const std::string& detail) {
+    std::printf("%s %s: %s\n", ok ? "ok  " : "FAIL", name.c_str(), detail.c_str());
+    if (!ok)
+        ++failures;
+}
+
+static const char* space_name(const uint8_t color_space) {
+    return color_space == COLOR_SPACE_OPTION_CIELAB ? "lab" : "rgb";
+}
+
+// Well-separated flat colours, far enough apart in RGB and CIELAB that every pixel has
+// one unambiguous nearest centroid
+static const uint8_t PALETTE[][3] {
+    {230, 25, 75}, {60, 180, 75}, {255, 225, 25}, {0, 130, 200},
+    {245, 130, 48}, {145, 30, 180}, {70, 240, 240}, {0, 0, 0}};
+static constexpr int PALETTE_SIZE {8};
+
+// Grid of flat blocks cycling through the first `colors` palette entries
+static std::vector<uint8_t> blocks_image(const int width, const int height, const int colors) {
+    std::vector<uint8_t> image(static_cast<size_t>(width) * height * 4);
+    const int block_w {std::max(1, width / 4)};
+    const int block_h {std::max(1, height / 3)};
+    for (int y {0}; y < height; ++y) {
+        for (int x {0}; x < width; ++x) {
+            const int c {(y / block_h * 5 + x / block_w) % colors};
+            uint8_t* p {&image[(static_cast<size_t>(y) * width + x) * 4]};
+            p[0] = PALETTE[c][0];
+            p[1] = PALETTE[c][1];
+            p[2] = PALETTE[c][2];
+            p[3] = 255;
+        }
+    }
+    return image;
+}
+
+// Blocks plus a gradient and fixed pseudo-random noise, so the filter has edges to keep
+// and texture to smooth
+static std::vector<uint8_t> textured_image(const int width, const int height) {
+    std::vector<uint8_t> image {blocks_image(width, height, PALETTE_SIZE)};
+    uint32_t state {12345};
+    for (size_t i {0}; i < image.size(); ++i) {
+        if (i % 4 == 3)
+            continue;
+        state = state * 1664525u + 1013904223u;
+        const int noise {static_cast<int>(state >> 27) - 16};
+        const int gradient {static_cast<int>((i / 4) % width) * 32 / width};
+        image[i] = static_cast<uint8_t>(std::clamp(image[i] + noise + gradient, 0, 255));
+    }
+    return image;
+}
+
+static int max_difference(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+    int worst {0};
+    for (size_t i {0}; i < a.size(); ++i)
+        worst = std::max(worst, std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])));
+    return worst;
+}
+
+// Whether two labelings are the same partition: a bijection between their labels
+// that maps every pixel of one onto the other
+static bool same_partition(
+    const std::vector<int32_t>& a, const std::vector<int32_t>& b, const int32_t k,
+    std::string& detail
+) {
+    std::vector<int32_t> a_to_b(k, -1), b_to_a(k, -1);
+    size_t mismatches {0};
+    for (size_t i {0}; i < a.size(); ++i) {
+        if (a[i] < 0 || a[i] >= k || b[i] < 0 || b[i] >= k) {
+            detail = "label out of range at pixel " + std::to_string(i);
+            return false;
+        }
+        if (a_to_b[a[i]] < 0 && b_to_a[b[i]] < 0) {
+            a_to_b[a[i]] = b[i];
+            b_to_a[b[i]] = a[i];
+        }
+        if (a_to_b[a[i]] != b[i])
+            ++mismatches;
+    }
+    detail = std::to_string(mismatches) + " of " + std::to_string(a.size()) +
+             " pixels labelled differently";
+    return mismatches == 0;
+}
+
+static void check_filter(
+    const int width, const int height, const double sigma_spatial, const uint8_t color_space
+) {
+    const std::vector<uint8_t> input {textured_image(width, height)};
+    std::vector<uint8_t> cpu {input};
+    BilateralScratch scratch;
+    bilateral_filter_cpu(cpu.data(), width, height, sigma_spatial, 50.0, color_space, scratch);
+
+    const int radius {bilateral_kernel_radius(sigma_spatial)};
+    const std::string name {
+        "bilateral " + std::string(space_name(color_space)) + " radius " +
+        std::to_string(radius) + " " + std::to_string(width) + "x" + std::to_string(height)};
+    for (int run {1}; run <= 2; ++run) {
+        std::vector<uint8_t> gpu {input};
+        bilateral_filter_gpu(gpu.data(), width, height, sigma_spatial, 50.0, color_space);
+        const int diff {max_difference(cpu, gpu)};
+        report(
+            name + " run " + std::to_string(run), diff <= FILTER_TOLERANCE,
+            "max channel difference " + std::to_string(diff)
+        );
+    }
+}
+
+static void check_kmeans(
+    const int width, const int height, const int32_t k, const uint8_t color_space
+) {
+    const std::vector<uint8_t> input {blocks_image(width, height, std::max(k, 1))};
+    const size_t num_pixels {static_cast<size_t>(width) * height};
+    std::vector<uint8_t> cpu_data(num_pixels * 4);
+    std::vector<int32_t> cpu_labels(num_pixels);
+    KMeansScratch scratch;
+    kmeans_cpu(
+        input.data(), cpu_data.data(), cpu_labels.data(), width, height, k, 100, color_space,
+        scratch
+    );
+
+    const std::string name {
+        "kmeans " + std::string(space_name(color_space)) + " k=" + std::to_string(k) + " " +
+        std::to_string(width) + "x" + std::to_string(height)};
+    for (int run {1}; run <= 2; ++run) {
+        std::vector<uint8_t> gpu_data(num_pixels * 4);
+        std::vector<int32_t> gpu_labels(num_pixels);
+        kmeans_gpu(
+            input.data(), gpu_data.data(), gpu_labels.data(), width, height, k, 100, color_space
+        );
+        std::string detail;
+        const bool labels_ok {same_partition(cpu_labels, gpu_labels, k, detail)};
+        const int diff {max_difference(cpu_data, gpu_data)};
+        report(
+            name + " run " + std::to_string(run), labels_ok && diff <= CENTROID_TOLERANCE,
+            detail + ", max centroid difference " + std::to_string(diff)
+        );
+    }
+}
+
+// Filter + k-means through cluster_labels: forcing both stages onto the GPU takes the
+// resident hand-off, forcing them onto the CPU the reference path
+static void check_resident(
+    const int width, const int height, const int32_t k, const uint8_t color_space
+) {
+    const std::vector<uint8_t> input {blocks_image(width, height, k)};
+    img2num::ImageView image;
+    image.data = input.data();
+    image.width = width;
+    image.height = height;
+
+    img2num::ImageToSvgConfig config;
+    config.color_space = color_space;
+    config.kmeans.k = k;
+    config.execution.bilateral_filter = img2num::EXECUTION_CPU;
+    config.execution.kmeans = img2num::EXECUTION_CPU;
+    img2num::Workspace cpu;
+    img2num::cluster_labels(image, config, true, cpu);
+
+    const std::string name {
+        "resident " + std::string(space_name(color_space)) + " k=" + std::to_string(k) + " " +
+        std::to_string(width) + "x" + std::to_string(height)};
+    config.execution.bilateral_filter = img2num::EXECUTION_GPU;
+    config.execution.kmeans = img2num::EXECUTION_GPU;
+    for (int run {1}; run <= 2; ++run) {
+        img2num::Workspace gpu;
+        img2num::cluster_labels(image, config, true, gpu);
+        std::string detail;
+        report(
+            name + " run " + std::to_string(run),
+            same_partition(cpu.labels, gpu.labels, k, detail), detail
+        );
+    }
+}
+
+static void check_k_limit() {
+    const std::vector<uint8_t> input {blocks_image(16, 16, 1)};
+    std::vector<int32_t> labels(16 * 16);
+    bool threw {false};
+    try {
+        kmeans_gpu(
+            input.data(), nullptr, labels.data(), 16, 16, KMEANS_GPU_MAX_K + 1, 10,
+            COLOR_SPACE_OPTION_RGB
+        );
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    report("kmeans k above KMEANS_GPU_MAX_K", threw, threw ? "rejected" : "not rejected");
+}
+
+int main() {
+    if (!GPU::getClassInstance().ensure_initialized()) {
+        std::printf("FAIL no WebGPU device (set IMG2NUM_WEBGPU_FALLBACK=1 for SwiftShader)\n");
+        return 1;
+    }
+
+    for (const uint8_t color_space : {COLOR_SPACE_OPTION_RGB, COLOR_SPACE_OPTION_CIELAB}) {
+        // radius 6 takes the tiled kernels, radius 30 the untiled ones
+        check_filter(97, 61, 2.0, color_space);
+        check_filter(97, 61, 10.0, color_space);
+        check_filter(640, 480, 3.0, color_space);
+
+        check_kmeans(97, 61, 1, color_space);
+        check_kmeans(97, 61, 5, color_space);
+        check_kmeans(97, 61, PALETTE_SIZE, color_space);
+        // more 16x16 tiles than KMEANS_GPU_MAX_GROUPS: workgroups loop over several
+        check_kmeans(1100, 1000, 6, color_space);
+
+        check_resident(97, 61, 1, color_space);
+        check_resident(160, 120, 6, color_space);
+    }
+    check_k_limit();
+
+    const uint32_t errors {GPU::getClassInstance().error_count()};
+    report("device errors", errors == 0, std::to_string(errors) + " reported");
+
+    std::printf("%d failure(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -10,9 +10,25 @@ from ._img2num import (
     black_threshold_image   as _black_threshold_image,
     bilateral_filter        as _bilateral_filter,
     kmeans                  as _kmeans,
+    kmeans_labels           as _kmeans_labels,
     labels_to_svg           as _labels_to_svg,
     image_to_svg            as _image_to_svg,
-    ImageToSvgConfig
+    labels_to_arcs          as _labels_to_arcs,
+    image_to_arcs           as _image_to_arcs,
+    labels_to_vectorization as _labels_to_vectorization,
+    image_to_vectorization  as _image_to_vectorization,
+    vectorization_to_svg    as _vectorization_to_svg,
+    vectorization_to_svgz   as _vectorization_to_svgz,
+    image_to_svgz           as _image_to_svgz,
+    image_to_svg_batch      as _image_to_svg_batch,
+    image_to_svg_file       as _image_to_svg_file,
+    warmup                  as _warmup,
+    vectorization_to_binary as _vectorization_to_binary,
+    read_vectorization_binary as _read_vectorization_binary,
+    Context                 as _Context,
+    ImageToSvgConfig,
+    VectorizationResult,
+    VectorizationBinaryConfig
 )
 
 
@@ -45,6 +61,15 @@ def _inject_dimensions(image_arg="image"):
     return decorator
 
 
+def _pixel_format(image) -> int:
+    """PixelFormat of an (H, W), (H, W, 1), (H, W, 3) or (H, W, 4) array."""
+    channels = 1 if image.ndim == 2 else image.shape[2]
+    formats = {1: 4, 3: 2, 4: 0}  # grayscale, RGB, RGBA
+    if channels not in formats:
+        raise ValueError("Expected 1, 3 or 4 channels")
+    return formats[channels]
+
+
 @_inject_dimensions("image")
 def gaussian_blur_fft(
     image: npt.NDArray[np.uint8], sigma: float, *, width: int, height: int
@@ -163,7 +188,15 @@ def bilateral_filter(
 
 @_inject_dimensions("data")
 def kmeans(
-    data: npt.NDArray[np.uint8], k: int, max_iter: int, color_space: int, *, width: int, height: int
+    data: npt.NDArray[np.uint8],
+    k: int,
+    max_iter: int,
+    color_space: int,
+    pyramid_levels: int = 0,
+    refine_iter: int = 2,
+    *,
+    width: int,
+    height: int,
 ) -> Tuple[npt.NDArray[np.uint8], npt.NDArray[int]]:
     """
     Perform K-means clustering on the image data.
@@ -178,13 +211,61 @@ def kmeans(
         Maximum number of iterations for the K-means algorithm.
     color_space : int
         Color space identifier (e.g., 0 for LAB, 1 for sRGB).
+    pyramid_levels : int, optional
+        Number of 2x downsampling steps to run the iterations on first (CPU only).
+        0 disables. Default: 0
+    refine_iter : int, optional
+        Full-resolution iterations refining the coarse centroids. Default: 2
 
     Returns
     -------
     tuple
         A tuple containing two NumPy arrays: (clustered_data, labels).
     """
-    return _kmeans(data, width, height, k, max_iter, color_space)
+    return _kmeans(
+        data, width, height, k, max_iter, color_space, pyramid_levels, refine_iter
+    )
+
+
+@_inject_dimensions("data")
+def kmeans_labels(
+    data: npt.NDArray[np.uint8],
+    k: int,
+    max_iter: int,
+    color_space: int,
+    pyramid_levels: int = 0,
+    refine_iter: int = 2,
+    *,
+    width: int,
+    height: int,
+) -> npt.NDArray[int]:
+    """
+    Perform K-means clustering on the image data, returning only the labels.
+
+    Parameters
+    ----------
+    data : numpy.ndarray
+        Input image data as a uint8 numpy array.
+    k : int
+        Number of clusters to compute.
+    max_iter : int
+        Maximum number of iterations for the K-means algorithm.
+    color_space : int
+        Color space identifier (e.g., 0 for LAB, 1 for sRGB).
+    pyramid_levels : int, optional
+        Number of 2x downsampling steps to run the iterations on first (CPU only).
+        0 disables. Default: 0
+    refine_iter : int, optional
+        Full-resolution iterations refining the coarse centroids. Default: 2
+
+    Returns
+    -------
+    numpy.ndarray
+        Cluster label per pixel.
+    """
+    return _kmeans_labels(
+        data, width, height, k, max_iter, color_space, pyramid_levels, refine_iter
+    )
 
 
 @_inject_dimensions("data")
@@ -227,7 +308,8 @@ def image_to_svg(image: npt.NDArray[np.uint8], *, width: int, height: int, confi
     Parameters
     ----------
     image : numpy.ndarray
-        Input image buffer.
+        Input image buffer of shape (H, W, 4) RGBA, (H, W, 3) RGB or (H, W) grayscale.
+        RGB and grayscale images are read as they are, without expanding to RGBA.
     config : ImageToSvgConfig, optional
         Configuration object containing filter and clustering parameters.
         Defaults to ``ImageToSvgConfig()`` if not provided.
@@ -244,4 +326,366 @@ def image_to_svg(image: npt.NDArray[np.uint8], *, width: int, height: int, confi
         height,
         # Use default
         _config,
+        _pixel_format(image),
+    )
+
+
+@_inject_dimensions("image")
+def image_to_svgz(image: npt.NDArray[np.uint8], *, width: int, height: int, config=None) -> bytes:
+    """
+    Convert Image to gzip-compressed SVG (SVGZ).
+
+    Parameters
+    ----------
+    image : numpy.ndarray
+        Input image buffer of shape (H, W, 4) RGBA, (H, W, 3) RGB or (H, W) grayscale.
+        RGB and grayscale images are read as they are, without expanding to RGBA.
+    config : ImageToSvgConfig, optional
+        Configuration object containing filter and clustering parameters.
+        Defaults to ``ImageToSvgConfig()`` if not provided.
+
+    Returns
+    -------
+    bytes
+        A gzip stream that decompresses to the same SVG as ``image_to_svg``.
+    """
+    _config = ImageToSvgConfig() if config is None else config
+    return _image_to_svgz(image, width, height, _config, _pixel_format(image))
+
+
+def image_to_svg_batch(images, configs=None, num_threads: int = 0) -> list:
+    """
+    Convert many images to SVG strings in one call.
+
+    Stages are scheduled across images internally (one image per worker on the CPU;
+    with a GPU, filtering and clustering of the next image overlap contour fitting of
+    the previous ones), so this gives better throughput than calling ``image_to_svg``
+    from a thread pool.
+
+    Parameters
+    ----------
+    images : sequence of numpy.ndarray
+        Input image buffers, each of shape (H, W, 4) RGBA, (H, W, 3) RGB or (H, W)
+        grayscale; formats may differ between images.
+    configs : ImageToSvgConfig or sequence of ImageToSvgConfig, optional
+        One configuration shared by every image, or one per image.
+        Defaults to ``ImageToSvgConfig()`` if not provided.
+    num_threads : int, optional
+        Worker threads to use; 0 (default) uses every hardware thread.
+
+    Returns
+    -------
+    list of str
+        One SVG per input, in input order.
+    """
+    images = [np.ascontiguousarray(image, dtype=np.uint8) for image in images]
+    for image in images:
+        if image.ndim < 2:
+            raise ValueError("Expected (H, W) or (H, W, C)")
+    pixel_formats = [_pixel_format(image) for image in images]
+    if configs is None:
+        configs = [ImageToSvgConfig()]
+    elif isinstance(configs, ImageToSvgConfig):
+        configs = [configs]
+    return _image_to_svg_batch(
+        images,
+        [image.shape[1] for image in images],
+        [image.shape[0] for image in images],
+        list(configs),
+        num_threads,
+        pixel_formats,
     )
+
+
+def warmup() -> None:
+    """
+    Initialize the GPU and compile its pipelines in the background, ahead of first use.
+
+    Returns immediately; only the first call does anything. Calls made while the
+    warm-up is still running use the CPU rather than waiting for it.
+    """
+    _warmup()
+
+
+def image_to_svg_file(
+    path: str, *, width: int, height: int, config=None, offset: int = 0
+) -> str:
+    """
+    Convert a raw RGBA file to SVG string without loading it into memory.
+
+    Rows are read from disk on demand (memory-mapped where supported). With
+    ``config.tiling.tile_size`` set, only one row of tiles is held at a time.
+
+    Parameters
+    ----------
+    path : str
+        File holding ``width * height`` packed RGBA pixels in row-major order.
+    width : int
+        Width of the image.
+    height : int
+        Height of the image.
+    config : ImageToSvgConfig, optional
+        Configuration object containing filter and clustering parameters.
+        Defaults to ``ImageToSvgConfig()`` if not provided.
+    offset : int, optional
+        Byte offset of the first pixel, e.g. to skip a header.
+
+    Returns
+    -------
+    str
+        SVG string.
+    """
+    _config = ImageToSvgConfig() if config is None else config
+    return _image_to_svg_file(str(path), width, height, _config, offset)
+
+
+@_inject_dimensions("data")
+def labels_to_arcs(
+    data: npt.NDArray[np.uint8],
+    labels: npt.NDArray[int],
+    min_area: int,
+    min_thickness: int,
+    grid: float = 0.5,
+    *,
+    width: int,
+    height: int,
+) -> str:
+    """
+    Convert labels to a shared-arc topology (TopoJSON-style JSON string).
+
+    Parameters
+    ----------
+    data : numpy.ndarray
+        Input image data as a uint8 numpy array.
+    labels : numpy.ndarray
+        Label map as an int32 numpy array.
+    min_area : int
+        Minimum cluster area to include.
+    min_thickness : int
+        Minimum thickness a region must have to include.
+    grid : float, optional
+        Coordinate grid step (in pixels) that arc points are quantized to.
+
+    Returns
+    -------
+    str
+        A JSON document where every boundary between two regions is stored once in
+        ``arcs`` and each region lists its loops as signed arc indices (``~i`` = reversed).
+    """
+    return _labels_to_arcs(data, labels, width, height, min_area, min_thickness, grid)
+
+
+@_inject_dimensions("image")
+def image_to_arcs(image: npt.NDArray[np.uint8], *, width: int, height: int, config=None) -> str:
+    """
+    Convert Image to a shared-arc topology (TopoJSON-style JSON string).
+
+    Parameters
+    ----------
+    image : numpy.ndarray
+        Input image buffer of shape (H, W, 4) RGBA, (H, W, 3) RGB or (H, W) grayscale.
+        RGB and grayscale images are read as they are, without expanding to RGBA.
+    config : ImageToSvgConfig, optional
+        Configuration object containing filter and clustering parameters.
+        Defaults to ``ImageToSvgConfig()`` if not provided.
+
+    Returns
+    -------
+    str
+        JSON document in the format returned by ``labels_to_arcs``.
+    """
+    _config = ImageToSvgConfig() if config is None else config
+    return _image_to_arcs(image, width, height, _config, _pixel_format(image))
+
+
+@_inject_dimensions("data")
+def labels_to_vectorization(
+    data: npt.NDArray[np.uint8],
+    labels: npt.NDArray[int],
+    min_area: int,
+    min_thickness: int,
+    *,
+    width: int,
+    height: int,
+) -> VectorizationResult:
+    """
+    Convert labels to a structured vectorization result.
+
+    Parameters
+    ----------
+    data : numpy.ndarray
+        Input image data as a uint8 numpy array.
+    labels : numpy.ndarray
+        Label map as an int32 numpy array.
+    min_area : int
+        Minimum cluster area to include.
+    min_thickness : int
+        Minimum thickness a region must have to include.
+
+    Returns
+    -------
+    VectorizationResult
+        Region colors, areas, boundary curves and adjacency. Array attributes are
+        read-only numpy views into the result, so no data is copied.
+    """
+    return _labels_to_vectorization(data, labels, width, height, min_area, min_thickness)
+
+
+@_inject_dimensions("image")
+def image_to_vectorization(
+    image: npt.NDArray[np.uint8], *, width: int, height: int, config=None
+) -> VectorizationResult:
+    """
+    Convert Image to a structured vectorization result.
+
+    Parameters
+    ----------
+    image : numpy.ndarray
+        Input image buffer of shape (H, W, 4) RGBA, (H, W, 3) RGB or (H, W) grayscale.
+        RGB and grayscale images are read as they are, without expanding to RGBA.
+    config : ImageToSvgConfig, optional
+        Configuration object containing filter and clustering parameters.
+        Defaults to ``ImageToSvgConfig()`` if not provided.
+
+    Returns
+    -------
+    VectorizationResult
+        Region colors, areas, boundary curves and adjacency.
+    """
+    _config = ImageToSvgConfig() if config is None else config
+    return _image_to_vectorization(image, width, height, _config, _pixel_format(image))
+
+
+def vectorization_to_svg(result: VectorizationResult, svg_config=None) -> str:
+    """
+    Serialize a vectorization result as an SVG string.
+
+    Parameters
+    ----------
+    result : VectorizationResult
+        Regions produced by ``labels_to_vectorization`` or ``image_to_vectorization``.
+    svg_config : ImageToSvgConfig.SvgConfig, optional
+        Serializer settings. Defaults to ``ImageToSvgConfig.SvgConfig()`` if not provided.
+
+    Returns
+    -------
+    str
+        An SVG string containing the data.
+    """
+    _svg_config = ImageToSvgConfig.SvgConfig() if svg_config is None else svg_config
+    return _vectorization_to_svg(result, _svg_config)
+
+
+def vectorization_to_svgz(result: VectorizationResult, svg_config=None) -> bytes:
+    """
+    Serialize a vectorization result as gzip-compressed SVG (SVGZ).
+
+    Parameters
+    ----------
+    result : VectorizationResult
+        Regions produced by ``labels_to_vectorization`` or ``image_to_vectorization``.
+    svg_config : ImageToSvgConfig.SvgConfig, optional
+        Serializer settings. Defaults to ``ImageToSvgConfig.SvgConfig()`` if not provided.
+
+    Returns
+    -------
+    bytes
+        A gzip stream that decompresses to the same SVG as ``vectorization_to_svg``.
+    """
+    _svg_config = ImageToSvgConfig.SvgConfig() if svg_config is None else svg_config
+    return _vectorization_to_svgz(result, _svg_config)
+
+
+def vectorization_to_binary(result: VectorizationResult, config=None) -> bytes:
+    """
+    Serialize a vectorization result into the binary container format.
+
+    Parameters
+    ----------
+    result : VectorizationResult
+        Regions produced by ``labels_to_vectorization`` or ``image_to_vectorization``.
+    config : VectorizationBinaryConfig, optional
+        Point format, quantization step and label raster options.
+        Defaults to ``VectorizationBinaryConfig()`` if not provided.
+
+    Returns
+    -------
+    bytes
+        A little-endian container that can be written to disk as-is.
+    """
+    _config = VectorizationBinaryConfig() if config is None else config
+    return _vectorization_to_binary(result, _config)
+
+
+def read_vectorization_binary(buffer) -> dict:
+    """
+    Validate a binary vectorization container and return numpy views into it.
+
+    Parameters
+    ----------
+    buffer : bytes-like
+        The container, e.g. a ``mmap.mmap`` of a file written by ``vectorization_to_binary``.
+
+    Returns
+    -------
+    dict
+        Header fields and read-only numpy views of every section. Nothing is copied.
+    """
+    return _read_vectorization_binary(buffer)
+
+
+class Context:
+    """
+    Reusable processing context.
+
+    Keeps the pipeline's working buffers and filter kernels alive between calls, so running
+    many same-size images through one context makes no large allocations after the first.
+    Results match the module-level functions. Not thread-safe; use one per thread.
+    """
+
+    def __init__(self):
+        self._ctx = _Context()
+
+    @_inject_dimensions("image")
+    def image_to_svg(
+        self, image: npt.NDArray[np.uint8], *, width: int, height: int, config=None
+    ) -> str:
+        """Same as ``image_to_svg``, reusing this context's buffers."""
+        _config = ImageToSvgConfig() if config is None else config
+        return self._ctx.image_to_svg(
+            image, width, height, _config, _pixel_format(image)
+        )
+
+    @_inject_dimensions("image")
+    def image_to_svgz(
+        self, image: npt.NDArray[np.uint8], *, width: int, height: int, config=None
+    ) -> bytes:
+        """Same as ``image_to_svgz``, reusing this context's buffers."""
+        _config = ImageToSvgConfig() if config is None else config
+        return self._ctx.image_to_svgz(
+            image, width, height, _config, _pixel_format(image)
+        )
+
+    @_inject_dimensions("image")
+    def image_to_vectorization(
+        self, image: npt.NDArray[np.uint8], *, width: int, height: int, config=None
+    ) -> VectorizationResult:
+        """Same as ``image_to_vectorization``, reusing this context's buffers."""
+        _config = ImageToSvgConfig() if config is None else config
+        return self._ctx.image_to_vectorization(
+            image, width, height, _config, _pixel_format(image)
+        )
+
+    @_inject_dimensions("image")
+    def image_to_arcs(
+        self, image: npt.NDArray[np.uint8], *, width: int, height: int, config=None
+    ) -> str:
+        """Same as ``image_to_arcs``, reusing this context's buffers."""
+        _config = ImageToSvgConfig() if config is None else config
+        return self._ctx.image_to_arcs(
+            image, width, height, _config, _pixel_format(image)
+        )
+
+    def release(self) -> None:
+        """Free every cached buffer and kernel; the context stays usable."""
+        self._ctx.release()
@@ -0,0 +1,76 @@
+"""RGB and grayscale arrays must give the same result as the equivalent RGBA array."""
+
+import gzip
+
+import numpy as np
+import pytest
+
+import img2num
+
+
+def _config():
+    config = img2num.ImageToSvgConfig()
+    config.kmeans.k = 4
+    config.min_cluster_area = 10
+    return config
+
+
+def _rgb():
+    """48x64 image of flat 8x8 blocks."""
+    blocks = np.random.default_rng(7).integers(0, 256, size=(6, 8, 3), dtype=np.uint8)
+    return np.repeat(np.repeat(blocks, 8, axis=0), 8, axis=1)
+
+
+def _rgba(image):
+    if image.ndim == 2:
+        image = np.dstack([image] * 3)
+    alpha = np.full(image.shape[:2], 255, dtype=np.uint8)
+    return np.ascontiguousarray(np.dstack([image, alpha]))
+
+
+def _inputs():
+    rgb = _rgb()
+    gray = np.ascontiguousarray(rgb[:, :, 0])
+    return [(rgb, _rgba(rgb)), (gray, _rgba(gray))]
+
+
+@pytest.mark.parametrize("image, rgba", _inputs(), ids=["rgb", "gray"])
+def test_image_to_svgz(image, rgba):
+    expected = gzip.decompress(img2num.image_to_svgz(rgba, config=_config()))
+    assert gzip.decompress(img2num.image_to_svgz(image, config=_config())) == expected
+
+
+@pytest.mark.parametrize("image, rgba", _inputs(), ids=["rgb", "gray"])
+def test_image_to_arcs(image, rgba):
+    expected = img2num.image_to_arcs(rgba, config=_config())
+    assert img2num.image_to_arcs(image, config=_config()) == expected
+
+
+def test_image_to_svg_batch_mixed_formats():
+    (rgb, rgb_rgba), (gray, gray_rgba) = _inputs()
+    expected = img2num.image_to_svg_batch([rgb_rgba, gray_rgba], _config())
+    assert img2num.image_to_svg_batch([rgb, gray], _config()) == expected
+
+
+@pytest.mark.parametrize("image, rgba", _inputs(), ids=["rgb", "gray"])
+def test_context(image, rgba):
+    ctx = img2num.Context()
+    config = _config()
+    assert ctx.image_to_svg(image, config=config) == ctx.image_to_svg(rgba, config=config)
+    assert gzip.decompress(ctx.image_to_svgz(image, config=config)) == gzip.decompress(
+        ctx.image_to_svgz(rgba, config=config)
+    )
+    assert ctx.image_to_arcs(image, config=config) == ctx.image_to_arcs(rgba, config=config)
+    result = ctx.image_to_vectorization(image, config=config)
+    expected = ctx.image_to_vectorization(rgba, config=config)
+    assert np.array_equal(result.colors, expected.colors)
+    assert np.array_equal(result.curves, expected.curves)
+
+
+def test_short_buffer_is_rejected():
+    from img2num._img2num import image_to_svgz
+
+    rgb = _rgb()
+    with pytest.raises(ValueError):
+        # declared RGBA, but the buffer only holds 3 bytes per pixel
+        image_to_svgz(rgb, rgb.shape[1], rgb.shape[0], _config(), 0)
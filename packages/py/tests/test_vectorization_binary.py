@@ -0,0 +1,41 @@
+"""Arrays returned by read_vectorization_binary must outlive changes to their source."""
+
+import gc
+
+import numpy as np
+import pytest
+
+import img2num
+
+
+def _container():
+    blocks = np.random.default_rng(3).integers(0, 256, size=(4, 6, 3), dtype=np.uint8)
+    image = np.repeat(np.repeat(blocks, 8, axis=0), 8, axis=1)
+    config = img2num.ImageToSvgConfig()
+    config.kmeans.k = 4
+    config.min_cluster_area = 10
+    return img2num.vectorization_to_binary(img2num.image_to_vectorization(image, config=config))
+
+
+def test_source_cannot_be_resized_while_views_live():
+    source = bytearray(_container())
+    out = img2num.read_vectorization_binary(source)
+    with pytest.raises(BufferError):
+        source.extend(b"\0" * 4096)
+    del out
+    gc.collect()
+    source.extend(b"\0" * 4096)  # released with the last view
+
+
+def test_views_outlive_deleted_source():
+    data = _container()
+    expected = {k: v.copy() for k, v in img2num.read_vectorization_binary(data).items()
+                if isinstance(v, np.ndarray)}
+
+    source = bytearray(data)
+    out = img2num.read_vectorization_binary(source)
+    del source
+    gc.collect()
+    bytearray(len(data))  # reuse the freed size class
+    for key, value in expected.items():
+        assert np.array_equal(out[key], value), key